@@ -42,6 +42,10 @@ android {
     buildFeatures {
         viewBinding = true
     }
+    androidResources {
+        // Keep the bundle stored uncompressed so it can be read in place from the APK
+        noCompress += "dbc"
+    }
 }
 
 dependencies {
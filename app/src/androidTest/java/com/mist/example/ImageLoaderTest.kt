@@ -0,0 +1,126 @@
+package com.mist.example
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.graphics.Color
+import android.graphics.drawable.BitmapDrawable
+import android.os.SystemClock
+import android.widget.ImageView
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+import org.junit.After
+import org.junit.Assert.*
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+/**
+ * ImageLoader's memory LRU and in-flight sharing, loading small PNGs from local
+ * files. Every image is 64x64 ARGB_8888, 16 KB in the cache.
+ */
+@RunWith(AndroidJUnit4::class)
+class ImageLoaderTest {
+    private val instrumentation = InstrumentationRegistry.getInstrumentation()
+    private val context: Context = instrumentation.targetContext
+    private val dir = File(context.cacheDir, "image-loader-test")
+    private lateinit var loader: ImageLoader
+
+    @Before
+    fun setUp() {
+        dir.mkdirs()
+        for ((name, color) in listOf("a" to Color.RED, "b" to Color.GREEN, "c" to Color.BLUE)) {
+            val bitmap = Bitmap.createBitmap(SIZE, SIZE, Bitmap.Config.ARGB_8888).apply { eraseColor(color) }
+            File(dir, "$name.png").outputStream().use { bitmap.compress(Bitmap.CompressFormat.PNG, 100, it) }
+        }
+        // Room for two images: loading a third evicts the least recently used
+        loader = ImageLoader(context, memoryCacheKb = 40)
+    }
+
+    @After
+    fun tearDown() {
+        loader.shutdown()
+        dir.deleteRecursively()
+    }
+
+    @Test
+    fun sameImageRequestedWhileLoadingIsFetchedOnce() {
+        val views = onMain { List(3) { ImageView(context) } }
+        onMain { views.forEach { loader.load(it, path("a"), SIZE, SIZE) } }
+        assertEquals(1, onMain { loader.loadsStarted })
+
+        views.forEach { awaitBitmap(it) }
+        val bitmaps = onMain { views.map { (it.drawable as BitmapDrawable).bitmap } }
+        assertTrue(bitmaps.all { it === bitmaps[0] })
+
+        // A different size is a different bitmap
+        val small = onMain { ImageView(context) }
+        onMain { loader.load(small, path("a"), SIZE / 2, SIZE / 2) }
+        assertEquals(2, onMain { loader.loadsStarted })
+        awaitBitmap(small)
+    }
+
+    @Test
+    fun viewShowsTheLastImageItAskedFor() {
+        val view = onMain { ImageView(context) }
+        onMain {
+            loader.load(view, path("a"), SIZE, SIZE)
+            loader.load(view, path("b"), SIZE, SIZE)
+        }
+        awaitLoaded(view, "b")
+        // Let a's completion land too; it must not replace b
+        awaitLoaded(load("a"), "a")
+        assertEquals(Color.GREEN, onMain { (view.drawable as BitmapDrawable).bitmap.getPixel(0, 0) })
+    }
+
+    @Test
+    fun leastRecentlyUsedImageIsEvicted() {
+        awaitLoaded(load("a"), "a")
+        awaitLoaded(load("b"), "b")
+        assertEquals(2, onMain { loader.loadsStarted })
+
+        // A hit makes a the most recently used, so c evicts b
+        load("a")
+        assertEquals(2, onMain { loader.loadsStarted })
+        awaitLoaded(load("c"), "c")
+        assertEquals(3, onMain { loader.loadsStarted })
+
+        load("a")
+        assertEquals(3, onMain { loader.loadsStarted })
+        awaitLoaded(load("b"), "b")
+        assertEquals(4, onMain { loader.loadsStarted })
+    }
+
+    private fun path(name: String) = File(dir, "$name.png").path
+
+    private fun load(name: String): ImageView = onMain {
+        ImageView(context).also { loader.load(it, path(name), SIZE, SIZE) }
+    }
+
+    private fun <T> onMain(block: () -> T): T {
+        var result: T? = null
+        instrumentation.runOnMainSync { result = block() }
+        @Suppress("UNCHECKED_CAST")
+        return result as T
+    }
+
+    private fun awaitBitmap(view: ImageView) {
+        val deadline = SystemClock.uptimeMillis() + TIMEOUT_MS
+        while (onMain { view.drawable } == null) {
+            assertTrue("image not loaded in time", SystemClock.uptimeMillis() < deadline)
+            SystemClock.sleep(10)
+        }
+    }
+
+    // Waits for the view's image and checks it is the one named `name`
+    private fun awaitLoaded(view: ImageView, name: String) {
+        awaitBitmap(view)
+        val expected = mapOf("a" to Color.RED, "b" to Color.GREEN, "c" to Color.BLUE).getValue(name)
+        assertEquals(expected, onMain { (view.drawable as BitmapDrawable).bitmap.getPixel(0, 0) })
+    }
+
+    companion object {
+        private const val SIZE = 64
+        private const val TIMEOUT_MS = 5000L
+    }
+}
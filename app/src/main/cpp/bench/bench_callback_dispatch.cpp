@@ -0,0 +1,156 @@
+// Bridge-side cost of firing a registered callback, the path behind onButtonClick
+// and onHttpResponse: the lookup, working out what the callback is, and building
+// its arguments. The old path found the entry in an unordered_map, dynamic_cast
+// the object up to four times and built a fresh std::vector<Value> per event; the
+// new one is a SlotMap find, the kind resolved at registration and the reused
+// argument buffer of invoke_callback. Stand-in Value/Object types of the VM's
+// shape keep it VM-free, and VM::execute_callback is an empty out-of-line call, so
+// the interpreter's own cost (the same on both paths) is not in the numbers. The
+// old path's log lines are left out too.
+//
+//   bench_callback_dispatch [events, default 10000000]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#include "bench_util.h"
+#include "SlotMap.h"
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+struct Object { virtual ~Object() = default; };
+struct ObjFunction : Object { int functionIndex = 3; };
+struct ObjBoundMethod : Object { int methodIndex = 5; };
+
+// 16 bytes, like the VM's Value
+struct Value {
+    enum Type : uint8_t { NIL, INT, OBJECT } type = NIL;
+    union { int64_t i; Object* object; } current_value{};
+
+    static Value createINT(int64_t i) { Value v; v.type = INT; v.current_value.i = i; return v; }
+    static Value createOBJECT(Object* o) { Value v; v.type = OBJECT; v.current_value.object = o; return v; }
+};
+
+static int64_t g_sink = 0;
+
+__attribute__((noinline)) static bool execute_callback(const Value& callback, const std::vector<Value>& args) {
+    g_sink += static_cast<int64_t>(args.size()) + callback.type;
+    return true;
+}
+
+// ---- old: map lookup, RTTI per event, vector per event
+
+struct OldInfo {
+    Value callback;
+    int userData;
+};
+
+static bool old_dispatch(std::unordered_map<int, OldInfo>& callbacks, int id) {
+    auto it = callbacks.find(id);
+    if (it == callbacks.end()) return false;
+    Value callback = it->second.callback;
+    int userData = it->second.userData;
+
+    Object* object = callback.type == Value::OBJECT ? callback.current_value.object : nullptr;
+    if (object) {
+        if (auto* method = dynamic_cast<ObjBoundMethod*>(object)) g_sink += method->methodIndex;
+        if (auto* function = dynamic_cast<ObjFunction*>(object)) g_sink += function->functionIndex;
+        if (auto* method = dynamic_cast<ObjBoundMethod*>(object)) {
+            g_sink += method->methodIndex;
+        } else if (auto* function = dynamic_cast<ObjFunction*>(object)) {
+            g_sink += function->functionIndex;
+        }
+    }
+
+    std::vector<Value> args;
+    if (userData != -1) args.push_back(Value::createINT(userData));
+    return execute_callback(callback, args);
+}
+
+// ---- new: what CallbackRegistry and invoke_callback do
+
+enum class Kind : uint8_t { Function, BoundMethod, Other };
+
+struct Entry {
+    Value callback;
+    int userData = -1;
+    Kind kind = Kind::Other;
+    int functionIndex = -1;
+};
+
+static std::vector<Value>& callback_args() {
+    static std::vector<Value> args = [] {
+        std::vector<Value> buffer;
+        buffer.reserve(3);
+        return buffer;
+    }();
+    return args;
+}
+
+static bool invoke(const Entry& entry, std::initializer_list<Value> args) {
+    if (entry.kind == Kind::Other || args.size() > 3) return false;
+    Value callback = entry.callback;
+    std::vector<Value>& buffer = callback_args();
+    buffer.assign(args);
+    return execute_callback(callback, buffer);
+}
+
+static bool new_dispatch(SlotMap<Entry>& callbacks, SlotHandle handle) {
+    Entry* entry = callbacks.find(handle);
+    if (!entry) return false;
+    g_sink += entry->functionIndex;
+    return entry->userData != -1 ? invoke(*entry, {Value::createINT(entry->userData)}) : invoke(*entry, {});
+}
+
+constexpr int kLive = 64;   // buttons on a screen
+
+template <typename Fire>
+static void measure(const char* name, int events, Fire&& fire) {
+    fire(0);   // let the reused buffer reach its capacity
+    uint64_t allocations = g_allocations.load();
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < events; i++) fire(i);
+    uint64_t ns = bench_now_ns() - start;
+    std::printf("%-34s %7.2f ns/event  %5.2f allocations/event\n", name, static_cast<double>(ns) / events,
+                static_cast<double>(g_allocations.load() - allocations) / events);
+}
+
+int main(int argc, char** argv) {
+    int events = bench_arg(argc, argv, 10000000);
+    ObjFunction function;
+    ObjBoundMethod method;
+
+    std::unordered_map<int, OldInfo> oldCallbacks;
+    SlotMap<Entry> newCallbacks;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < kLive; i++) {
+        // Alternate functions and bound methods, every other one with userData
+        bool bound = i & 1;
+        Value callback = Value::createOBJECT(bound ? static_cast<Object*>(&method) : &function);
+        int userData = (i & 2) ? i : -1;
+        oldCallbacks[i] = OldInfo{callback, userData};
+        handles.push_back(newCallbacks.insert(Entry{callback, userData, bound ? Kind::BoundMethod : Kind::Function,
+                                                    bound ? method.methodIndex : function.functionIndex}));
+    }
+
+    std::printf("== %d events over %d callbacks\n", events, kLive);
+    measure("map + dynamic_cast + vector", events,
+            [&](int i) { old_dispatch(oldCallbacks, i % kLive); });
+    measure("slot map + kind + reused buffer", events,
+            [&](int i) { new_dispatch(newCallbacks, handles[i % kLive]); });
+    std::printf("(%lld)\n", static_cast<long long>(g_sink & 1));
+    return 0;
+}
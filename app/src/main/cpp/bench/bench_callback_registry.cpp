@@ -0,0 +1,90 @@
+// Callback storage: the SlotMap behind CallbackRegistry against the unordered_map
+// plus never-shrinking root vector it replaced. Lookup latency over a live set, and
+// resident memory over N registrations where each one-shot callback is released
+// after its dispatch (the old map never erased anything).
+//
+//   bench_callback_registry [registrations, default 1000000]
+
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "bench_util.h"
+#include "SlotMap.h"
+
+// Same size as CallbackEntry with the VM's 16-byte Value
+struct Entry {
+    uint64_t callback[2];
+    int userData = -1;
+    int owner = 0;
+    bool oneShot = true;
+    uint8_t kind = 0;
+    int functionIndex = -1;
+};
+
+constexpr int kLive = 10000;   // pending HTTP callbacks and buttons at any time
+constexpr int kLookups = 4000000;
+
+static void lookups() {
+    std::mt19937 rng(7);
+    SlotMap<Entry> slots;
+    std::unordered_map<int, Entry> map;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < kLive; i++) {
+        handles.push_back(slots.insert(Entry{}));
+        map[i] = Entry{};
+    }
+    std::vector<int> order(kLookups);
+    for (int& i : order) i = static_cast<int>(rng() % kLive);
+
+    uint64_t sink = 0;
+    uint64_t start = bench_now_ns();
+    for (int i : order) sink += slots.find(handles[i])->userData;
+    uint64_t slotNs = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (int i : order) sink += map.find(i)->second.userData;
+    uint64_t mapNs = bench_now_ns() - start;
+
+    std::printf("lookup of %d live: slot map %6.2f ns  unordered_map %6.2f ns  (%llu)\n", kLive,
+                static_cast<double>(slotNs) / kLookups, static_cast<double>(mapNs) / kLookups,
+                static_cast<unsigned long long>(sink & 1));
+}
+
+int main(int argc, char** argv) {
+    int registrations = bench_arg(argc, argv, 1000000);
+    int step = registrations >= 10 ? registrations / 10 : 1;
+    lookups();
+
+    std::printf("== %d registrations, %d live at a time\n", registrations, kLive);
+    std::printf("%12s %14s %14s\n", "registered", "slot map kB", "old map kB");
+    reset_peak_rss();
+    long baseline = peak_rss_kb();
+
+    // Each pass runs alone so the peak belongs to it
+    std::vector<long> slotKb, mapKb;
+    {
+        SlotMap<Entry> slots;
+        // Oldest pending callback is dispatched (and released) as each new one arrives
+        std::vector<SlotHandle> pending(kLive, kInvalidSlot);
+        for (int i = 1; i <= registrations; i++) {
+            SlotHandle& oldest = pending[i % kLive];
+            slots.release(oldest);
+            oldest = slots.insert(Entry{});
+            if (i % step == 0) slotKb.push_back(peak_rss_kb() - baseline);
+        }
+    }
+    {
+        std::unordered_map<int, Entry> map;
+        std::vector<void*> roots;
+        for (int i = 1; i <= registrations; i++) {
+            map[i] = Entry{};
+            roots.push_back(&map[i]);
+            if (i % step == 0) mapKb.push_back(peak_rss_kb() - baseline);
+        }
+    }
+    for (size_t i = 0; i < slotKb.size() && i < mapKb.size(); i++) {
+        std::printf("%12zu %14ld %14ld\n", (i + 1) * static_cast<size_t>(step), slotKb[i], mapKb[i]);
+    }
+    return 0;
+}
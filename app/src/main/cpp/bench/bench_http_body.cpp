@@ -0,0 +1,117 @@
+// A large response body from the transport to the VM thread, the path behind
+// android_http_get: 64 KB chunks into HttpCall::append, the body moved into a
+// VmEvent, and one copy on the VM thread standing in for allocate_string. Counts
+// heap allocations and bytes, and the peak resident set above the payload itself,
+// with and without a Content-Length for the client to reserve from.
+//
+//   bench_http_body [payload MB, default 50]
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "HttpClient.h"
+#include "../vm_event_loop.h"
+
+static std::atomic<uint64_t> g_allocations{0};
+static std::atomic<uint64_t> g_allocated_bytes{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+static std::string g_payload;
+static bool g_send_length = false;
+
+static void transport(HttpCall& call) {
+    call.statusCode = 200;
+    call.set_response_headers(g_send_length ? "Content-Length: " + std::to_string(g_payload.size()) + "\n" : "");
+    constexpr size_t kChunk = 64 * 1024;  // MainActivity.httpChunk
+    for (size_t offset = 0; offset < g_payload.size(); offset += kChunk) {
+        call.append(g_payload.data() + offset, std::min(kChunk, g_payload.size() - offset));
+    }
+}
+
+static VmEventLoop* g_loop = nullptr;
+static std::mutex g_mutex;
+static std::condition_variable g_done;
+static size_t g_delivered = 0;
+
+static void complete(HttpCall& call, const std::vector<HttpRequestId>&) {
+    VmEvent event;
+    event.kind = VmEvent::Kind::HttpResponse;
+    event.body = std::move(call.response);
+    g_loop->post(std::move(event));
+}
+
+static void on_vm_thread(VmEvent& event) {
+    // allocate_string copies the body into the VM heap; then the event's copy goes
+    std::string heapString(event.body);
+    event.body = std::string();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_delivered = heapString.size();
+    g_done.notify_all();
+}
+
+static int run_pass(bool sendLength) {
+    g_send_length = sendLength;
+    VmEventLoop loop(on_vm_thread);
+    loop.start();
+    g_loop = &loop;
+    HttpClientConfig config;
+    config.workers = 1;
+    HttpClient client(transport, complete, config);
+
+    reset_peak_rss();
+    long baseKb = peak_rss_kb();
+    uint64_t allocations = g_allocations.load();
+    uint64_t bytes = g_allocated_bytes.load();
+    uint64_t start = bench_now_ns();
+
+    client.submit(1, {"GET", "http://bench/body", "", ""});
+    std::unique_lock<std::mutex> lock(g_mutex);
+    g_done.wait(lock, [] { return g_delivered != 0; });
+    uint64_t elapsed = bench_now_ns() - start;
+
+    if (g_delivered != g_payload.size()) return 1;
+    std::printf("%-22s %8.1f ms  %6llu allocations  %8.1f MB allocated  peak +%6.1f MB\n",
+                sendLength ? "with Content-Length" : "without Content-Length", elapsed / 1e6,
+                static_cast<unsigned long long>(g_allocations.load() - allocations),
+                (g_allocated_bytes.load() - bytes) / 1048576.0, (peak_rss_kb() - baseKb) / 1024.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = static_cast<size_t>(bench_arg(argc, argv, 50));
+    g_payload.assign(megabytes << 20, 'x');
+    for (size_t i = 0; i < g_payload.size(); i += 4096) g_payload[i] = static_cast<char>('a' + i / 4096 % 26);
+
+    std::printf("== %zu MB body\n", megabytes);
+    std::fflush(stdout);
+    // Each pass in its own process: memory the allocator kept from one would hide
+    // the next one's peak
+    for (bool sendLength : {false, true}) {
+        pid_t child = fork();
+        if (child == 0) {
+            int result = run_pass(sendLength);
+            std::fflush(stdout);
+            std::_Exit(result);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 1;
+    }
+    return 0;
+}
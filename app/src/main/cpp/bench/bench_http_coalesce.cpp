@@ -0,0 +1,94 @@
+// HttpClient coalescing and batching against a stand-in server that takes
+// kServerMs per call: a burst of GETs over a tenth as many URLs, as repeated
+// rebuilds and double taps produce, then as many distinct queries to a batch
+// endpoint. Reports server calls and submit-to-callback latency.
+//
+//   bench_http_coalesce [requests, default 400]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "HttpClient.h"
+
+constexpr int kServerMs = 5;
+
+static std::atomic<uint64_t> g_server_calls{0};
+static std::atomic<int> g_answered{0};
+static std::vector<uint64_t> g_submitted_ns;
+static std::unique_ptr<std::atomic<uint64_t>[]> g_answered_ns;
+
+static void bench_transport(HttpCall& call) {
+    g_server_calls++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(kServerMs));
+    call.statusCode = 200;
+}
+
+static void bench_complete(HttpCall&, const std::vector<HttpRequestId>& waiters) {
+    uint64_t now = bench_now_ns();
+    for (HttpRequestId id : waiters) {
+        if (id == kCancelledWaiter) continue;
+        g_answered_ns[id].store(now);
+        g_answered++;
+    }
+}
+
+int main(int argc, char** argv) {
+    int requests = std::max(10, bench_arg(argc, argv, 400));
+    g_submitted_ns.assign(requests, 0);
+    g_answered_ns = std::make_unique<std::atomic<uint64_t>[]>(requests);
+
+    // batchWindowMs < 0: queries are POSTed one by one
+    auto pass = [&](const char* name, bool queries, bool coalesce, int batchWindowMs) {
+        g_server_calls = 0;
+        g_answered = 0;
+        uint64_t start = bench_now_ns();
+        {
+            HttpClient client(bench_transport, bench_complete, {4, 2, coalesce});
+            char url[64];
+            HttpRequestId batch = -1;
+            for (int id = 0; id < requests; id++) {
+                g_submitted_ns[id] = bench_now_ns();
+                std::string query = std::to_string(id);
+                if (queries && batchWindowMs < 0) {
+                    client.submit(id, {"POST", "http://127.0.0.1/query", query, ""});
+                } else if (queries) {
+                    auto append = [&](HttpRequest& request) { request.body.back() = ','; request.body += query + "]"; };
+                    if (batch >= 0 && client.join(batch, id, append)) continue;
+
+                    HttpRequest request{"POST", "http://127.0.0.1/batch", "[" + query + "]", ""};
+                    request.batch = true;
+                    request.notBefore = std::chrono::steady_clock::now() + std::chrono::milliseconds(batchWindowMs);
+                    client.submit(id, std::move(request));
+                    batch = id;
+                } else {
+                    std::snprintf(url, sizeof(url), "http://127.0.0.1/item/%d", id % (requests / 10));
+                    client.submit(id, {"GET", url, "", ""});
+                }
+            }
+            while (g_answered.load() < requests) std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        std::vector<uint64_t> latency(requests);
+        for (int id = 0; id < requests; id++) latency[id] = g_answered_ns[id].load() - g_submitted_ns[id];
+        std::sort(latency.begin(), latency.end());
+        auto percentile = [&](double p) { return latency[static_cast<size_t>(p * (requests - 1))] / 1e6; };
+
+        std::printf("%-24s %6llu calls  p50 %8.2f ms  p99 %8.2f ms  max %8.2f ms  total %8.2f ms\n",
+                    name, static_cast<unsigned long long>(g_server_calls.load()),
+                    percentile(0.5), percentile(0.99), latency.back() / 1e6, elapsed / 1e6);
+    };
+
+    std::printf("== %d requests, %d ms per server call, 4 workers, 2 per host\n", requests, kServerMs);
+    pass("GET burst, separate", false, false, -1);
+    pass("GET burst, coalesced", false, true, -1);
+    pass("queries, separate", true, true, -1);
+    pass("queries, 10 ms batches", true, true, 10);
+    return 0;
+}
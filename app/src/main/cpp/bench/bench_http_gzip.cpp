@@ -0,0 +1,116 @@
+// Compressed responses: each fixture fetched as identity and as gzip through
+// HttpClient (bytes on the wire, end-to-end time), plus HttpDecoder alone over
+// 64 KB chunks (throughput).
+//
+//   bench_http_gzip [fixture.json ...]   (generated list feeds if none given)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+#include "bench_util.h"
+#include "HttpClient.h"
+#include "HttpDecoder.h"
+
+// Stand-in server: g_served sent as is, with g_served_encoding as Content-Encoding
+static std::string g_served;
+static std::string g_served_encoding;
+static std::atomic<size_t> g_received_bytes{0};
+static std::atomic<bool> g_done{false};
+
+static void served_transport(HttpCall& call) {
+    call.statusCode = 200;
+    call.set_response_headers(g_served_encoding.empty() ? "" : "Content-Encoding: " + g_served_encoding + "\n");
+    constexpr size_t kChunk = 64 * 1024;
+    for (size_t offset = 0; offset < g_served.size(); offset += kChunk) {
+        if (!call.append(g_served.data() + offset, std::min(kChunk, g_served.size() - offset))) return;
+    }
+}
+
+static void served_complete(HttpCall& call, const std::vector<HttpRequestId>&) {
+    g_received_bytes = call.statusCode == 200 ? call.response.size() : 0;
+    g_done = true;
+}
+
+static std::string gzip(const std::string& text) {
+    z_stream zs{};
+    deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&zs, text.size()), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    zs.avail_in = static_cast<uInt>(text.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+static std::string feed_fixture(size_t bytes) {
+    std::string text = "[";
+    char item[256];
+    for (int n = 0; text.size() < bytes; n++) text.append(item, static_cast<size_t>(feed_item(item, sizeof(item), n)));
+    return text + "]";
+}
+
+static double fetch(const std::string& served, const char* encoding) {
+    g_served = served;
+    g_served_encoding = encoding;
+    g_done = false;
+    uint64_t start = bench_now_ns();
+    {
+        HttpClient client(served_transport, served_complete, {1, 1, false});
+        client.submit(1, {"GET", "http://127.0.0.1/fixture.json", "", ""});
+        while (!g_done.load()) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return (bench_now_ns() - start) / 1e6;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::pair<std::string, std::string>> fixtures;
+    for (int i = 1; i < argc; i++) {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        fixtures.emplace_back(argv[i], text.str());
+    }
+    if (fixtures.empty()) {
+        fixtures.emplace_back("feed 64 KB", feed_fixture(64 * 1024));
+        fixtures.emplace_back("feed 1 MB", feed_fixture(1024 * 1024));
+        fixtures.emplace_back("feed 16 MB", feed_fixture(16 * 1024 * 1024));
+    }
+
+    std::printf("%-22s %10s %10s %7s %10s %10s %12s\n",
+                "fixture", "identity", "gzip", "ratio", "id. ms", "gzip ms", "decode MB/s");
+    for (const auto& [name, text] : fixtures) {
+        std::string compressed = gzip(text);
+        double identityMs = fetch(text, "");
+        double gzipMs = fetch(compressed, "gzip");
+        bool intact = g_received_bytes.load() == text.size();
+
+        // Best of three, decoder only
+        double bestNs = 1e18;
+        for (int run = 0; run < 3; run++) {
+            auto decoder = HttpDecoder::for_encoding("gzip");
+            std::string out;
+            uint64_t start = bench_now_ns();
+            for (size_t offset = 0; offset < compressed.size(); offset += 64 * 1024) {
+                out.clear();
+                decoder->decode(std::string_view(compressed).substr(offset, 64 * 1024), out);
+            }
+            bestNs = std::min(bestNs, static_cast<double>(bench_now_ns() - start));
+        }
+
+        std::printf("%-22s %10zu %10zu %6.1fx %10.2f %10.2f %12.1f%s\n",
+                    name.c_str(), text.size(), compressed.size(), double(text.size()) / compressed.size(),
+                    identityMs, gzipMs, text.size() / (bestNs / 1e9) / (1024 * 1024), intact ? "" : "  (MISMATCH)");
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+// HttpClient throughput and latency against a loopback HTTP/1.1 server, for a
+// few worker and per-host settings: requests per second, submit-to-callback
+// p50/p99 and the connections the transport had to open.
+//
+//   bench_http_loopback [requests, default 2000]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "LoopbackHttp.h"
+
+static std::atomic<int> g_answered{0};
+static std::vector<uint64_t> g_submitted_ns;
+static std::unique_ptr<std::atomic<uint64_t>[]> g_answered_ns;
+
+static void bench_complete(HttpCall&, const std::vector<HttpRequestId>& waiters) {
+    uint64_t now = bench_now_ns();
+    for (HttpRequestId id : waiters) {
+        if (id == kCancelledWaiter) continue;
+        g_answered_ns[id].store(now);
+        g_answered++;
+    }
+}
+
+int main(int argc, char** argv) {
+    int requests = std::max(10, bench_arg(argc, argv, 2000));
+    g_submitted_ns.assign(requests, 0);
+    g_answered_ns = std::make_unique<std::atomic<uint64_t>[]>(requests);
+
+    auto pass = [&](const char* name, int workers, int maxPerHost, int serverMs) {
+        LoopbackServer server([serverMs](const LoopbackRequest&) {
+            LoopbackResponse response;
+            response.body.assign(1024, 'x');
+            response.delayMs = serverMs;
+            return response;
+        });
+
+        HttpClientConfig config;
+        config.workers = workers;
+        config.maxPerHost = maxPerHost;
+        config.abort = loopback_abort;
+
+        g_answered = 0;
+        uint64_t opened = loopback_connections_opened();
+        uint64_t start = bench_now_ns();
+        {
+            HttpClient client(loopback_transport, bench_complete, config);
+            for (int id = 0; id < requests; id++) {
+                g_submitted_ns[id] = bench_now_ns();
+                client.submit(id, {"GET", server.url("/item/" + std::to_string(id)), "", ""});
+            }
+            while (g_answered.load() < requests) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+
+        std::vector<uint64_t> latency(requests);
+        for (int id = 0; id < requests; id++) latency[id] = g_answered_ns[id].load() - g_submitted_ns[id];
+        std::sort(latency.begin(), latency.end());
+        auto percentile = [&](double p) { return latency[static_cast<size_t>(p * (requests - 1))] / 1e6; };
+
+        std::printf("%-28s %9.0f req/s  p50 %8.2f ms  p99 %8.2f ms  %3llu connections\n",
+                    name, requests / (elapsed / 1e9), percentile(0.5), percentile(0.99),
+                    static_cast<unsigned long long>(loopback_connections_opened() - opened));
+    };
+
+    std::printf("== %d GETs of 1 KB to one host over loopback\n", requests);
+    pass("4 workers, 1 per host", 4, 1, 0);
+    pass("4 workers, 2 per host", 4, 2, 0);
+    pass("4 workers, 4 per host", 4, 4, 0);
+    pass("4 workers, 2 per host, 1 ms", 4, 2, 1);
+    pass("8 workers, 8 per host, 1 ms", 8, 8, 1);
+    return 0;
+}
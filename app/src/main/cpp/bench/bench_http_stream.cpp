@@ -0,0 +1,105 @@
+// A large JSON array feed delivered whole (JsonDocument over the full body) and
+// streamed (JsonArrayStream per chunk): time to the first element, total time
+// and peak RSS.
+//
+//   bench_http_stream [megabytes, default 100]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "HttpClient.h"
+#include "JsonArrayStream.h"
+#include "JsonDocument.h"
+
+// Stand-in server: a JSON array of about g_feed_bytes, generated 64 KB at a time
+// so the fixture itself is never resident
+static size_t g_feed_bytes = 0;
+
+static std::atomic<bool> g_feed_done{false};
+static std::atomic<uint64_t> g_first_item_ns{0};
+static size_t g_feed_items = 0;
+
+static void feed_transport(HttpCall& call) {
+    call.statusCode = 200;
+    constexpr size_t kChunk = 64 * 1024;
+    std::string chunk = "[";
+    chunk.reserve(kChunk + 256);
+
+    char item[256];
+    size_t sent = 0;
+    for (int n = 0; sent + chunk.size() < g_feed_bytes; n++) {
+        chunk.append(item, static_cast<size_t>(feed_item(item, sizeof(item), n)));
+        if (chunk.size() >= kChunk) {
+            if (!call.append(chunk.data(), chunk.size())) return;
+            sent += chunk.size();
+            chunk.clear();
+        }
+    }
+    chunk += ']';
+    call.append(chunk.data(), chunk.size());
+}
+
+// Buffered delivery as before streaming: parse the whole body, then hand out elements
+static void feed_complete_buffered(HttpCall& call, const std::vector<HttpRequestId>&) {
+    JsonDocument doc;
+    if (doc.parse(std::move(call.response))) {
+        uint32_t count = doc.size(doc.root());
+        for (uint32_t i = 0; i < count; i++) {
+            std::string element = doc.value(doc.at(doc.root(), i));
+            if (i == 0) g_first_item_ns = bench_now_ns();
+            g_feed_items++;
+        }
+    }
+    g_feed_done = true;
+}
+
+static void feed_complete_streamed(HttpCall&, const std::vector<HttpRequestId>&) {
+    g_feed_done = true;
+}
+
+int main(int argc, char** argv) {
+    int megabytes = std::max(1, bench_arg(argc, argv, 100));
+    g_feed_bytes = static_cast<size_t>(megabytes) * 1024 * 1024;
+
+    auto pass = [](const char* name, bool streamed) {
+        g_feed_done = false;
+        g_first_item_ns = 0;
+        g_feed_items = 0;
+        reset_peak_rss();
+        long baseKb = peak_rss_kb();
+        uint64_t start = bench_now_ns();
+        {
+            HttpClient client(feed_transport, streamed ? feed_complete_streamed : feed_complete_buffered, {1, 1, false});
+            HttpRequest request{"GET", "http://127.0.0.1/feed.json", "", ""};
+            auto parser = std::make_shared<JsonArrayStream>();
+            if (streamed) {
+                request.stream = [parser](HttpCall&, std::string_view chunk) {
+                    std::vector<std::string> elements;
+                    bool ok = parser->feed(chunk, elements);
+                    if (!elements.empty() && g_feed_items == 0) g_first_item_ns = bench_now_ns();
+                    g_feed_items += elements.size();
+                    return ok;
+                };
+            }
+            client.submit(1, std::move(request));
+            while (!g_feed_done.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        uint64_t elapsed = bench_now_ns() - start;
+        long peakKb = peak_rss_kb();
+
+        std::printf("%-10s %9zu items  first item %9.3f ms  total %9.2f ms  peak RSS +%7.1f MB\n",
+                    name, g_feed_items, g_first_item_ns ? (g_first_item_ns - start) / 1e6 : 0.0,
+                    elapsed / 1e6, (peakKb - baseKb) / 1024.0);
+    };
+
+    std::printf("== %d MB JSON array\n", megabytes);
+    pass("streamed", true);
+    pass("buffered", false);
+    return 0;
+}
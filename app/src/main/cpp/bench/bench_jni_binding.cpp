@@ -0,0 +1,201 @@
+// Cost of reaching MainActivity from a native, per view created: the old path
+// (AttachCurrentThread, GetObjectClass, GetMethodID, call) against the method IDs
+// bound once by android_jni_bind (AndroidJni.h), and against recording the view in
+// a UiCommandBuffer with one applyUiCommands call per screen, which is what the
+// natives do now.
+//
+// The JNIEnv below is a stub: GetMethodID scans the activity's methods comparing
+// name and signature, local references are heap objects and a call costs nothing.
+// So the time measures only the native side of each path; what batching saves is
+// the JNI calls per screen column times a call's cost on the device.
+//
+//   bench_jni_binding [views per screen, default 2200 (200 cards)]
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <android/log.h>
+#include "AndroidJni.h"
+#include "UiCommandBuffer.h"
+#include "bench_util.h"
+
+struct _jmethodID {
+    const char* name;
+    const char* sig;
+};
+
+namespace {
+
+// MainActivity's public methods, in declaration order
+_jmethodID g_methods[] = {
+    {"setToolbarTitle", "(Ljava/lang/String;)V"}, {"setBackButtonVisible", "(Z)V"},
+    {"createScreen", "(ILjava/lang/String;)V"}, {"navigateToScreen", "(I)V"}, {"navigateBack", "()V"},
+    {"showToast", "(Ljava/lang/String;)V"}, {"createButton", "(Ljava/lang/String;III)V"},
+    {"setButtonCallback", "(II)V"}, {"removeView", "(I)V"}, {"createTextView", "(Ljava/lang/String;II)V"},
+    {"createImageView", "(Ljava/lang/String;IIII)V"}, {"createLinearLayout", "(III)V"},
+    {"createScrollView", "(II)V"}, {"createCardView", "(IIII)V"}, {"createRecyclerView", "(III)V"},
+    {"recyclerViewCommit", "(II)V"}, {"recyclerViewNotify", "(IIII)V"}, {"addViewToParent", "(II)V"},
+    {"setViewText", "(ILjava/lang/String;)V"}, {"setViewVisibility", "(II)V"},
+    {"setViewImage", "(ILjava/lang/String;)V"}, {"setViewBackgroundColor", "(II)V"},
+    {"setViewPadding", "(IIIII)V"}, {"setViewSize", "(III)V"}, {"createEditText", "(Ljava/lang/String;II)V"},
+    {"getEditTextValue", "(I)Ljava/lang/String;"}, {"setEditTextHint", "(ILjava/lang/String;)V"},
+    {"setEditTextInputType", "(II)V"}, {"setTextSize", "(II)V"}, {"setTextColor", "(II)V"},
+    {"setTextStyle", "(II)V"}, {"setViewMargin", "(IIIII)V"}, {"setViewGravity", "(II)V"},
+    {"setViewElevation", "(II)V"}, {"setViewCornerRadius", "(II)V"}, {"setViewBorder", "(III)V"},
+    {"defineStyle", "(II[I)V"}, {"applyStyle", "(II)V"},
+    {"httpExecute", "(ILjava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)I"},
+    {"httpAbort", "(I)V"}, {"clearScreen", "(I)V"}, {"applyUiCommands", "(Ljava/nio/ByteBuffer;)V"},
+};
+
+struct StubString : _jobject {
+    std::string utf;
+};
+
+struct StubBuffer : _jobject {
+    void* address = nullptr;
+    jlong capacity = 0;
+};
+
+_jobject g_activity_object;
+JavaVM g_vm;
+JNIEnv g_env;
+thread_local bool t_attached = false;
+uint64_t g_calls = 0;
+
+}  // namespace
+
+extern "C" int __android_log_print(int, const char*, const char*, ...) { return 0; }
+
+jint _JavaVM::GetEnv(void** env, jint) {
+    if (!t_attached) return JNI_EDETACHED;
+    *env = &g_env;
+    return JNI_OK;
+}
+
+jint _JavaVM::AttachCurrentThread(JNIEnv** env, void*) {
+    t_attached = true;
+    *env = &g_env;
+    return JNI_OK;
+}
+
+jint _JavaVM::DetachCurrentThread() {
+    t_attached = false;
+    return JNI_OK;
+}
+
+jint _JNIEnv::GetJavaVM(JavaVM** vm) {
+    *vm = &g_vm;
+    return JNI_OK;
+}
+
+jobject _JNIEnv::NewGlobalRef(jobject obj) { return obj; }
+void _JNIEnv::DeleteGlobalRef(jobject) {}
+
+void _JNIEnv::DeleteLocalRef(jobject obj) {
+    if (obj && obj->local) delete obj;
+}
+
+jclass _JNIEnv::GetObjectClass(jobject) {
+    auto* cls = new _jobject();
+    cls->local = true;
+    return cls;
+}
+
+jmethodID _JNIEnv::GetMethodID(jclass, const char* name, const char* sig) {
+    for (_jmethodID& method : g_methods) {
+        if (std::strcmp(method.name, name) == 0 && std::strcmp(method.sig, sig) == 0) return &method;
+    }
+    return nullptr;
+}
+
+void _JNIEnv::ExceptionClear() {}
+
+jstring _JNIEnv::NewStringUTF(const char* utf) {
+    auto* str = new StubString();
+    str->local = true;
+    str->utf = utf;
+    return str;
+}
+
+const char* _JNIEnv::GetStringUTFChars(jstring str, jboolean*) { return static_cast<StubString*>(str)->utf.c_str(); }
+void _JNIEnv::ReleaseStringUTFChars(jstring, const char*) {}
+
+void _JNIEnv::CallVoidMethod(jobject, jmethodID, ...) { g_calls++; }
+jobject _JNIEnv::CallObjectMethod(jobject, jmethodID, ...) { return nullptr; }
+jint _JNIEnv::CallIntMethod(jobject, jmethodID, ...) { return 0; }
+
+jobject _JNIEnv::NewDirectByteBuffer(void* address, jlong capacity) {
+    auto* buffer = new StubBuffer();
+    buffer->local = true;
+    buffer->address = address;
+    buffer->capacity = capacity;
+    return buffer;
+}
+
+void* _JNIEnv::GetDirectBufferAddress(jobject buf) { return static_cast<StubBuffer*>(buf)->address; }
+
+// One create_textview per view, as the natives were before android_jni_bind
+static void screen_looked_up(int views, const std::vector<std::string>& texts) {
+    for (int i = 0; i < views; i++) {
+        JNIEnv* env;
+        droplet_java_vm->AttachCurrentThread(&env, nullptr);
+        jclass cls = env->GetObjectClass(droplet_activity);
+        jmethodID method = env->GetMethodID(cls, "createTextView", "(Ljava/lang/String;II)V");
+        jstring text = env->NewStringUTF(texts[i].c_str());
+        env->CallVoidMethod(droplet_activity, method, text, 1000 + i, -1);
+        env->DeleteLocalRef(text);
+        env->DeleteLocalRef(cls);
+    }
+}
+
+// Same calls with the environment and method ID cached
+static void screen_cached(int views, const std::vector<std::string>& texts, jmethodID createTextView) {
+    for (int i = 0; i < views; i++) {
+        JNIEnv* env = android_jni_env();
+        jstring text = env->NewStringUTF(texts[i].c_str());
+        env->CallVoidMethod(droplet_activity, createTextView, text, 1000 + i, -1);
+        env->DeleteLocalRef(text);
+    }
+}
+
+// Recorded ops, one JNI call for the screen (android_flush_ui_commands)
+static void screen_batched(int views, const std::vector<std::string>& texts, UiCommandBuffer& buffer) {
+    for (int i = 0; i < views; i++) {
+        buffer.emit(UiOp::CreateTextView, {buffer.intern(texts[i]), 1000 + i, -1});
+    }
+    JNIEnv* env = android_jni_env();
+    jobject batch = env->NewDirectByteBuffer(const_cast<uint8_t*>(buffer.data()), static_cast<jlong>(buffer.size()));
+    env->CallVoidMethod(droplet_activity, g_activity.applyUiCommands, batch);
+    env->DeleteLocalRef(batch);
+    buffer.clear();
+}
+
+int main(int argc, char** argv) {
+    int views = bench_arg(argc, argv, 2200);
+    constexpr int kScreens = 200;
+
+    if (!android_jni_bind(&g_env, &g_activity_object)) return 1;
+    jmethodID createTextView = g_env.GetMethodID(droplet_activity_class, "createTextView", "(Ljava/lang/String;II)V");
+
+    std::vector<std::string> texts;
+    for (int i = 0; i < views; i++) texts.push_back("Bhajan " + std::to_string(i));
+    UiCommandBuffer buffer;
+
+    auto report = [&](const char* name, auto&& screen) {
+        uint64_t calls = g_calls;
+        uint64_t start = bench_now_ns();
+        for (int s = 0; s < kScreens; s++) screen();
+        uint64_t elapsed = bench_now_ns() - start;
+        double perView = static_cast<double>(elapsed) / (static_cast<double>(kScreens) * views);
+        std::printf("%-28s %8.1f ns/view  %8.3f ms/screen  %6llu JNI calls/screen\n", name, perView,
+                    elapsed / 1e6 / kScreens, static_cast<unsigned long long>((g_calls - calls) / kScreens));
+    };
+
+    std::printf("== %d views per screen, %d screens, stub JNIEnv\n", views, kScreens);
+    report("lookup per call (old)", [&] { screen_looked_up(views, texts); });
+    report("cached method ID", [&] { screen_cached(views, texts, createTextView); });
+    report("UiCommandBuffer batch", [&] { screen_batched(views, texts, buffer); });
+    return 0;
+}
@@ -0,0 +1,125 @@
+// JsonDocument against string scanning like the bundle's extract_items does it:
+// native_json_array_items splits the feed into item strings, then native_json_get
+// re-scans an item once per field. Those natives live in the droplet submodule;
+// scan_items/scan_get below reproduce their approach. Each pass reads some fields
+// of every item, for feeds from 1 KB up to `max` bytes: title, image and url of the
+// bhajan feed, then 8 of the 32 fields of a wider record.
+//
+//   bench_json_document [max bytes, default 100000000]
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bench_util.h"
+#include "JsonDocument.h"
+
+static std::string make_feed(size_t bytes) {
+    std::string feed = "[";
+    char item[256];
+    for (int n = 0; feed.size() < bytes; n++) {
+        int length = feed_item(item, sizeof(item), n);
+        feed.append(item, length);
+    }
+    feed += ']';
+    return feed;
+}
+
+static std::string make_wide_feed(size_t bytes) {
+    std::string feed = "[";
+    for (int n = 0; feed.size() < bytes; n++) {
+        feed += n ? ",{" : "{";
+        for (int f = 0; f < 32; f++) {
+            feed += (f ? ",\"f" : "\"f") + std::to_string(f) + "\":\"value " + std::to_string(n) + "\"";
+        }
+        feed += '}';
+    }
+    feed += ']';
+    return feed;
+}
+
+// Top-level elements of an array as separate strings
+static std::vector<std::string> scan_items(std::string_view json) {
+    std::vector<std::string> items;
+    int depth = 0;
+    bool inString = false;
+    size_t start = 0;
+    for (size_t i = 0; i < json.size(); i++) {
+        char c = json[i];
+        if (inString) {
+            if (c == '\\') i++;
+            else if (c == '"') inString = false;
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '[' || c == '{') {
+            if (depth++ == 1) start = i;
+        } else if (c == ']' || c == '}') {
+            if (--depth == 1) items.emplace_back(json.substr(start, i + 1 - start));
+        }
+    }
+    return items;
+}
+
+// String value of "key" in an object, scanning the text from the start
+static std::string scan_get(std::string_view object, std::string_view key) {
+    std::string needle = "\"" + std::string(key) + "\"";
+    size_t at = object.find(needle);
+    if (at == std::string_view::npos) return "";
+    at = object.find(':', at + needle.size());
+    if (at == std::string_view::npos) return "";
+    at = object.find('"', at);
+    if (at == std::string_view::npos) return "";
+    size_t end = at + 1;
+    while (end < object.size() && object[end] != '"') end += object[end] == '\\' ? 2 : 1;
+    return std::string(object.substr(at + 1, end - at - 1));
+}
+
+// Returns false if the two ways disagree
+static bool pass(const std::string& feed, const std::vector<std::string>& fields) {
+    size_t checksum[2] = {0, 0};
+
+    uint64_t start = bench_now_ns();
+    std::vector<std::string> items = scan_items(feed);
+    for (const std::string& item : items) {
+        for (const std::string& field : fields) checksum[0] += scan_get(item, field).size();
+    }
+    uint64_t scanNs = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    JsonDocument document;
+    if (!document.parse(feed)) return false;
+    uint32_t root = document.root();
+    uint32_t count = document.size(root);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t item = document.at(root, i);
+        for (const std::string& field : fields) checksum[1] += document.value(document.field(item, field)).size();
+    }
+    uint64_t documentNs = bench_now_ns() - start;
+
+    if (checksum[0] != checksum[1] || items.size() != count) return false;
+    std::printf("%12zu %8u %14.3f %14.3f %7.2fx\n", feed.size(), count, scanNs / 1e6, documentNs / 1e6,
+                static_cast<double>(scanNs) / static_cast<double>(documentNs));
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t max = static_cast<size_t>(std::max(1000, bench_arg(argc, argv, 100000000)));
+    std::vector<std::string> narrow = {"title", "image", "url"};
+    std::vector<std::string> wide;
+    for (int f = 3; f < 32; f += 4) wide.push_back("f" + std::to_string(f));
+
+    for (bool isWide : {false, true}) {
+        std::printf("== %s\n", isWide ? "32-field records, 8 fields read" : "bhajan feed, 3 fields read");
+        std::printf("%12s %8s %14s %14s %8s\n", "bytes", "items", "scan ms", "document ms", "speedup");
+        for (size_t bytes = 1000; bytes <= max; bytes *= 10) {
+            if (!pass(isWide ? make_wide_feed(bytes) : make_feed(bytes), isWide ? wide : narrow)) {
+                std::fprintf(stderr, "results differ at %zu bytes\n", bytes);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
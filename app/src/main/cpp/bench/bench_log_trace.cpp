@@ -0,0 +1,58 @@
+// Per-call cost of the bridge's logging options on a hot path that logs a view's
+// title: a DROPLET_LOGI below DROPLET_LOG_LEVEL (compiled out, arguments and all),
+// the same line at an enabled level, formatted by a vsnprintf sink standing in for
+// liblog (the device also pays the logd write, so that row is a lower bound), and
+// a DROPLET_TRACE event into the calling thread's ring.
+//
+//   bench_log_trace [calls, default 10000000]
+
+#define DROPLET_LOG_LEVEL ANDROID_LOG_WARN
+#define DROPLET_TRACE_ENABLED 1
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include "bench_util.h"
+#include "AndroidLog.h"
+
+#define LOG_TAG "BenchLog"
+
+static size_t g_logged = 0;
+
+extern "C" int __android_log_print(int, const char*, const char* fmt, ...) {
+    char line[1024];
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    g_logged += static_cast<size_t>(n);
+    return n;
+}
+
+// Stands in for Value::toString() on the title argument
+__attribute__((noinline)) static std::string view_title(int i) {
+    return "Bhajan " + std::to_string(i);
+}
+
+template <typename Call>
+static void measure(const char* name, int calls, Call&& call) {
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < calls; i++) call(i);
+    std::printf("%-26s %8.2f ns/call\n", name, static_cast<double>(bench_now_ns() - start) / calls);
+}
+
+int main(int argc, char** argv) {
+    int calls = bench_arg(argc, argv, 10000000);
+    std::printf("== %d calls\n", calls);
+    measure("DROPLET_LOGI, disabled", calls, [](int i) {
+        DROPLET_LOGI("Created text view %d: %s", i, view_title(i).c_str());
+    });
+    measure("DROPLET_LOGW, enabled", calls, [](int i) {
+        DROPLET_LOGW("Created text view %d: %s", i, view_title(i).c_str());
+    });
+    measure("DROPLET_TRACE", calls, [](int i) {
+        DROPLET_TRACE("create_textview", i, i + 1);
+    });
+    std::printf("(%zu)\n", g_logged & 1);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Native call overhead through the VM stack: bind_native<> against the hand-written
+// argc/pop/type-check marshalling the natives used before, for a two-int setter
+// and a string -> int native. Each call pushes the arguments, runs the native and
+// pops its result, as the interpreter does around a native call.
+//
+// Needs the VM, so it is built only with the droplet submodule checked out.
+//
+//   bench_native_binding [calls, default 10000000]
+
+#include <cstdio>
+#include <string>
+#include "bench_util.h"
+#include "NativeBinding.h"
+
+static int g_sink = 0;
+
+static void set_color(int viewId, int color) {
+    g_sink += viewId ^ color;
+}
+
+static int create_screen(const std::string& name) {
+    return static_cast<int>(name.size()) + g_sink++;
+}
+
+// The pre-bind_native shape of android_set_text_color
+static void manual_set_color(VM& vm, const uint8_t argc) {
+    if (argc < 2) {
+        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
+        vm.stack_manager.push(Value::createNIL());
+        return;
+    }
+    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
+    Value colorVal = vm.stack_manager.pop();
+    Value viewVal = vm.stack_manager.pop();
+    int color = colorVal.type == ValueType::INT ? static_cast<int>(colorVal.current_value.i) : 0;
+    int viewId = viewVal.type == ValueType::INT ? static_cast<int>(viewVal.current_value.i) : -1;
+    set_color(viewId, color);
+    vm.stack_manager.push(Value::createNIL());
+}
+
+// ... and of android_create_screen
+static void manual_create_screen(VM& vm, const uint8_t argc) {
+    if (argc < 1) {
+        vm.stack_manager.push(Value::createINT(-1));
+        return;
+    }
+    for (int i = 1; i < argc; i++) vm.stack_manager.pop();
+    Value nameVal = vm.stack_manager.pop();
+    std::string name = nameVal.toString();
+    vm.stack_manager.push(Value::createINT(create_screen(name)));
+}
+
+template <typename Push>
+static double ns_per_call(VM& vm, NativeFn fn, uint8_t argc, int calls, Push&& push) {
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < calls; i++) {
+        push(i);
+        fn(vm, argc);
+        vm.stack_manager.pop();
+    }
+    return static_cast<double>(bench_now_ns() - start) / calls;
+}
+
+int main(int argc, char** argv) {
+    int calls = bench_arg(argc, argv, 10000000);
+    VM vm;
+    Value name = Value::createOBJECT(vm.allocator.allocate_string("Bhajans"));
+
+    auto pushInts = [&](int i) {
+        vm.stack_manager.push(Value::createINT(1000 + (i & 255)));
+        vm.stack_manager.push(Value::createINT(i));
+    };
+    auto pushName = [&](int) { vm.stack_manager.push(name); };
+
+    std::printf("== %d calls\n", calls);
+    std::printf("%-28s %8.2f ns\n", "set_color, hand-written", ns_per_call(vm, manual_set_color, 2, calls, pushInts));
+    std::printf("%-28s %8.2f ns\n", "set_color, bind_native", ns_per_call(vm, bind_native<set_color>, 2, calls, pushInts));
+    std::printf("%-28s %8.2f ns\n", "create_screen, hand-written",
+                ns_per_call(vm, manual_create_screen, 1, calls, pushName));
+    std::printf("%-28s %8.2f ns\n", "create_screen, bind_native",
+                ns_per_call(vm, bind_native<create_screen>, 1, calls, pushName));
+    std::printf("(%d)\n", g_sink & 1);
+    return 0;
+}
@@ -0,0 +1,75 @@
+// RecyclerStore: appending N rows with a flush (and a UI-side adopt) every few
+// rows, as a streamed feed does, and replace() diffs of an N-row list.
+//
+//   bench_recycler_store [rows, default 100000]
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "RecyclerStore.h"
+
+static size_t flush_and_adopt(RecyclerStore& store, UiCommandBuffer& buffer) {
+    buffer.clear();
+    store.flush_notifications(buffer);
+    UiCommandReader reader(buffer.data(), buffer.size());
+    UiCommand command;
+    while (reader.next(command)) {
+        if (command.op == UiOp::RecyclerViewCommit) store.adopt(command.args[0], command.args[1]);
+    }
+    return buffer.size();
+}
+
+static std::string row_text(int n) {
+    char item[256];
+    int length = feed_item(item, sizeof(item), n);
+    return std::string(item + (n ? 1 : 0), item + length);
+}
+
+int main(int argc, char** argv) {
+    int rows = bench_arg(argc, argv, 100000);
+    std::vector<std::string> texts;
+    texts.reserve(rows);
+    for (int i = 0; i < rows; i++) texts.push_back(row_text(i));
+
+    std::printf("== %d rows\n", rows);
+    for (int every : {1, 100, rows}) {
+        RecyclerStore store;
+        UiCommandBuffer buffer;
+        size_t bytes = 0;
+        uint64_t start = bench_now_ns();
+        for (int i = 0; i < rows; i++) {
+            store.append(1, texts[i]);
+            if ((i + 1) % every == 0) bytes += flush_and_adopt(store, buffer);
+        }
+        bytes += flush_and_adopt(store, buffer);
+        uint64_t elapsed = bench_now_ns() - start;
+        std::printf("append, flush every %6d  %8.1f ms  %6.0f ns/row  %9zu op bytes\n", every, elapsed / 1e6,
+                    static_cast<double>(elapsed) / rows, bytes);
+    }
+
+    auto diff = [&](const char* name, std::vector<std::string> next) {
+        RecyclerStore store;
+        UiCommandBuffer buffer;
+        store.replace(1, texts);
+        flush_and_adopt(store, buffer);
+
+        uint64_t start = bench_now_ns();
+        store.replace(1, next);
+        size_t bytes = flush_and_adopt(store, buffer);
+        uint64_t elapsed = bench_now_ns() - start;
+        std::printf("replace, %-20s %8.1f ms  %9zu op bytes\n", name, elapsed / 1e6, bytes);
+    };
+
+    std::vector<std::string> next = texts;
+    for (int i = rows / 2; i < rows / 2 + rows / 100; i++) next[i] += " (edited)";
+    diff("1% edited mid-list", next);
+
+    next = texts;
+    for (int i = rows; i < rows + rows / 100; i++) next.push_back(row_text(i));
+    diff("1% appended", next);
+
+    next.assign(texts.begin() + 1, texts.end());
+    diff("first row removed", next);
+    return 0;
+}
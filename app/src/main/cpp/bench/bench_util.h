@@ -0,0 +1,49 @@
+#ifndef MIST_BENCH_UTIL_H
+#define MIST_BENCH_UTIL_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Shared by the host benchmarks; each prints one line per measured pass.
+
+inline uint64_t bench_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// First command line argument as a count, `fallback` if absent
+inline int bench_arg(int argc, char** argv, int fallback) {
+    return argc >= 2 ? std::atoi(argv[1]) : fallback;
+}
+
+// Peak resident set since the last reset_peak_rss(), from /proc
+inline void reset_peak_rss() {
+    if (FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+}
+
+inline long peak_rss_kb() {
+    long kb = -1;
+    if (FILE* f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), f)) {
+            if (std::sscanf(line, "VmHWM: %ld kB", &kb) == 1) break;
+        }
+        std::fclose(f);
+    }
+    return kb;
+}
+
+// Item `n` of a list feed like the bhajan one, with a leading comma after the first
+inline int feed_item(char* out, size_t size, int n) {
+    return std::snprintf(out, size,
+                         "%s{\"id\":%d,\"title\":\"Bhajan %d\",\"image\":\"https://example.com/img/%d.jpg\","
+                         "\"url\":\"https://example.com/audio/%d.mp3\"}", n ? "," : "", n, n, n, n);
+}
+
+#endif //MIST_BENCH_UTIL_H
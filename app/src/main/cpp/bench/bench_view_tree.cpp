@@ -0,0 +1,81 @@
+// Retained tree reconciliation: a screen of cards built, then rebuilt unchanged,
+// with 1% of the text changed, half gone and grown back.
+//
+//   bench_view_tree [views, default 10000]
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "bench_util.h"
+#include "ViewTree.h"
+
+// `cards` cards of ten text views each, placed through ViewTree the way the
+// create/set natives do; every changedEvery-th row gets different text.
+// Returns the number of ops the pass sent.
+static size_t build_cards(ViewTree& tree, UiCommandBuffer& out, int& nextId, int cards, int changedEvery) {
+    auto place = [&](UiOp kind, int parentId, bool& created) {
+        int viewId = tree.reuse(parentId, kind, {});
+        created = viewId == -1;
+        if (created) {
+            viewId = nextId++;
+            tree.insert(viewId, parentId, kind, {});
+        }
+        return viewId;
+    };
+
+    char text[32];
+    bool created;
+    for (int card = 0; card < cards; card++) {
+        int cardId = place(UiOp::CreateCardView, -1, created);
+        if (created) out.emit(UiOp::CreateCardView, {cardId, -1, 8, 8});
+        if (tree.update(UiOp::SetViewPadding, {cardId, 16, 16, 16, 16})) {
+            out.emit(UiOp::SetViewPadding, {cardId, 16, 16, 16, 16});
+        }
+
+        for (int row = 0; row < 10; row++) {
+            int n = card * 10 + row;
+            std::snprintf(text, sizeof(text), "row %d%s", n, changedEvery && n % changedEvery == 0 ? "*" : "");
+            int viewId = place(UiOp::CreateTextView, cardId, created);
+            bool textChanged = tree.update(UiOp::SetViewText, {viewId}, text);
+            if (created) {
+                out.emit(UiOp::CreateTextView, {out.intern(text), viewId, cardId});
+            } else if (textChanged) {
+                out.emit(UiOp::SetViewText, {viewId, out.intern(text)});
+            }
+        }
+    }
+
+    size_t ops = 0;
+    UiCommandReader reader(out.data(), out.size());
+    UiCommand command;
+    while (reader.next(command)) ops++;
+    out.clear();
+    return ops;
+}
+
+int main(int argc, char** argv) {
+    int cards = std::max(1, bench_arg(argc, argv, 10000) / 11);
+    ViewTree tree;
+    UiCommandBuffer out;
+    int nextId = 1000;
+    std::vector<ViewTree::Removed> removed;
+
+    auto pass = [&](const char* name, bool rebuild, int cardCount, int changedEvery) {
+        uint64_t start = bench_now_ns();
+        if (rebuild) tree.begin_rebuild(-1);
+        size_t ops = build_cards(tree, out, nextId, cardCount, changedEvery);
+        removed.clear();
+        if (rebuild) tree.end_rebuild(removed);
+        uint64_t elapsed = bench_now_ns() - start;
+        std::printf("%-24s %10.3f ms  %8zu ops  %6zu removed  %8zu nodes\n",
+                    name, elapsed / 1e6, ops, removed.size(), tree.size());
+    };
+
+    std::printf("== tree of %d views\n", cards * 11);
+    pass("initial build", false, cards, 0);
+    pass("rebuild, unchanged", true, cards, 0);
+    pass("rebuild, 1% changed", true, cards, 100);
+    pass("rebuild, last half gone", true, cards / 2, 100);
+    pass("rebuild, grown back", true, cards, 100);
+    return 0;
+}
@@ -1,9 +1,13 @@
 #include "droplet_vm_wrapper.h"
+#include "vm_event_loop.h"
 #include "droplet/src/vm/Loader.h"
 #include "droplet/src/native/Native.h"
 #include "droplet/src/native/NativeRegisteries.h"
 #include "registries/AndroidNative.h"
+#include "registries/AndroidLog.h"
 #include "registries/AndroidRegistries.h"
+#include "registries/JsonNative.h"
+#include "registries/SpanTrace.h"
 #include <android/log.h>
 #include <memory>
 #include <mutex>
@@ -11,19 +15,38 @@
 class DropletVMWrapperImpl {
 public:
     std::unique_ptr<VM> vm;
+    // The only thread that touches vm once started
+    VmEventLoop loop{android_dispatch_vm_event};
+    // Where the span trace is written on shutdown, next to the last bundle run
+    std::string tracePath;
 
     DropletVMWrapperImpl() {
+        if constexpr (DROPLET_SPANS_ENABLED) droplet_spans_set_recording(true);
         vm = std::make_unique<VM>();
         android_set_vm_instance(vm.get());
         initCoreBuiltins();
         initAndroidBuiltins();
         register_native_functions(*vm);
         register_android_native_functions(*vm);
+        register_json_native_functions(*vm);
+        loop.start();
+        android_set_event_loop(&loop);
+        android_http_start();
         __android_log_print(ANDROID_LOG_INFO, "Droplet", "VM created (singleton)");
     }
 
     ~DropletVMWrapperImpl() {
+        android_set_event_loop(nullptr);
+        loop.stop();
+        // After the VM thread is gone: nothing submits any more, completions are dropped
+        android_http_shutdown();
+        android_reset_vm_state();
         android_set_vm_instance(nullptr);
+        if constexpr (DROPLET_TRACE_ENABLED) droplet_trace_dump();
+        if (droplet_spans_recording() && !tracePath.empty()) {
+            droplet_spans_write_json(tracePath);
+            __android_log_print(ANDROID_LOG_INFO, "Droplet", "Spans written to %s", tracePath.c_str());
+        }
         __android_log_print(ANDROID_LOG_INFO, "Droplet", "VM destroyed");
     }
 };
@@ -47,13 +70,16 @@ void DropletVMWrapper::destroyInstance() {
     s_impl.reset();
 }
 
-void DropletVMWrapper::runBytecode(const std::string &path) {
-    if (!s_impl) return;
-
+// Runs on the VM thread
+static void run_bytecode(VM& vm, const std::string &path) {
     Loader loader;
-    auto& vm = *s_impl->vm;
 
-    if (!loader.load_dbc_file(path, vm)) {
+    bool loaded;
+    {
+        DROPLET_SPAN("Loader::load_dbc_file");
+        loaded = loader.load_dbc_file(path, vm);
+    }
+    if (!loaded) {
         __android_log_print(ANDROID_LOG_ERROR, "Droplet", "Failed to load %s", path.c_str());
         return;
     }
@@ -64,8 +90,26 @@ void DropletVMWrapper::runBytecode(const std::string &path) {
         return;
     }
 
-    vm.call_function_by_index(mainIdx, 0);
-    vm.run();
+    {
+        DROPLET_SPAN("VM::run");
+        vm.call_function_by_index(mainIdx, 0);
+        vm.run();
+    }
+    android_flush_ui_commands();
+}
+
+void DropletVMWrapper::runBytecode(const std::string &path) {
+    if (!s_impl) return;
+
+    VM* vm = s_impl->vm.get();
+    s_impl->tracePath = path + ".trace.json";
+    VmEvent event;
+    event.task = [vm, path] {
+        // Cached responses live next to the bundle, so they survive restarts
+        android_http_cache_open(path.substr(0, path.find_last_of('/') + 1) + "http-cache");
+        run_bytecode(*vm, path);
+    };
+    s_impl->loop.post(std::move(event));
 }
 
 VM* DropletVMWrapper::getVM() {
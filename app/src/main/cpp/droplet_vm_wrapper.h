@@ -9,6 +9,7 @@ public:
     static DropletVMWrapper* getInstance();
     static void destroyInstance();
 
+    // Queues load + main() on the VM thread and returns immediately
     void runBytecode(const std::string &bytecodePath);
     VM* getVM();
 };
@@ -0,0 +1,226 @@
+#include "FakeActivity.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+// JNI entry points the fake calls back into, as MainActivity would
+extern "C" jboolean Java_com_mist_example_MainActivity_onHttpChunk(JNIEnv* env, jobject thiz, jint requestId,
+                                                                   jobject buffer, jint length);
+extern "C" void Java_com_mist_example_MainActivity_onHttpHeaders(JNIEnv* env, jobject thiz, jint requestId,
+                                                                 jint statusCode, jstring headers);
+
+struct _jmethodID {
+    const char* name;
+};
+
+namespace {
+
+struct FakeString : _jobject {
+    std::string utf;
+};
+
+struct FakeBuffer : _jobject {
+    void* address = nullptr;
+    jlong capacity = 0;
+};
+
+_jobject g_activity_object;
+_jobject g_activity_class;
+JavaVM g_vm;
+JNIEnv g_env;  // stateless, shared by every thread
+
+_jmethodID g_apply_ui_commands{"applyUiCommands"};
+_jmethodID g_get_edit_text_value{"getEditTextValue"};
+_jmethodID g_http_execute{"httpExecute"};
+_jmethodID g_http_abort{"httpAbort"};  // the canned answers never block, nothing to abort
+
+FakeActivityStats g_stats;
+std::string g_http_body;
+std::string g_http_etag;
+bool g_http_body_set = false;
+
+// g_http_etag as it appears inside a JSON string
+std::string escaped_etag() {
+    std::string out;
+    for (char c : g_http_etag) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void apply_ui_commands(FakeBuffer* buffer) {
+    uint64_t now = fake_now_ns();
+    uint64_t expected = 0;
+    g_stats.firstBatchNs.compare_exchange_strong(expected, now);
+    g_stats.lastBatchNs.store(now);
+    g_stats.uiBatches++;
+    g_stats.uiBytes += static_cast<uint64_t>(buffer->capacity);
+
+    UiCommandReader reader(static_cast<const uint8_t*>(buffer->address), static_cast<size_t>(buffer->capacity));
+    UiCommand command;
+    while (reader.next(command)) {
+        g_stats.uiOps++;
+        g_stats.opCounts[static_cast<size_t>(command.op)]++;
+        if (command.op == UiOp::CreateButton) {
+            std::lock_guard<std::mutex> lock(g_stats.buttonsMutex);
+            g_stats.buttonCallbacks.push_back(command.args[2]);
+        }
+    }
+}
+
+jint http_execute(jint requestId, const std::string& requestHeaders) {
+    g_stats.httpStarted++;
+    jint status = 404;
+    if (g_http_body_set) {
+        bool notModified = requestHeaders.find("\"If-None-Match\":\"" + escaped_etag()) != std::string::npos;
+        status = notModified ? 304 : 200;
+        if (notModified) g_stats.httpNotModified++;
+    }
+
+    // Validators, like a static file server would send them
+    std::string headerText = g_http_body_set ? "ETag: " + g_http_etag + "\nCache-Control: no-cache\n" : "";
+    jstring headers = g_env.NewStringUTF(headerText.c_str());
+    Java_com_mist_example_MainActivity_onHttpHeaders(&g_env, &g_activity_object, requestId, status, headers);
+    g_env.DeleteLocalRef(headers);
+
+    if (status == 200) {
+        // Same 64 KB chunking as MainActivity.httpExecute
+        constexpr size_t kChunk = 64 * 1024;
+        for (size_t offset = 0; offset < g_http_body.size(); offset += kChunk) {
+            size_t length = std::min(kChunk, g_http_body.size() - offset);
+            jobject chunk = g_env.NewDirectByteBuffer(g_http_body.data() + offset, static_cast<jlong>(length));
+            jboolean more = Java_com_mist_example_MainActivity_onHttpChunk(&g_env, &g_activity_object, requestId,
+                                                                           chunk, static_cast<jint>(length));
+            g_env.DeleteLocalRef(chunk);
+            if (!more) break;
+        }
+    }
+    g_stats.httpFinished++;
+    return status;
+}
+
+}  // namespace
+
+JNIEnv* fake_jni_env() { return &g_env; }
+jobject fake_activity() { return &g_activity_object; }
+FakeActivityStats& fake_activity_stats() { return g_stats; }
+
+void fake_activity_set_http_body(std::string body) {
+    g_http_body = std::move(body);
+    g_http_body_set = true;
+
+    char etag[24];
+    std::snprintf(etag, sizeof(etag), "\"%zx\"", std::hash<std::string>{}(g_http_body));
+    g_http_etag = etag;
+}
+
+uint64_t fake_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    static const char kLevels[] = "??VDIWEFS";
+    std::fprintf(stderr, "%c/%s: ", (prio >= 0 && prio <= 8) ? kLevels[prio] : '?', tag);
+    va_list args;
+    va_start(args, fmt);
+    int written = std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return written;
+}
+
+// ---- JavaVM ----
+
+jint _JavaVM::GetEnv(void** env, jint) {
+    *env = &g_env;
+    return JNI_OK;
+}
+
+jint _JavaVM::AttachCurrentThread(JNIEnv** env, void*) {
+    *env = &g_env;
+    return JNI_OK;
+}
+
+jint _JavaVM::DetachCurrentThread() { return JNI_OK; }
+
+// ---- JNIEnv ----
+
+jint _JNIEnv::GetJavaVM(JavaVM** vm) {
+    *vm = &g_vm;
+    return JNI_OK;
+}
+
+jobject _JNIEnv::NewGlobalRef(jobject obj) { return obj; }
+void _JNIEnv::DeleteGlobalRef(jobject) {}
+
+void _JNIEnv::DeleteLocalRef(jobject obj) {
+    if (obj && obj->local) delete obj;
+}
+
+jclass _JNIEnv::GetObjectClass(jobject) { return &g_activity_class; }
+
+jmethodID _JNIEnv::GetMethodID(jclass, const char* name, const char*) {
+    for (_jmethodID* method : {&g_apply_ui_commands, &g_get_edit_text_value, &g_http_execute, &g_http_abort}) {
+        if (std::strcmp(method->name, name) == 0) return method;
+    }
+    return nullptr;
+}
+
+void _JNIEnv::ExceptionClear() {}
+
+jstring _JNIEnv::NewStringUTF(const char* utf) {
+    auto* str = new FakeString();
+    str->local = true;
+    str->utf = utf ? utf : "";
+    return str;
+}
+
+const char* _JNIEnv::GetStringUTFChars(jstring str, jboolean* isCopy) {
+    if (isCopy) *isCopy = JNI_FALSE;
+    return static_cast<FakeString*>(str)->utf.c_str();
+}
+
+void _JNIEnv::ReleaseStringUTFChars(jstring, const char*) {}
+
+void _JNIEnv::CallVoidMethod(jobject, jmethodID method, ...) {
+    va_list args;
+    va_start(args, method);
+    if (method == &g_apply_ui_commands) apply_ui_commands(static_cast<FakeBuffer*>(va_arg(args, jobject)));
+    va_end(args);
+}
+
+jobject _JNIEnv::CallObjectMethod(jobject, jmethodID method, ...) {
+    // getEditTextValue: nothing was typed on the host
+    return method == &g_get_edit_text_value ? NewStringUTF("") : nullptr;
+}
+
+jint _JNIEnv::CallIntMethod(jobject, jmethodID method, ...) {
+    if (method != &g_http_execute) return 0;
+
+    va_list args;
+    va_start(args, method);
+    jint requestId = va_arg(args, jint);
+    for (int skipped = 0; skipped < 3; skipped++) va_arg(args, jstring);  // method, url, body
+    auto* headers = static_cast<FakeString*>(va_arg(args, jstring));
+    va_end(args);
+    return http_execute(requestId, headers ? headers->utf : std::string());
+}
+
+jobject _JNIEnv::NewDirectByteBuffer(void* address, jlong capacity) {
+    auto* buffer = new FakeBuffer();
+    buffer->local = true;
+    buffer->address = address;
+    buffer->capacity = capacity;
+    return buffer;
+}
+
+void* _JNIEnv::GetDirectBufferAddress(jobject buf) {
+    return static_cast<FakeBuffer*>(buf)->address;
+}
@@ -0,0 +1,40 @@
+#ifndef MIST_FAKEACTIVITY_H
+#define MIST_FAKEACTIVITY_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <jni.h>
+#include "../registries/UiCommandBuffer.h"
+
+// Recording stand-in for MainActivity on host builds. UI batches are decoded
+// and counted instead of applied, HTTP requests are answered with a canned body.
+struct FakeActivityStats {
+    std::atomic<uint64_t> uiBatches{0};
+    std::atomic<uint64_t> uiOps{0};
+    std::atomic<uint64_t> uiBytes{0};
+    std::atomic<uint64_t> opCounts[static_cast<size_t>(UiOp::Count)] = {};
+    std::atomic<uint64_t> firstBatchNs{0};
+    std::atomic<uint64_t> lastBatchNs{0};
+
+    std::atomic<uint64_t> httpStarted{0};
+    std::atomic<uint64_t> httpFinished{0};
+    std::atomic<uint64_t> httpNotModified{0};  // answered 304 to a matching If-None-Match
+
+    std::mutex buttonsMutex;
+    std::vector<int> buttonCallbacks;  // callback ids of every CreateButton seen
+};
+
+JNIEnv* fake_jni_env();
+jobject fake_activity();
+FakeActivityStats& fake_activity_stats();
+
+// Body returned (status 200, with an ETag and Cache-Control: no-cache) for every
+// HTTP request; none configured means 404
+void fake_activity_set_http_body(std::string body);
+
+uint64_t fake_now_ns();
+
+#endif //MIST_FAKEACTIVITY_H
@@ -0,0 +1,368 @@
+#include "LoopbackHttp.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <charconv>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace {
+
+void set_nodelay(int fd) {
+    int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+bool send_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(n));
+    }
+    return true;
+}
+
+// Appends what one recv() returns; false on EOF or error
+bool recv_some(int fd, std::string& buffer) {
+    char chunk[16 * 1024];
+    while (true) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+}
+
+// Reads until `buffer` holds a whole header block; returns the offset past its blank line
+size_t read_head(int fd, std::string& buffer) {
+    size_t end;
+    while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (!recv_some(fd, buffer)) return std::string::npos;
+    }
+    return end + 4;
+}
+
+// "Name: value" lines of a CRLF header block (after its first line)
+std::string header_lines(std::string_view head) {
+    std::string lines;
+    size_t start = head.find("\r\n");
+    while (start != std::string_view::npos && start + 2 < head.size()) {
+        start += 2;
+        size_t end = head.find("\r\n", start);
+        std::string_view line = head.substr(start, end - start);
+        if (!line.empty()) {
+            lines.append(line);
+            lines += '\n';
+        }
+        start = end;
+    }
+    return lines;
+}
+
+size_t content_length(std::string_view headers) {
+    std::string_view value = http_header(headers, "Content-Length");
+    size_t length = 0;
+    std::from_chars(value.data(), value.data() + value.size(), length);
+    return length;
+}
+
+// The JSON object of string fields Droplet code passes as request headers, as CRLF lines
+std::string json_header_lines(std::string_view json) {
+    std::string lines;
+    std::string strings[2];
+    int have = 0;
+    for (size_t i = 0; i < json.size(); i++) {
+        if (json[i] != '"') continue;
+        std::string& s = strings[have];
+        s.clear();
+        for (i++; i < json.size() && json[i] != '"'; i++) {
+            if (json[i] == '\\' && i + 1 < json.size()) i++;
+            s += json[i];
+        }
+        if (++have == 2) {
+            lines += strings[0] + ": " + strings[1] + "\r\n";
+            have = 0;
+        }
+    }
+    return lines;
+}
+
+// ---- Transport ----
+
+std::atomic<uint64_t> g_connections_opened{0};
+
+// Socket of each call in progress, so loopback_abort can shut it down
+std::mutex g_active_mutex;
+std::unordered_map<HttpCall*, int> g_active;
+
+// Idle keep-alive connection per "host:port", per worker thread
+thread_local std::unordered_map<std::string, int> t_idle;
+
+int connect_to(const std::string& hostPort) {
+    size_t colon = hostPort.rfind(':');
+    std::string host = hostPort.substr(0, colon);
+    int port = 80;
+    if (colon != std::string::npos) {
+        std::from_chars(hostPort.data() + colon + 1, hostPort.data() + hostPort.size(), port);
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) return -1;
+
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    set_nodelay(fd);
+    g_connections_opened++;
+    return fd;
+}
+
+void track(HttpCall& call, int fd) {
+    std::lock_guard<std::mutex> lock(g_active_mutex);
+    if (fd >= 0) {
+        g_active[&call] = fd;
+    } else {
+        g_active.erase(&call);
+    }
+}
+
+// Untracked before it is closed, so an abort never shuts down a recycled descriptor
+void drop(HttpCall& call, int fd) {
+    track(call, -1);
+    ::close(fd);
+}
+
+// Sends the request and reads until `buffer` holds the response head, which
+// ends at `headEnd`. False if the connection failed before the head arrived.
+bool exchange(int fd, const std::string& request, std::string& buffer, size_t& headEnd) {
+    buffer.clear();
+    if (!send_all(fd, request)) return false;
+    headEnd = read_head(fd, buffer);
+    return headEnd != std::string::npos;
+}
+
+}  // namespace
+
+void loopback_transport(HttpCall& call) {
+    const HttpRequest& request = call.request;
+    auto fail = [&](const char* message) {
+        call.statusCode = 0;
+        call.response = message;
+    };
+
+    constexpr std::string_view kScheme = "http://";
+    if (request.url.compare(0, kScheme.size(), kScheme) != 0) return fail("Error: not an http:// URL");
+    size_t slash = request.url.find('/', kScheme.size());
+    std::string hostPort = request.url.substr(kScheme.size(), slash - kScheme.size());
+    std::string target = slash == std::string::npos ? "/" : request.url.substr(slash);
+
+    std::string message = request.method + " " + target + " HTTP/1.1\r\nHost: " + hostPort +
+                          "\r\nContent-Length: " + std::to_string(request.body.size()) + "\r\n" +
+                          json_header_lines(request.headers) + "\r\n" + request.body;
+
+    // A pooled connection the server has since closed gets one retry on a fresh one
+    int fd = -1;
+    bool reused = false;
+    auto idle = t_idle.find(hostPort);
+    if (idle != t_idle.end()) {
+        fd = idle->second;
+        reused = true;
+        t_idle.erase(idle);
+    }
+
+    std::string buffer;
+    size_t headEnd = 0;
+    for (int attempt = 0;; attempt++) {
+        if (fd < 0) fd = connect_to(hostPort);
+        if (fd < 0) return fail("Error: connection refused");
+        track(call, fd);
+        if (call.cancelled.load()) {
+            drop(call, fd);
+            return fail("Error: cancelled");
+        }
+        if (exchange(fd, message, buffer, headEnd)) break;
+
+        drop(call, fd);
+        fd = -1;
+        if (!reused || attempt > 0 || call.cancelled.load()) return fail("Error: connection lost");
+    }
+
+    std::string_view head(buffer.data(), headEnd);
+    int status = 0;
+    size_t space = head.find(' ');
+    if (space != std::string_view::npos) std::from_chars(head.data() + space + 1, head.data() + head.size(), status);
+    std::string headers = header_lines(head.substr(0, headEnd - 2));
+    size_t length = content_length(headers);
+    bool keepAlive = http_header(headers, "Connection") != "close";
+
+    call.statusCode = status;
+    call.set_response_headers(std::move(headers));
+
+    // Body: whatever came with the head, then the rest as it arrives
+    buffer.erase(0, headEnd);
+    size_t received = 0;
+    bool lost = false;
+    bool stopped = false;  // the call refused more body: cancelled or undecodable
+    while (received < length) {
+        if (buffer.empty() && !recv_some(fd, buffer)) {
+            lost = true;
+            break;
+        }
+        size_t take = std::min(buffer.size(), length - received);
+        if (!call.append(buffer.data(), take)) {
+            stopped = true;
+            break;
+        }
+        received += take;
+        buffer.erase(0, take);
+    }
+
+    if (lost || stopped || !keepAlive || !buffer.empty()) {
+        drop(call, fd);
+        if (lost && !call.cancelled.load()) fail("Error: connection lost");
+        return;
+    }
+    track(call, -1);
+    auto [slot, inserted] = t_idle.emplace(hostPort, fd);
+    if (!inserted) {
+        ::close(slot->second);
+        slot->second = fd;
+    }
+}
+
+void loopback_abort(HttpCall& call) {
+    std::lock_guard<std::mutex> lock(g_active_mutex);
+    auto it = g_active.find(&call);
+    if (it != g_active.end()) ::shutdown(it->second, SHUT_RDWR);
+}
+
+uint64_t loopback_connections_opened() {
+    return g_connections_opened.load();
+}
+
+// ---- Server ----
+
+LoopbackServer::LoopbackServer(Handler handler) : handler(std::move(handler)) {
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int on = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;  // any free port
+    socklen_t size = sizeof(address);
+    ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::listen(listenFd, 128);
+    ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &size);
+    port = ntohs(address.sin_port);
+
+    acceptor = std::thread([this] { accept_loop(); });
+}
+
+LoopbackServer::~LoopbackServer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (int fd : clients) ::shutdown(fd, SHUT_RDWR);
+    }
+    stopped.notify_all();
+    ::shutdown(listenFd, SHUT_RDWR);
+    acceptor.join();
+    ::close(listenFd);
+    for (auto& thread : threads) thread.join();
+}
+
+std::string LoopbackServer::url(std::string_view path) const {
+    return "http://127.0.0.1:" + std::to_string(port) + std::string(path);
+}
+
+void LoopbackServer::accept_loop() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            if (fd >= 0) ::close(fd);
+            return;
+        }
+        if (fd < 0) continue;
+
+        set_nodelay(fd);
+        accepted++;
+        clients.push_back(fd);
+        threads.emplace_back([this, fd] { serve(fd); });
+    }
+}
+
+void LoopbackServer::serve(int fd) {
+    std::string buffer;
+    while (true) {
+        size_t headEnd = read_head(fd, buffer);
+        if (headEnd == std::string::npos) break;
+
+        LoopbackRequest request;
+        std::string_view head(buffer.data(), headEnd);
+        size_t space = head.find(' ');
+        size_t space2 = head.find(' ', space + 1);
+        request.method.assign(head.substr(0, space));
+        request.target.assign(head.substr(space + 1, space2 - space - 1));
+        request.headers = header_lines(head.substr(0, headEnd - 2));
+
+        size_t length = content_length(request.headers);
+        while (buffer.size() < headEnd + length) {
+            if (!recv_some(fd, buffer)) break;
+        }
+        if (buffer.size() < headEnd + length) break;
+        request.body = buffer.substr(headEnd, length);
+        buffer.erase(0, headEnd + length);
+
+        int now = ++active;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+        served++;
+
+        LoopbackResponse response = handler(request);
+        if (response.hang || response.delayMs > 0) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (response.hang) {
+                stopped.wait(lock, [this] { return stopping; });
+            } else {
+                stopped.wait_for(lock, std::chrono::milliseconds(response.delayMs), [this] { return stopping; });
+            }
+        }
+        if (response.hang) {
+            active--;
+            break;
+        }
+
+        std::string message = "HTTP/1.1 " + std::to_string(response.status) + " X\r\nContent-Length: " +
+                              std::to_string(response.body.size()) + "\r\n";
+        for (size_t start = 0; start < response.headers.size();) {
+            size_t end = response.headers.find('\n', start);
+            if (end == std::string::npos) end = response.headers.size();
+            message.append(response.headers, start, end - start);
+            message += "\r\n";
+            start = end + 1;
+        }
+        message += "\r\n";
+        message += response.body;
+        bool sent = send_all(fd, message);
+        active--;
+        if (!sent) break;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    clients.erase(std::find(clients.begin(), clients.end(), fd));
+    ::close(fd);
+}
@@ -0,0 +1,82 @@
+#ifndef MIST_LOOPBACKHTTP_H
+#define MIST_LOOPBACKHTTP_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../registries/HttpClient.h"
+
+// HTTP/1.1 over 127.0.0.1 for the host tests and benchmarks: a small threaded
+// server with keep-alive that counts what it serves, and an HttpClient transport
+// that talks to it over plain sockets. The transport keeps one idle connection
+// per host on each worker thread, as HttpURLConnection's pool would, and its
+// abort closes the socket the way MainActivity.httpAbort does.
+
+struct LoopbackRequest {
+    std::string method;
+    std::string target;   // path and query
+    std::string headers;  // "Name: value" lines
+    std::string body;
+};
+
+struct LoopbackResponse {
+    int status = 200;
+    std::string headers;  // "Name: value" lines; Content-Length is added
+    std::string body;
+    int delayMs = 0;      // before the response is sent
+    bool hang = false;    // never answered: the connection is held until the server stops
+};
+
+class LoopbackServer {
+public:
+    // Called on the connection's thread, so handlers must be thread safe
+    using Handler = std::function<LoopbackResponse(const LoopbackRequest& request)>;
+
+    explicit LoopbackServer(Handler handler);
+    ~LoopbackServer();
+
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+    // "http://127.0.0.1:<port>" followed by `path`
+    std::string url(std::string_view path) const;
+
+    uint64_t requests() const { return served.load(); }
+    uint64_t connections() const { return accepted.load(); }
+    int peak_concurrency() const { return peak.load(); }  // most requests being handled at once
+
+private:
+    void accept_loop();
+    void serve(int fd);
+
+    Handler handler;
+    int listenFd = -1;
+    int port = 0;
+
+    std::atomic<uint64_t> served{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+
+    std::mutex mutex;
+    std::condition_variable stopped;
+    bool stopping = false;
+    std::vector<int> clients;
+    std::vector<std::thread> threads;
+    std::thread acceptor;
+};
+
+// HttpTransport and HttpAbort for plain http:// URLs
+void loopback_transport(HttpCall& call);
+void loopback_abort(HttpCall& call);
+
+// Connections the transport has opened so far, across all threads
+uint64_t loopback_connections_opened();
+
+#endif //MIST_LOOPBACKHTTP_H
@@ -0,0 +1,21 @@
+#ifndef MIST_HOST_ANDROID_LOG_H
+#define MIST_HOST_ANDROID_LOG_H
+
+// Host stand-in for liblog: messages go to stderr
+
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+extern "C" int __android_log_print(int prio, const char* tag, const char* fmt, ...)
+        __attribute__((format(printf, 3, 4)));
+
+#endif //MIST_HOST_ANDROID_LOG_H
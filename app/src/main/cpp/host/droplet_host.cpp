@@ -0,0 +1,142 @@
+// Host driver for the bridge: runs a bundle against the recording MainActivity
+// and reports UI batch, op and allocation counts.
+//
+//   droplet_host bundle.dbc [--http-body response.json] [--click-all] [--idle-ms 200]
+//
+// Benchmarks of the VM-free parts are separate executables, see bench/.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FakeActivity.h"
+#include "../droplet_vm_wrapper.h"
+
+extern "C" void Java_com_mist_example_MainActivity_registerVM(JNIEnv* env, jobject thiz);
+extern "C" void Java_com_mist_example_MainActivity_onButtonClick(JNIEnv* env, jobject thiz, jint callbackId);
+
+// ---- Allocation counting ----
+
+static std::atomic<uint64_t> g_allocations{0};
+static std::atomic<uint64_t> g_allocated_bytes{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Returns once no UI batch has arrived and no HTTP call has been running for idleMs
+static void wait_for_idle(int idleMs) {
+    FakeActivityStats& stats = fake_activity_stats();
+    uint64_t seen = stats.uiBatches.load();
+    auto quietSince = std::chrono::steady_clock::now();
+
+    while (std::chrono::steady_clock::now() - quietSince < std::chrono::milliseconds(idleMs)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        uint64_t batches = stats.uiBatches.load();
+        bool httpBusy = stats.httpStarted.load() != stats.httpFinished.load();
+        if (batches != seen || httpBusy) {
+            seen = batches;
+            quietSince = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+static void print_report(const char* phase, uint64_t startNs, uint64_t allocationsBefore, uint64_t bytesBefore) {
+    FakeActivityStats& stats = fake_activity_stats();
+    uint64_t first = stats.firstBatchNs.load();
+    uint64_t last = stats.lastBatchNs.load();
+
+    std::printf("== %s\n", phase);
+    std::printf("first batch   %10.3f ms\n", first > startNs ? (first - startNs) / 1e6 : 0.0);
+    std::printf("last batch    %10.3f ms\n", last > startNs ? (last - startNs) / 1e6 : 0.0);
+    std::printf("batches       %10llu\n", static_cast<unsigned long long>(stats.uiBatches.load()));
+    std::printf("ops           %10llu\n", static_cast<unsigned long long>(stats.uiOps.load()));
+    std::printf("bytes         %10llu\n", static_cast<unsigned long long>(stats.uiBytes.load()));
+    std::printf("http calls    %10llu\n", static_cast<unsigned long long>(stats.httpFinished.load()));
+    std::printf("http 304      %10llu\n", static_cast<unsigned long long>(stats.httpNotModified.load()));
+    std::printf("allocations   %10llu (%llu bytes)\n",
+                static_cast<unsigned long long>(g_allocations.load() - allocationsBefore),
+                static_cast<unsigned long long>(g_allocated_bytes.load() - bytesBefore));
+    for (size_t op = 0; op < static_cast<size_t>(UiOp::Count); op++) {
+        uint64_t count = stats.opCounts[op].load();
+        if (count) std::printf("  op %-3zu     %10llu\n", op, static_cast<unsigned long long>(count));
+    }
+}
+
+static void reset_stats() {
+    FakeActivityStats& stats = fake_activity_stats();
+    stats.uiBatches = 0;
+    stats.uiOps = 0;
+    stats.uiBytes = 0;
+    for (auto& count : stats.opCounts) count = 0;
+    stats.firstBatchNs = 0;
+    stats.lastBatchNs = 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s bundle.dbc [--http-body file] [--click-all] [--idle-ms N]\n", argv[0]);
+        return 2;
+    }
+
+    std::string bundle = argv[1];
+    bool clickAll = false;
+    int idleMs = 200;
+
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--http-body") == 0 && i + 1 < argc) {
+            std::ifstream in(argv[++i], std::ios::binary);
+            std::stringstream body;
+            body << in.rdbuf();
+            fake_activity_set_http_body(body.str());
+        } else if (std::strcmp(argv[i], "--click-all") == 0) {
+            clickAll = true;
+        } else if (std::strcmp(argv[i], "--idle-ms") == 0 && i + 1 < argc) {
+            idleMs = std::atoi(argv[++i]);
+        }
+    }
+
+    JNIEnv* env = fake_jni_env();
+    Java_com_mist_example_MainActivity_registerVM(env, fake_activity());
+
+    uint64_t allocations = g_allocations.load();
+    uint64_t bytes = g_allocated_bytes.load();
+    uint64_t start = fake_now_ns();
+
+    DropletVMWrapper::getInstance()->runBytecode(bundle);
+    wait_for_idle(idleMs);
+    print_report("run", start, allocations, bytes);
+
+    if (clickAll) {
+        std::vector<int> buttons;
+        {
+            std::lock_guard<std::mutex> lock(fake_activity_stats().buttonsMutex);
+            buttons = fake_activity_stats().buttonCallbacks;
+        }
+
+        reset_stats();
+        allocations = g_allocations.load();
+        bytes = g_allocated_bytes.load();
+        start = fake_now_ns();
+
+        for (int callbackId : buttons) Java_com_mist_example_MainActivity_onButtonClick(env, fake_activity(), callbackId);
+        wait_for_idle(idleMs);
+        print_report("clicks", start, allocations, bytes);
+    }
+
+    DropletVMWrapper::destroyInstance();
+    return 0;
+}
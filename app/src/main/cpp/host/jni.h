@@ -0,0 +1,70 @@
+#ifndef MIST_HOST_JNI_H
+#define MIST_HOST_JNI_H
+
+// Host stand-in for <jni.h>: only the part of the JNI surface the bridge uses,
+// with the NDK's C++ signatures. The functions are implemented by the recording
+// MainActivity in FakeActivity.cpp; nothing here talks to a real JVM.
+
+#include <cstdint>
+
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef jint jsize;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+#define JNI_OK 0
+#define JNI_EDETACHED (-2)
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+struct _jobject {
+    bool local = false;  // freed by DeleteLocalRef
+    virtual ~_jobject() = default;
+};
+typedef _jobject* jobject;
+typedef jobject jclass;
+typedef jobject jstring;
+
+struct _jmethodID;
+typedef _jmethodID* jmethodID;
+
+struct _JNIEnv;
+struct _JavaVM;
+typedef _JNIEnv JNIEnv;
+typedef _JavaVM JavaVM;
+
+struct _JavaVM {
+    jint GetEnv(void** env, jint version);
+    jint AttachCurrentThread(JNIEnv** env, void* args);
+    jint DetachCurrentThread();
+};
+
+struct _JNIEnv {
+    jint GetJavaVM(JavaVM** vm);
+
+    jobject NewGlobalRef(jobject obj);
+    void DeleteGlobalRef(jobject obj);
+    void DeleteLocalRef(jobject obj);
+
+    jclass GetObjectClass(jobject obj);
+    jmethodID GetMethodID(jclass cls, const char* name, const char* sig);
+    void ExceptionClear();
+
+    jstring NewStringUTF(const char* utf);
+    const char* GetStringUTFChars(jstring str, jboolean* isCopy);
+    void ReleaseStringUTFChars(jstring str, const char* utf);
+
+    void CallVoidMethod(jobject obj, jmethodID method, ...);
+    jobject CallObjectMethod(jobject obj, jmethodID method, ...);
+    jint CallIntMethod(jobject obj, jmethodID method, ...);
+
+    jobject NewDirectByteBuffer(void* address, jlong capacity);
+    void* GetDirectBufferAddress(jobject buf);
+};
+
+#endif //MIST_HOST_JNI_H
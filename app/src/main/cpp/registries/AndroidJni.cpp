@@ -0,0 +1,64 @@
+#include "AndroidJni.h"
+
+#if defined(__ANDROID__) || defined(DROPLET_HOST_BRIDGE)
+
+#include <android/log.h>
+#include <pthread.h>
+
+#define LOG_TAG "DropletVM"
+
+extern "C" {
+JavaVM* droplet_java_vm = nullptr;
+jobject droplet_activity = nullptr;
+}
+
+jclass droplet_activity_class = nullptr;
+ActivityMethods g_activity;
+
+bool android_jni_bind(JNIEnv* env, jobject activity) {
+    env->GetJavaVM(&droplet_java_vm);
+
+    if (droplet_activity) env->DeleteGlobalRef(droplet_activity);
+    if (droplet_activity_class) env->DeleteGlobalRef(droplet_activity_class);
+
+    droplet_activity = env->NewGlobalRef(activity);
+
+    jclass cls = env->GetObjectClass(activity);
+    droplet_activity_class = static_cast<jclass>(env->NewGlobalRef(cls));
+    env->DeleteLocalRef(cls);
+
+    bool ok = true;
+#define MIST_BIND_METHOD(name, sig) \
+    g_activity.name = env->GetMethodID(droplet_activity_class, #name, sig); \
+    if (!g_activity.name) { \
+        env->ExceptionClear(); \
+        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Missing MainActivity.%s%s", #name, sig); \
+        ok = false; \
+    }
+    MIST_ACTIVITY_METHODS(MIST_BIND_METHOD)
+#undef MIST_BIND_METHOD
+
+    return ok;
+}
+
+// Native threads we attached (the VM thread) must detach before they exit
+static pthread_key_t s_detach_key;
+static pthread_once_t s_detach_once = PTHREAD_ONCE_INIT;
+
+static void detach_current_thread(void*) {
+    if (droplet_java_vm) droplet_java_vm->DetachCurrentThread();
+}
+
+JNIEnv* android_jni_env() {
+    static thread_local JNIEnv* t_env = nullptr;
+    if (!t_env) {
+        if (droplet_java_vm->GetEnv(reinterpret_cast<void**>(&t_env), JNI_VERSION_1_6) != JNI_OK) {
+            droplet_java_vm->AttachCurrentThread(&t_env, nullptr);
+            pthread_once(&s_detach_once, [] { pthread_key_create(&s_detach_key, detach_current_thread); });
+            pthread_setspecific(s_detach_key, t_env);
+        }
+    }
+    return t_env;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MIST_ANDROIDJNI_H
+#define MIST_ANDROIDJNI_H
+
+#if defined(__ANDROID__) || defined(DROPLET_HOST_BRIDGE)
+#include <jni.h>
+
+// Every MainActivity method the natives call: name and JNI signature.
+// Resolved once in android_jni_bind() so the natives only do the Call*Method.
+#define MIST_ACTIVITY_METHODS(X) \
+    X(applyUiCommands,        "(Ljava/nio/ByteBuffer;)V") \
+    X(getEditTextValue,       "(I)Ljava/lang/String;") \
+    X(httpExecute,            "(ILjava/lang/String;Ljava/lang/String;Ljava/lang/String;Ljava/lang/String;)I") \
+    X(httpAbort,              "(I)V")
+
+struct ActivityMethods {
+#define MIST_DECLARE_METHOD(name, sig) jmethodID name = nullptr;
+    MIST_ACTIVITY_METHODS(MIST_DECLARE_METHOD)
+#undef MIST_DECLARE_METHOD
+};
+
+extern "C" {
+extern JavaVM* droplet_java_vm;
+extern jobject droplet_activity;
+}
+
+// Global ref to the activity class and its method IDs, valid after android_jni_bind()
+extern jclass droplet_activity_class;
+extern ActivityMethods g_activity;
+
+// Resolve the activity class and every method ID. Called once from registerVM.
+bool android_jni_bind(JNIEnv* env, jobject activity);
+
+// JNIEnv for the calling thread, attached on first use and cached per thread.
+// Threads attached here are detached automatically when they exit.
+JNIEnv* android_jni_env();
+
+#endif
+
+#endif //MIST_ANDROIDJNI_H
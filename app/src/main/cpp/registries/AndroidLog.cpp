@@ -0,0 +1,84 @@
+#include "AndroidLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define LOG_TAG "DropletTrace"
+
+namespace {
+
+struct TraceEvent {
+    uint64_t timeNs;
+    const char* name;
+    int32_t a, b, c;
+};
+
+// Single writer (the owning thread), any number of readers. Readers copy the
+// slots and then re-read head: anything the writer lapped meanwhile is dropped.
+struct TraceRing {
+    static constexpr uint64_t kCapacity = 1024;  // power of two
+    static constexpr uint64_t kMask = kCapacity - 1;
+
+    int threadIndex = 0;
+    std::atomic<uint64_t> head{0};
+    TraceEvent events[kCapacity];
+};
+
+std::mutex g_rings_mutex;
+// Rings outlive their threads so events of exited workers can still be dumped
+std::vector<std::unique_ptr<TraceRing>> g_rings;
+
+thread_local TraceRing* t_ring = nullptr;
+
+TraceRing* thread_ring() {
+    if (!t_ring) {
+        auto ring = std::make_unique<TraceRing>();
+        std::lock_guard<std::mutex> lock(g_rings_mutex);
+        ring->threadIndex = static_cast<int>(g_rings.size());
+        t_ring = ring.get();
+        g_rings.push_back(std::move(ring));
+    }
+    return t_ring;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace
+
+void droplet_trace_event(const char* name, int32_t a, int32_t b, int32_t c) {
+    TraceRing* ring = thread_ring();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head & TraceRing::kMask] = {now_ns(), name, a, b, c};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void droplet_trace_dump() {
+    std::lock_guard<std::mutex> lock(g_rings_mutex);
+    std::vector<TraceEvent> copy;
+
+    for (auto& ring : g_rings) {
+        uint64_t end = ring->head.load(std::memory_order_acquire);
+        uint64_t begin = end > TraceRing::kCapacity ? end - TraceRing::kCapacity : 0;
+
+        copy.clear();
+        for (uint64_t i = begin; i < end; i++) copy.push_back(ring->events[i & TraceRing::kMask]);
+
+        // Slots up to the new head - capacity may have been overwritten while copying:
+        // that one too, since the writer fills it before publishing head + 1
+        uint64_t after = ring->head.load(std::memory_order_acquire);
+        uint64_t valid = after + 1 > TraceRing::kCapacity ? after + 1 - TraceRing::kCapacity : 0;
+        size_t skip = valid > begin ? static_cast<size_t>(valid - begin) : 0;
+
+        for (size_t i = skip; i < copy.size(); i++) {
+            const TraceEvent& e = copy[i];
+            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "[t%d] %llu %s %d %d %d", ring->threadIndex,
+                                static_cast<unsigned long long>(e.timeNs), e.name, e.a, e.b, e.c);
+        }
+    }
+}
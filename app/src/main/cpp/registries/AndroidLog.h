@@ -0,0 +1,54 @@
+#ifndef MIST_ANDROIDLOG_H
+#define MIST_ANDROIDLOG_H
+
+#include <android/log.h>
+#include <cstdint>
+
+// Compile-time filtered logging for the bridge. Calls below DROPLET_LOG_LEVEL
+// compile to nothing, arguments included, so a disabled log that formats
+// title.toString() costs nothing at runtime. Uses the including file's LOG_TAG.
+#ifndef DROPLET_LOG_LEVEL
+#ifdef NDEBUG
+#define DROPLET_LOG_LEVEL ANDROID_LOG_WARN
+#else
+#define DROPLET_LOG_LEVEL ANDROID_LOG_INFO
+#endif
+#endif
+
+#define DROPLET_LOG(level, ...)                                       \
+    do {                                                              \
+        if constexpr ((level) >= DROPLET_LOG_LEVEL) {                 \
+            __android_log_print((level), LOG_TAG, __VA_ARGS__);       \
+        }                                                             \
+    } while (0)
+
+#define DROPLET_LOGD(...) DROPLET_LOG(ANDROID_LOG_DEBUG, __VA_ARGS__)
+#define DROPLET_LOGI(...) DROPLET_LOG(ANDROID_LOG_INFO, __VA_ARGS__)
+#define DROPLET_LOGW(...) DROPLET_LOG(ANDROID_LOG_WARN, __VA_ARGS__)
+#define DROPLET_LOGE(...) DROPLET_LOG(ANDROID_LOG_ERROR, __VA_ARGS__)
+
+// Binary trace events for hot paths: a static name and up to three ints are
+// written to the calling thread's ring buffer, with no formatting and no lock.
+// droplet_trace_dump() formats what the rings still hold, off the hot path.
+#ifndef DROPLET_TRACE_ENABLED
+#ifdef NDEBUG
+#define DROPLET_TRACE_ENABLED 0
+#else
+#define DROPLET_TRACE_ENABLED 1
+#endif
+#endif
+
+// `name` must be a string literal (only the pointer is stored)
+void droplet_trace_event(const char* name, int32_t a = 0, int32_t b = 0, int32_t c = 0);
+
+// Writes every thread's buffered events to logcat, oldest first per thread
+void droplet_trace_dump();
+
+#define DROPLET_TRACE(...)                                            \
+    do {                                                              \
+        if constexpr (DROPLET_TRACE_ENABLED) {                        \
+            droplet_trace_event(__VA_ARGS__);                         \
+        }                                                             \
+    } while (0)
+
+#endif //MIST_ANDROIDLOG_H
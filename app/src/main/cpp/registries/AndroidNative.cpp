@@ -1,83 +1,163 @@
 #include "AndroidNative.h"
 
-#if defined(__ANDROID__)
+#if defined(__ANDROID__) || defined(DROPLET_HOST_BRIDGE)
 
 #include <android/log.h>
 #include <jni.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include "../droplet/src/vm/VM.h"
+#include "AndroidJni.h"
+#include "AndroidLog.h"
+#include "CallbackRegistry.h"
+#include "HttpCache.h"
+#include "HttpClient.h"
+#include "JsonArrayStream.h"
+#include "JsonDocument.h"
+#include "JsonNative.h"
+#include "RecyclerStore.h"
+#include "SpanTrace.h"
+#include "StyleSheet.h"
+#include "UiCommandBuffer.h"
+#include "ViewTree.h"
 
 #define LOG_TAG "DropletVM"
 
-extern "C" {
-JavaVM* droplet_java_vm = nullptr;
-jobject droplet_activity = nullptr;
 static int g_next_view_id = 1000; // start from 1000 to avoid collision
 
+// View ops recorded during the current VM turn, see android_flush_ui_commands()
+static UiCommandBuffer g_ui_commands;
+
+// Rows of every RecyclerView; the adapters read them through recyclerRow
+static RecyclerStore g_recycler_rows;
+
+extern "C"
 JNIEXPORT void JNICALL
 Java_com_mist_example_MainActivity_registerVM(JNIEnv* env, jobject thiz) {
-    env->GetJavaVM(&droplet_java_vm);
-    droplet_activity = env->NewGlobalRef(thiz);
-}
+    if (!android_jni_bind(env, thiz)) {
+        DROPLET_LOGE("Failed to bind MainActivity methods");
+    }
 }
 
-// Global VM reference and callback storage
+// Global VM reference and callback storage, only touched on the VM thread
 static VM* g_vm_instance = nullptr;
 
+// Where JNI entry points post events; set while the VM thread is running
+static std::atomic<VmEventLoop*> g_event_loop{nullptr};
+
 void push_int_to_vm_stack(VM& vm, int n) {
     // Replace with your actual Value creation for integers
     vm.stack_manager.push(Value::createINT(n));
 }
 
-struct CallbackInfo {
-    Value callback;  // Store the actual callback object (ObjBoundMethod or ObjFunction)
-    Object* gcRoot;     // Keep a direct pointer to prevent GC
-    int userData; // ADD THIS - stores the index or any custom int
-};
+// Live Droplet callbacks; Java only ever sees their generation-tagged handles
+static CallbackRegistry g_callbacks;
+
+// Screen each view lives on, so clearing a screen can release its button callbacks.
+// Mirrors MainActivity's navigation: parentId -1 means the current screen.
+static std::unordered_map<int, int> g_view_screen;
+static std::vector<int> g_screen_stack;
+static int g_current_screen = -1;
+
+static int screen_of(int parentId) {
+    if (parentId != -1) {
+        auto it = g_view_screen.find(parentId);
+        if (it != g_view_screen.end()) return it->second;
+    }
+    return g_current_screen;
+}
+
+static void track_view(int viewId, int parentId) {
+    g_view_screen[viewId] = screen_of(parentId);
+}
+
+// Retained view hierarchy, lets android_begin_rebuild reuse the views a screen already has
+static ViewTree g_view_tree;
+
+// Styles this VM has defined; each was sent to MainActivity once, as DefineStyle
+static StyleSheet g_styles;
 
-static std::unordered_map<int, CallbackInfo> g_callbacks;
-static int g_next_callback_id = 1;
+// Id for a view being created. During a rebuild this is the retained view in the
+// same slot if it matches; `created` tells the caller to send the create op.
+static int place_view(UiOp kind, int parentId, ViewTree::Shape shape, bool& created) {
+    int parent = parentId != -1 ? parentId : g_current_screen;
+    int viewId = g_view_tree.reuse(parent, kind, shape);
+    created = viewId == -1;
+    if (created) {
+        viewId = g_next_view_id++;
+        g_view_tree.insert(viewId, parent, kind, shape);
+        track_view(viewId, parentId);
+    }
+    return viewId;
+}
+
+// Property setters: skipped when a rebuild re-applies the value the view already has
+static void emit_view_prop(UiOp op, std::initializer_list<int32_t> args) {
+    if (g_view_tree.update(op, args)) g_ui_commands.emit(op, args);
+}
 
-// Global list of GC roots for callbacks
-static std::vector<Object*> g_callback_gc_roots;
+static void emit_view_text(UiOp op, int viewId, const std::string& text) {
+    if (g_view_tree.update(op, {viewId}, text)) g_ui_commands.emit(op, {viewId, g_ui_commands.intern(text)});
+}
 
 void android_set_vm_instance(VM* vm) {
     g_vm_instance = vm;
 }
 
-void android_native_toast(VM& vm, const uint8_t argc) {
-    if (argc == 0) {
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
+void android_reset_vm_state() {
+    g_callbacks.clear();
 
-    Value msg = vm.stack_manager.pop();
-    for (int i = 1; i < argc; i++) {
-        vm.stack_manager.pop();
-    }
+    // The next VM builds its screens from scratch; view ids keep counting up
+    for (const auto& view : g_view_screen) g_recycler_rows.erase(view.first);
+    g_view_screen.clear();
+    g_screen_stack.clear();
+    g_current_screen = -1;
+    g_view_tree = ViewTree();
 
-    std::string str = msg.toString();
+    // So the next VM's styles are defined (sent) again before ApplyStyle uses them
+    g_styles.clear();
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+std::span<const CallbackEntry> android_callback_roots() {
+    return g_callbacks.roots();
+}
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "showToast", "(Ljava/lang/String;)V");
+void android_set_event_loop(VmEventLoop* loop) {
+    g_event_loop.store(loop, std::memory_order_release);
+}
 
-    jstring jmsg = env->NewStringUTF(str.c_str());
-    env->CallVoidMethod(droplet_activity, method, jmsg);
-    env->DeleteLocalRef(jmsg);
+void android_flush_ui_commands() {
+    g_recycler_rows.flush_notifications(g_ui_commands);
+    if (g_ui_commands.empty()) return;
 
-    vm.stack_manager.push(Value::createNIL());
+    DROPLET_SPAN("jni:applyUiCommands");
+    JNIEnv* env = android_jni_env();
+    jobject buffer = env->NewDirectByteBuffer(const_cast<uint8_t*>(g_ui_commands.data()),
+                                              static_cast<jlong>(g_ui_commands.size()));
+    env->CallVoidMethod(droplet_activity, g_activity.applyUiCommands, buffer);
+    env->DeleteLocalRef(buffer);
+
+    g_ui_commands.clear();
+}
+
+void android_native_toast(const std::string& msg) {
+    g_ui_commands.emit(UiOp::ShowToast, {g_ui_commands.intern(msg)});
 }
 
 // Replace your existing android_create_button and onButtonClick functions with these:
 
 void android_create_button(VM& vm, const uint8_t argc) {
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "create_button called with argc: %d", argc);
-
+    DROPLET_SPAN("android_create_button");
     if(argc < 2) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "create_button requires at least 2 args (got %d)", argc);
+        DROPLET_LOGE("create_button requires at least 2 args (got %d)", argc);
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
@@ -88,7 +168,6 @@ void android_create_button(VM& vm, const uint8_t argc) {
     if (argc >= 4) {
         Value userDataVal = vm.stack_manager.pop();
         userData = (userDataVal.type == ValueType::INT) ? userDataVal.current_value.i : -1;
-        __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Button userData: %d", userData);
     }
 
     int parentId = -1;
@@ -105,131 +184,108 @@ void android_create_button(VM& vm, const uint8_t argc) {
         vm.stack_manager.pop();
     }
 
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Button: %s, Callback type: %d, ParentId: %d, UserData: %d",
-                        title.toString().c_str(), static_cast<int>(callback.type), parentId, userData);
+    CallbackHandle callbackId = g_callbacks.insert(callback, userData, screen_of(parentId), false);
+    if (callbackId == kInvalidCallback) {
+        DROPLET_LOGE("Callback registry full");
+        vm.stack_manager.push(Value::createNIL());
+        return;
+    }
 
-    // Store callback info WITH userData
-    int callbackId = g_next_callback_id++;
-    CallbackInfo info;
-    info.callback = callback;
-    info.userData = userData;  // STORE THE USER DATA
+    DROPLET_TRACE("create_button", callbackId, parentId, userData);
 
-    if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-        info.gcRoot = callback.current_value.object;
-        g_callback_gc_roots.push_back(callback.current_value.object);
-        __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Stored GC root at %p", callback.current_value.object);
+    bool created;
+    int viewId = place_view(UiOp::CreateButton, parentId, {}, created);
+    std::string text = title.toString();
+    if (created) {
+        g_view_tree.update(UiOp::SetViewText, {viewId}, text);
+        g_view_tree.update(UiOp::SetButtonCallback, {viewId, callbackId});
+        g_ui_commands.emit(UiOp::CreateButton, {g_ui_commands.intern(text), viewId, callbackId, parentId});
     } else {
-        info.gcRoot = nullptr;
-        __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "Warning: callback is not an object!");
+        // The rebuild registered a fresh callback; the reused button switches to it
+        g_callbacks.release(g_view_tree.prop(viewId, UiOp::SetButtonCallback));
+        emit_view_text(UiOp::SetViewText, viewId, text);
+        emit_view_prop(UiOp::SetButtonCallback, {viewId, callbackId});
     }
 
-    g_callbacks[callbackId] = info;
+    vm.stack_manager.push(Value::createNIL());
+}
 
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Created callback ID: %d with userData: %d", callbackId, userData);
+// Most arguments a bridge callback takes (HTTP completion: success, body, status)
+static constexpr size_t kMaxCallbackArgs = 3;
+
+// Argument buffer for every callback dispatch (VM thread only). Its capacity is
+// fixed at kMaxCallbackArgs up front, so filling it never allocates; it is a
+// vector only because VM::execute_callback takes one.
+static std::vector<Value>& callback_args() {
+    static std::vector<Value> args = [] {
+        std::vector<Value> buffer;
+        buffer.reserve(kMaxCallbackArgs);
+        return buffer;
+    }();
+    return args;
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+// Runs the callback with `args` and flushes the UI ops it recorded (unless the
+// caller flushes once for a run of callbacks). The entry may move if the callback
+// registers new callbacks, so it is copied first.
+static bool invoke_callback(const CallbackEntry& entry, std::initializer_list<Value> args, bool flush = true) {
+    if (entry.kind == CallbackKind::Other) {
+        DROPLET_LOGE("Callback is not a function or bound method");
+        return false;
+    }
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createButton", "(Ljava/lang/String;II)V");
+    if (args.size() > kMaxCallbackArgs) {
+        DROPLET_LOGE("Callback given %zu arguments, at most %zu fit", args.size(), kMaxCallbackArgs);
+        return false;
+    }
 
-    jstring jtitle = env->NewStringUTF(title.toString().c_str());
-    env->CallVoidMethod(droplet_activity, method, jtitle, callbackId, parentId);
-    env->DeleteLocalRef(jtitle);
+    Value callback = entry.callback;
+    std::vector<Value>& buffer = callback_args();
+    buffer.assign(args);
 
-    vm.stack_manager.push(Value::createNIL());
+    bool success = false;
+    try {
+        DROPLET_SPAN("VM::execute_callback");
+        success = g_vm_instance->execute_callback(callback, buffer);
+    } catch (const std::exception& e) {
+        DROPLET_LOGE("Exception in callback: %s", e.what());
+    }
+    if (flush) android_flush_ui_commands();
+    return success;
 }
 
-// Called from Java when button is clicked
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_mist_example_MainActivity_onButtonClick(JNIEnv* env, jobject thiz, jint callbackId) {
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Button clicked with callback ID: %d", callbackId);
-
+// Runs on the VM thread for a click posted by onButtonClick
+static void dispatch_button_click(int callbackId) {
     if (!g_vm_instance) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "VM instance not set");
+        DROPLET_LOGE("VM instance not set");
         return;
     }
 
     if (!g_vm_instance->is_ready()) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "VM is not ready");
+        DROPLET_LOGE("VM is not ready");
         return;
     }
 
-    auto it = g_callbacks.find(callbackId);
-    if (it == g_callbacks.end()) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Callback %d not found", callbackId);
+    CallbackEntry* info = g_callbacks.find(callbackId);
+    if (!info) {
+        DROPLET_LOGE("Callback %d not found", callbackId);
         return;
     }
 
-    CallbackInfo& info = it->second;
-    Value callback = info.callback;
-    int userData = info.userData;
+    DROPLET_TRACE("button_click", callbackId, info->functionIndex, info->userData);
 
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Found callback, type: %d, userData: %d",
-                        static_cast<int>(callback.type), userData);
+    bool success = (info->userData != -1)
+            ? invoke_callback(*info, {Value::createINT(info->userData)})
+            : invoke_callback(*info, {});
 
-    // Log what we're about to execute
-    if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-        auto* boundMethod = dynamic_cast<ObjBoundMethod*>(callback.current_value.object);
-        if (boundMethod) {
-            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Executing bound method, index: %d",
-                                boundMethod->methodIndex);
-        }
-
-        auto* fnObj = dynamic_cast<ObjFunction*>(callback.current_value.object);
-        if (fnObj) {
-            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Executing function, index: %d",
-                                fnObj->functionIndex);
-        }
-    }
-
-    try {
-        // Detailed inspection before execution
-        __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Callback value type: %d", static_cast<int>(callback.type));
-        __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Callback object ptr: %p", callback.current_value.object);
-
-        if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-            auto* boundMethod = dynamic_cast<ObjBoundMethod*>(callback.current_value.object);
-            if (boundMethod) {
-                __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "BoundMethod found! methodIndex=%d", boundMethod->methodIndex);
-                __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Functions size=%zu", g_vm_instance->functions.size());
-            } else {
-                __android_log_print(ANDROID_LOG_WARN, LOG_TAG, "Object is not a BoundMethod");
-
-                auto* fnObj = dynamic_cast<ObjFunction*>(callback.current_value.object);
-                if (fnObj) {
-                    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Function found! functionIndex=%d", fnObj->functionIndex);
-                } else {
-                    __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Object is neither BoundMethod nor Function!");
-                }
-            }
-        } else {
-            __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Callback is not an object or is null!");
-        }
-
-        // Create arguments vector with userData if it exists
-        std::vector<Value> args;
-        if (userData != -1) {
-            args.push_back(Value::createINT(userData));
-            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Passing userData %d to callback", userData);
-        }
-
-        bool success = g_vm_instance->execute_callback(callback, args);
-
-        if (success) {
-            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Callback executed successfully");
-        } else {
-            __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Callback execution failed");
-        }
-
-    } catch (const std::exception& e) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Exception in callback: %s", e.what());
+    if (!success) {
+        DROPLET_LOGE("Callback execution failed");
     }
 }
 
 
 void android_create_textview(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_textview");
     if (argc < 1) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
@@ -249,22 +305,21 @@ void android_create_textview(VM& vm, const uint8_t argc) {
     for (int i = 2; i < argc; i++) vm.stack_manager.pop();
 
     std::string text = textVal.toString();
-    int viewId = g_next_view_id++;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createTextView", "(Ljava/lang/String;II)V");
-    jstring jtext = env->NewStringUTF(text.c_str());
-    env->CallVoidMethod(droplet_activity, method, jtext, viewId, parentId);
-    env->DeleteLocalRef(jtext);
+    bool created;
+    int viewId = place_view(UiOp::CreateTextView, parentId, {}, created);
+    if (created) {
+        g_view_tree.update(UiOp::SetViewText, {viewId}, text);
+        g_ui_commands.emit(UiOp::CreateTextView, {g_ui_commands.intern(text), viewId, parentId});
+    } else {
+        emit_view_text(UiOp::SetViewText, viewId, text);
+    }
 
     push_int_to_vm_stack(vm, viewId);
 }
 
 
 void android_create_imageview(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_imageview");
     std::string path = "";
     int parentId = -1, width = -1, height = -1;
 
@@ -288,23 +343,21 @@ void android_create_imageview(VM& vm, const uint8_t argc) {
 
     for (int i = 4; i < argc; i++) vm.stack_manager.pop();
 
-    int viewId = g_next_view_id++;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createImageView", "(Ljava/lang/String;IIII)V");
-
-    jstring jpath = env->NewStringUTF(path.c_str());
-    env->CallVoidMethod(droplet_activity, method, jpath, viewId, parentId, width, height);
-    env->DeleteLocalRef(jpath);
+    bool created;
+    int viewId = place_view(UiOp::CreateImageView, parentId, {width, height}, created);
+    if (created) {
+        g_view_tree.update(UiOp::SetViewImage, {viewId}, path);
+        g_ui_commands.emit(UiOp::CreateImageView, {g_ui_commands.intern(path), viewId, parentId, width, height});
+    } else {
+        emit_view_text(UiOp::SetViewImage, viewId, path);
+    }
 
     push_int_to_vm_stack(vm, viewId);
 }
 
 
 void android_create_linearlayout(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_linearlayout");
     // args: orientation (0=vertical, 1=horizontal), parentId_opt
     int orientation = 0;
     int parentId = -1;
@@ -318,104 +371,31 @@ void android_create_linearlayout(VM& vm, const uint8_t argc) {
     }
     for (int i = 2; i < argc; i++) vm.stack_manager.pop();
 
-    int viewId = g_next_view_id++;
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createLinearLayout", "(III)V"); // path, id, parent
-    env->CallVoidMethod(droplet_activity, method, orientation, viewId, parentId);
+    bool created;
+    int viewId = place_view(UiOp::CreateLinearLayout, parentId, {orientation, 0}, created);
+    if (created) g_ui_commands.emit(UiOp::CreateLinearLayout, {orientation, viewId, parentId});
 
     push_int_to_vm_stack(vm, viewId);
 }
 
 // Add child to parent (native wrapper, but Java can also accept parent at creation)
-void android_add_view_to_parent(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value child = vm.stack_manager.pop();
-    Value parent = vm.stack_manager.pop();
-    int childId = (child.type == ValueType::INT) ? child.current_value.i : -1;
-    int parentId = (parent.type == ValueType::INT) ? parent.current_value.i : -1;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "addViewToParent", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, parentId, childId);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_add_view_to_parent(int parentId, int childId) {
+    if (g_view_tree.move(childId, parentId)) g_ui_commands.emit(UiOp::AddViewToParent, {parentId, childId});
 }
 
 // set text
-void android_set_view_text(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-    Value textVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    std::string text = textVal.toString();
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewText", "(ILjava/lang/String;)V");
-    jstring jtext = env->NewStringUTF(text.c_str());
-    env->CallVoidMethod(droplet_activity, method, viewId, jtext);
-    env->DeleteLocalRef(jtext);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_text(int viewId, const std::string& text) {
+    emit_view_text(UiOp::SetViewText, viewId, text);
 }
 
 // set image
-void android_set_view_image(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-    Value pathVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    std::string path = pathVal.toString();
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewImage", "(ILjava/lang/String;)V");
-    jstring jpath = env->NewStringUTF(path.c_str());
-    env->CallVoidMethod(droplet_activity, method, viewId, jpath);
-    env->DeleteLocalRef(jpath);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_image(int viewId, const std::string& path) {
+    emit_view_text(UiOp::SetViewImage, viewId, path);
 }
 
 // set visibility: 0=VISIBLE, 1=INVISIBLE, 2=GONE
-void android_set_view_visibility(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-    Value visVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int vis = (visVal.type == ValueType::INT) ? visVal.current_value.i : 0;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewVisibility", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, vis);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_visibility(int viewId, int visibility) {
+    emit_view_prop(UiOp::SetViewVisibility, {viewId, visibility});
 }
 
 void android_set_view_property(VM& vm, const uint8_t argc) {
@@ -426,6 +406,7 @@ void android_set_view_property(VM& vm, const uint8_t argc) {
 
 // Create ScrollView
 void android_create_scrollview(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_scrollview");
     int parentId = -1;
     if (argc >= 1) {
         Value p = vm.stack_manager.pop();
@@ -433,19 +414,16 @@ void android_create_scrollview(VM& vm, const uint8_t argc) {
     }
     for (int i = 1; i < argc; i++) vm.stack_manager.pop();
 
-    int viewId = g_next_view_id++;
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createScrollView", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, parentId);
+    bool created;
+    int viewId = place_view(UiOp::CreateScrollView, parentId, {}, created);
+    if (created) g_ui_commands.emit(UiOp::CreateScrollView, {viewId, parentId});
 
     push_int_to_vm_stack(vm, viewId);
 }
 
 // Create CardView
 void android_create_cardview(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_cardview");
     int parentId = -1;
     int elevation = 8; // default elevation in dp
     int cornerRadius = 8; // default corner radius in dp
@@ -464,19 +442,16 @@ void android_create_cardview(VM& vm, const uint8_t argc) {
     }
     for (int i = 3; i < argc; i++) vm.stack_manager.pop();
 
-    int viewId = g_next_view_id++;
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createCardView", "(IIII)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, parentId, elevation, cornerRadius);
+    bool created;
+    int viewId = place_view(UiOp::CreateCardView, parentId, {elevation, cornerRadius}, created);
+    if (created) g_ui_commands.emit(UiOp::CreateCardView, {viewId, parentId, elevation, cornerRadius});
 
     push_int_to_vm_stack(vm, viewId);
 }
 
 // Create RecyclerView
 void android_create_recyclerview(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_recyclerview");
     int parentId = -1;
     int layoutType = 0; // 0=vertical, 1=horizontal, 2=grid
 
@@ -490,250 +465,115 @@ void android_create_recyclerview(VM& vm, const uint8_t argc) {
     }
     for (int i = 2; i < argc; i++) vm.stack_manager.pop();
 
-    int viewId = g_next_view_id++;
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createRecyclerView", "(III)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, parentId, layoutType);
+    bool created;
+    int viewId = place_view(UiOp::CreateRecyclerView, parentId, {layoutType, 0}, created);
+    if (created) g_ui_commands.emit(UiOp::CreateRecyclerView, {viewId, parentId, layoutType});
 
     push_int_to_vm_stack(vm, viewId);
 }
 
 // Add item to RecyclerView
-void android_recyclerview_add_item(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
+void android_recyclerview_add_item(int viewId, const std::string& text) {
+    DROPLET_LOGD("Adding item to RecyclerView %d: %s", viewId, text.c_str());
 
-    Value textVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    std::string text = textVal.toString();
+    g_recycler_rows.append(viewId, text);
+}
 
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "Adding item to RecyclerView %d: %s", viewId, text.c_str());
+// Clear RecyclerView items
+void android_recyclerview_clear(int viewId) {
+    g_recycler_rows.clear(viewId);
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "recyclerViewAddItem", "(ILjava/lang/String;)V");
-    jstring jtext = env->NewStringUTF(text.c_str());
-    env->CallVoidMethod(droplet_activity, method, viewId, jtext);
-    env->DeleteLocalRef(jtext);
+// Replace the rows with one per element of the array at `arrayPath` in a json_parse
+// document: the element's `field`, or the element itself when field is "".
+// Only rows that actually changed are re-bound. Returns the row count.
+int android_recyclerview_set_items_json(int viewId, int doc, const std::string& arrayPath, const std::string& field) {
+    const JsonDocument* document = json_document(doc);
+    if (!document) return 0;
 
-    vm.stack_manager.push(Value::createNIL());
-}
+    uint32_t array = document->find(arrayPath);
+    uint32_t count = document->size(array);
 
-// Clear RecyclerView items
-void android_recyclerview_clear(VM& vm, const uint8_t argc) {
-    if (argc < 1) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
+    std::vector<std::string> rows;
+    rows.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t element = document->at(array, i);
+        uint32_t node = field.empty() ? element : document->field(element, field);
+        rows.push_back(node == JsonDocument::npos ? "" : document->value(node));
     }
 
-    Value idVal = vm.stack_manager.pop();
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
+    g_recycler_rows.replace(viewId, rows);
+    return static_cast<int>(rows.size());
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "recyclerViewClear", "(I)V");
-    env->CallVoidMethod(droplet_activity, method, viewId);
+// Called from Java (UI thread) when the adapter binds a row
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_mist_example_MainActivity_recyclerRow(JNIEnv* env, jobject thiz, jint viewId, jint position) {
+    return env->NewStringUTF(g_recycler_rows.row(viewId, position).c_str());
+}
 
-    vm.stack_manager.push(Value::createNIL());
+// Called from Java (UI thread) for RecyclerViewCommit, before the ranges it precedes
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_mist_example_MainActivity_adoptRecyclerRows(JNIEnv* env, jobject thiz, jint viewId, jint version) {
+    g_recycler_rows.adopt(viewId, version);
 }
 
 // Set view background color
-void android_set_view_background_color(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value colorVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int color = (colorVal.type == ValueType::INT) ? colorVal.current_value.i : 0xFFFFFFFF;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewBackgroundColor", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, color);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_background_color(int viewId, int color) {
+    emit_view_prop(UiOp::SetViewBackgroundColor, {viewId, color});
 }
 
 // Set view padding
-void android_set_view_padding(VM& vm, const uint8_t argc) {
-    if (argc < 5) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value bottom = vm.stack_manager.pop();
-    Value right = vm.stack_manager.pop();
-    Value top = vm.stack_manager.pop();
-    Value left = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int l = (left.type == ValueType::INT) ? left.current_value.i : 0;
-    int t = (top.type == ValueType::INT) ? top.current_value.i : 0;
-    int r = (right.type == ValueType::INT) ? right.current_value.i : 0;
-    int b = (bottom.type == ValueType::INT) ? bottom.current_value.i : 0;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewPadding", "(IIIII)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, l, t, r, b);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_padding(int viewId, int left, int top, int right, int bottom) {
+    emit_view_prop(UiOp::SetViewPadding, {viewId, left, top, right, bottom});
 }
 
 // Set view size (width, height in dp)
-void android_set_view_size(VM& vm, const uint8_t argc) {
-    if (argc < 3) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value heightVal = vm.stack_manager.pop();
-    Value widthVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int width = (widthVal.type == ValueType::INT) ? widthVal.current_value.i : -1;
-    int height = (heightVal.type == ValueType::INT) ? heightVal.current_value.i : -1;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewSize", "(III)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, width, height);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_size(int viewId, int width, int height) {
+    emit_view_prop(UiOp::SetViewSize, {viewId, width, height});
 }
 
-void android_set_toolbar_title(VM& vm, const uint8_t argc) {
-    if (argc < 1) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value titleVal = vm.stack_manager.pop();
-    for (int i = 1; i < argc; i++) vm.stack_manager.pop();
-
-    std::string title = titleVal.toString();
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setToolbarTitle", "(Ljava/lang/String;)V");
-    jstring jtitle = env->NewStringUTF(title.c_str());
-    env->CallVoidMethod(droplet_activity, method, jtitle);
-    env->DeleteLocalRef(jtitle);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_toolbar_title(const std::string& title) {
+    g_ui_commands.emit(UiOp::SetToolbarTitle, {g_ui_commands.intern(title)});
 }
 
 // Create a new screen (returns screen ID)
-void android_create_screen(VM& vm, const uint8_t argc) {
-    if (argc < 1) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createINT(-1));
-        return;
-    }
-
-    Value nameVal = vm.stack_manager.pop();
-    for (int i = 1; i < argc; i++) vm.stack_manager.pop();
-
-    std::string name = nameVal.toString();
+int android_create_screen(const std::string& name) {
     int screenId = g_next_view_id++;
+    g_view_screen[screenId] = screenId;
+    g_view_tree.add_screen(screenId);
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createScreen", "(ILjava/lang/String;)V");
-    jstring jname = env->NewStringUTF(name.c_str());
-    env->CallVoidMethod(droplet_activity, method, screenId, jname);
-    env->DeleteLocalRef(jname);
-
-    push_int_to_vm_stack(vm, screenId);
+    g_ui_commands.emit(UiOp::CreateScreen, {screenId, g_ui_commands.intern(name)});
+    return screenId;
 }
 
 // Navigate to a screen by ID
-void android_navigate_to_screen(VM& vm, const uint8_t argc) {
-    if (argc < 1) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
+void android_navigate_to_screen(int screenId) {
+    if (g_view_screen.count(screenId)) {
+        g_screen_stack.push_back(g_current_screen);
+        g_current_screen = screenId;
     }
-
-    Value screenIdVal = vm.stack_manager.pop();
-    for (int i = 1; i < argc; i++) vm.stack_manager.pop();
-
-    int screenId = (screenIdVal.type == ValueType::INT) ? screenIdVal.current_value.i : -1;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "navigateToScreen", "(I)V");
-    env->CallVoidMethod(droplet_activity, method, screenId);
-
-    vm.stack_manager.push(Value::createNIL());
+    g_ui_commands.emit(UiOp::NavigateToScreen, {screenId});
 }
 
 // Navigate back
-void android_navigate_back(VM& vm, const uint8_t argc) {
-    for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "navigateBack", "()V");
-    env->CallVoidMethod(droplet_activity, method);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_navigate_back() {
+    if (!g_screen_stack.empty()) {
+        g_current_screen = g_screen_stack.back();
+        g_screen_stack.pop_back();
+    }
+    g_ui_commands.emit(UiOp::NavigateBack, {});
 }
 
 // Set back button visibility
-void android_set_back_button_visible(VM& vm, const uint8_t argc) {
-    if (argc < 1) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value visibleVal = vm.stack_manager.pop();
-    for (int i = 1; i < argc; i++) vm.stack_manager.pop();
-
-    int visible = (visibleVal.type == ValueType::INT) ? visibleVal.current_value.i : 0;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setBackButtonVisible", "(Z)V");
-    env->CallVoidMethod(droplet_activity, method, visible != 0);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_back_button_visible(int visible) {
+    g_ui_commands.emit(UiOp::SetBackButtonVisible, {visible != 0});
 }
 
 void android_create_edittext(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_create_edittext");
     std::string hint = "";
     int parentId = -1;
 
@@ -747,39 +587,25 @@ void android_create_edittext(VM& vm, const uint8_t argc) {
     }
     for (int i = 2; i < argc; i++) vm.stack_manager.pop();
 
-    int viewId = g_next_view_id++;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "createEditText", "(Ljava/lang/String;II)V");
-    jstring jhint = env->NewStringUTF(hint.c_str());
-    env->CallVoidMethod(droplet_activity, method, jhint, viewId, parentId);
-    env->DeleteLocalRef(jhint);
+    bool created;
+    int viewId = place_view(UiOp::CreateEditText, parentId, {}, created);
+    if (created) {
+        g_view_tree.update(UiOp::SetEditTextHint, {viewId}, hint);
+        g_ui_commands.emit(UiOp::CreateEditText, {g_ui_commands.intern(hint), viewId, parentId});
+    } else {
+        emit_view_text(UiOp::SetEditTextHint, viewId, hint);
+    }
 
     push_int_to_vm_stack(vm, viewId);
 }
 
-void android_get_edittext_value(VM& vm, const uint8_t argc) {
-    if (argc < 1) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        ObjString* str = vm.allocator.allocate_string("");
-        vm.stack_manager.push(Value::createOBJECT(str));
-        return;
-    }
-
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 1; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
+std::string android_get_edittext_value(int viewId) {
+    // The EditText may only exist in the pending batch
+    android_flush_ui_commands();
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "getEditTextValue", "(I)Ljava/lang/String;");
-    jstring jresult = (jstring)env->CallObjectMethod(droplet_activity, method, viewId);
+    DROPLET_SPAN("jni:getEditTextValue");
+    JNIEnv* env = android_jni_env();
+    jstring jresult = (jstring)env->CallObjectMethod(droplet_activity, g_activity.getEditTextValue, viewId);
 
     std::string result = "";
     if (jresult != nullptr) {
@@ -788,278 +614,344 @@ void android_get_edittext_value(VM& vm, const uint8_t argc) {
         env->ReleaseStringUTFChars(jresult, str);
         env->DeleteLocalRef(jresult);
     }
-    ObjString* str = vm.allocator.allocate_string(result);
-    vm.stack_manager.push(Value::createOBJECT(str));
+    return result;
 }
 
-void android_set_edittext_hint(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value hintVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    std::string hint = hintVal.toString();
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setEditTextHint", "(ILjava/lang/String;)V");
-    jstring jhint = env->NewStringUTF(hint.c_str());
-    env->CallVoidMethod(droplet_activity, method, viewId, jhint);
-    env->DeleteLocalRef(jhint);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_edittext_hint(int viewId, const std::string& hint) {
+    emit_view_text(UiOp::SetEditTextHint, viewId, hint);
 }
 
-void android_set_edittext_input_type(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value typeVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int inputType = (typeVal.type == ValueType::INT) ? typeVal.current_value.i : 1;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setEditTextInputType", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, inputType);
-
-    vm.stack_manager.push(Value::createNIL());
+void android_set_edittext_input_type(int viewId, int inputType) {
+    emit_view_prop(UiOp::SetEditTextInputType, {viewId, inputType});
 }
 
 // ============================================
 // STYLING FUNCTIONS
 // ============================================
 
-void android_set_text_size(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
-
-    Value sizeVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int size = (sizeVal.type == ValueType::INT) ? sizeVal.current_value.i : 16;
+void android_set_text_size(int viewId, int size) {
+    emit_view_prop(UiOp::SetTextSize, {viewId, size});
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+void android_set_text_color(int viewId, int color) {
+    emit_view_prop(UiOp::SetTextColor, {viewId, color});
+}
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setTextSize", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, size);
+void android_set_text_style(int viewId, int style) {
+    emit_view_prop(UiOp::SetTextStyle, {viewId, style});
+}
 
-    vm.stack_manager.push(Value::createNIL());
+void android_set_view_margin(int viewId, int left, int top, int right, int bottom) {
+    emit_view_prop(UiOp::SetViewMargin, {viewId, left, top, right, bottom});
 }
 
-void android_set_text_color(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
+void android_set_view_gravity(int viewId, int gravity) {
+    emit_view_prop(UiOp::SetViewGravity, {viewId, gravity});
+}
 
-    Value colorVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
+void android_set_view_elevation(int viewId, int elevation) {
+    emit_view_prop(UiOp::SetViewElevation, {viewId, elevation});
+}
 
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int color = (colorVal.type == ValueType::INT) ? colorVal.current_value.i : 0xFF000000;
+void android_set_view_corner_radius(int viewId, int radius) {
+    emit_view_prop(UiOp::SetViewCornerRadius, {viewId, radius});
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+void android_set_view_border(int viewId, int width, int color) {
+    emit_view_prop(UiOp::SetViewBorder, {viewId, width, color});
+}
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setTextColor", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, color);
+int android_create_style(const std::string& declarations) {
+    bool created;
+    int styleId = g_styles.define(declarations, created);
+    if (styleId < 0) {
+        DROPLET_LOGW("Invalid style: %s", declarations.c_str());
+        return -1;
+    }
 
-    vm.stack_manager.push(Value::createNIL());
+    if (created) {
+        const Style& style = *g_styles.find(styleId);
+        int32_t args[2 + kStyleFieldCount] = {styleId, static_cast<int32_t>(style.mask)};
+        std::copy(style.values.begin(), style.values.end(), args + 2);
+        g_ui_commands.emit(UiOp::DefineStyle, args, std::size(args));
+    }
+    return styleId;
 }
 
-void android_set_text_style(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
+void android_apply_style(int viewId, int styleId) {
+    if (!g_styles.find(styleId)) {
+        DROPLET_LOGW("Unknown style %d", styleId);
         return;
     }
+    emit_view_prop(UiOp::ApplyStyle, {viewId, styleId});
+}
 
-    Value styleVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
+// ============================================
+// HTTP FUNCTIONS
+// ============================================
 
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int style = (styleVal.type == ValueType::INT) ? styleVal.current_value.i : 0;
+// Requests go through g_http (worker pool + per-host limits); the transport below
+// runs on its worker threads and performs the I/O through MainActivity.httpExecute.
+static std::unique_ptr<HttpClient> g_http;
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+// Item callback of each streaming request, keyed by its request handle (VM thread only)
+static std::unordered_map<CallbackHandle, CallbackHandle> g_http_streams;
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setTextStyle", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, style);
+// Batch still collecting queries, per endpoint URL, as its HttpCall::id. Added on
+// the VM thread; an entry goes when its batch completes (worker thread) or can no
+// longer be joined.
+static std::mutex g_http_batches_mutex;
+static std::unordered_map<std::string, HttpRequestId> g_http_batches;
 
-    vm.stack_manager.push(Value::createNIL());
+// Drops the batches that were started, cancelled by every waiter or completed
+static void prune_http_batches() {
+    std::lock_guard<std::mutex> lock(g_http_batches_mutex);
+    std::erase_if(g_http_batches, [](const auto& batch) { return !g_http || !g_http->queued(batch.second); });
 }
 
-void android_set_view_margin(VM& vm, const uint8_t argc) {
-    if (argc < 5) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
-    }
+// GET responses, opened with the first bundle run. Workers store into it, so it
+// lives until android_http_shutdown has joined them.
+static std::unique_ptr<HttpCache> g_http_cache;
+
+// Call the current worker thread is executing, target of onHttpChunk/onHttpHeaders/onHttpFailed
+static thread_local HttpCall* t_http_call = nullptr;
+
+static void android_http_transport(HttpCall& call) {
+    DROPLET_SPAN("jni:httpExecute");
+    JNIEnv* env = android_jni_env();
+    t_http_call = &call;
+
+    jstring jmethod = env->NewStringUTF(call.request.method.c_str());
+    jstring jurl = env->NewStringUTF(call.request.url.c_str());
+    jstring jbody = env->NewStringUTF(call.request.body.c_str());
+    jstring jheaders = env->NewStringUTF(call.request.headers.c_str());
+    call.statusCode = env->CallIntMethod(droplet_activity, g_activity.httpExecute,
+                                         call.id, jmethod, jurl, jbody, jheaders);
+    env->DeleteLocalRef(jmethod);
+    env->DeleteLocalRef(jurl);
+    env->DeleteLocalRef(jbody);
+    env->DeleteLocalRef(jheaders);
 
-    Value bottom = vm.stack_manager.pop();
-    Value right = vm.stack_manager.pop();
-    Value top = vm.stack_manager.pop();
-    Value left = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
+    t_http_call = nullptr;
+}
 
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int l = (left.type == ValueType::INT) ? left.current_value.i : 0;
-    int t = (top.type == ValueType::INT) ? top.current_value.i : 0;
-    int r = (right.type == ValueType::INT) ? right.current_value.i : 0;
-    int b = (bottom.type == ValueType::INT) ? bottom.current_value.i : 0;
+// Any thread: has the call's HttpURLConnection disconnected (on MainActivity's abort
+// thread, never the caller's) so the worker blocked in it returns
+static void android_http_abort(HttpCall& call) {
+    JNIEnv* env = android_jni_env();
+    env->CallVoidMethod(droplet_activity, g_activity.httpAbort, call.id);
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+static void post_http_response(int callbackId, int statusCode, std::string body,
+                               bool revalidating, bool unchanged) {
+    VmEventLoop* loop = g_event_loop.load(std::memory_order_acquire);
+    if (!loop) return;
+
+    VmEvent event;
+    event.kind = VmEvent::Kind::HttpResponse;
+    event.callbackId = callbackId;
+    event.statusCode = statusCode;
+    event.success = statusCode >= 200 && statusCode <= 299;
+    event.revalidating = revalidating;
+    event.unchanged = unchanged;
+    event.body = std::move(body);
+    loop->post(std::move(event));
+}
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewMargin", "(IIIII)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, l, t, r, b);
+// A batch's response is a JSON array with one result per query, in query order;
+// each waiter gets its own element
+static void complete_http_batch(HttpCall& call, const std::vector<HttpRequestId>& waiters) {
+    {
+        std::lock_guard<std::mutex> lock(g_http_batches_mutex);
+        auto open = g_http_batches.find(call.request.url);
+        if (open != g_http_batches.end() && open->second == call.id) g_http_batches.erase(open);
+    }
 
-    vm.stack_manager.push(Value::createNIL());
+    bool ok = call.statusCode >= 200 && call.statusCode <= 299;
+    JsonDocument results;
+    if (ok && (!results.parse(std::move(call.response)) ||
+               results.kind(results.root()) != JsonDocument::Kind::Array ||
+               results.size(results.root()) != waiters.size())) {
+        DROPLET_LOGW("Batch response for %s is not an array of %zu results", call.request.url.c_str(), waiters.size());
+        call.statusCode = 0;
+        call.response = "Error: malformed batch response";
+        ok = false;
+    }
+
+    for (size_t i = 0; i < waiters.size(); i++) {
+        if (waiters[i] == kCancelledWaiter) continue;
+        std::string body = ok ? results.value(results.at(results.root(), static_cast<uint32_t>(i))) : call.response;
+        post_http_response(waiters[i], call.statusCode, std::move(body), false, false);
+    }
 }
 
-void android_set_view_gravity(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
+// Worker thread: update the cache, then hand the finished call to the VM thread,
+// once per waiter of a coalesced call
+static void android_http_complete(HttpCall& call, const std::vector<HttpRequestId>& waiters) {
+    const HttpRequest& request = call.request;
+    if (request.batch) {
+        complete_http_batch(call, waiters);
         return;
     }
 
-    Value gravityVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
+    bool unchanged = false;
+    if (g_http_cache && request.method == "GET" && !request.stream) {
+        if (call.statusCode == 304 && request.revalidates) {
+            g_http_cache->refresh(request.url, request.headers, call.responseHeaders);
+            unchanged = true;
+        } else if (call.statusCode == 200) {
+            uint64_t hash = g_http_cache->store(request.url, request.headers, call.response,
+                                                call.responseHeaders);
+            unchanged = request.revalidates && hash == request.revalidates;
+        } else if (request.revalidates && (call.statusCode == 0 || call.statusCode >= 500)) {
+            // Offline or a server error: the cached body already shown stays
+            unchanged = true;
+        }
+    }
 
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int gravity = (gravityVal.type == ValueType::INT) ? gravityVal.current_value.i : 0;
+    auto last = std::find_if(waiters.rbegin(), waiters.rend(),
+                             [](HttpRequestId waiter) { return waiter != kCancelledWaiter; });
+    for (auto it = waiters.begin(); it != waiters.end(); ++it) {
+        if (*it == kCancelledWaiter) continue;
+        // Only the last one takes the body without a copy
+        std::string body = (it == last.base() - 1) ? std::move(call.response) : call.response;
+        post_http_response(*it, call.statusCode, std::move(body), false, unchanged);
+    }
+}
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+void android_http_start() {
+    if (!g_http) {
+        HttpClientConfig config;
+        config.abort = android_http_abort;
+        g_http = std::make_unique<HttpClient>(android_http_transport, android_http_complete, config);
+    }
+}
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewGravity", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, gravity);
+void android_http_shutdown() {
+    g_http.reset();
+    g_http_cache.reset();
+    std::lock_guard<std::mutex> lock(g_http_batches_mutex);
+    g_http_batches.clear();
+    g_http_streams.clear();
+}
 
-    vm.stack_manager.push(Value::createNIL());
+void android_http_cache_open(const std::string& directory) {
+    if (!g_http_cache) g_http_cache = std::make_unique<HttpCache>(directory);
+}
+
+// Registers the one-shot callback and queues the request. The callback handle
+// doubles as the request handle returned to Droplet code (see android_http_cancel).
+//
+// A cached GET answers from disk first: a fresh entry skips the network, a stale
+// one is delivered at once and revalidated, and the callback runs a second time
+// only if the body changed (stale-while-revalidate).
+static int submit_http_request(const char* method, std::string url, std::string body,
+                               std::string headers, const Value& callback) {
+    CallbackHandle handle = g_callbacks.insert(callback, -1, kNoCallbackOwner, true);
+    if (handle == kInvalidCallback || !g_http) return -1;
+
+    HttpRequest request{method, std::move(url), std::move(body), std::move(headers)};
+
+    std::optional<HttpCacheEntry> cached;
+    std::string cachedBody;
+    if (g_http_cache && request.method == "GET") cached = g_http_cache->lookup(request.url, request.headers);
+    if (cached && g_http_cache->read_body(*cached, cachedBody)) {
+        bool fresh = HttpCache::fresh(*cached, static_cast<int64_t>(std::time(nullptr)));
+        DROPLET_TRACE("http_cache_hit", handle, fresh ? 1 : 0);
+        post_http_response(handle, 200, std::move(cachedBody), !fresh, false);
+        if (fresh) return handle;
+
+        request.revalidates = cached->hash;
+        request.headers = HttpCache::with_validators(request.headers, *cached);
+    }
+
+    g_http->submit(handle, std::move(request));
+    return handle;
 }
 
-void android_set_view_elevation(VM& vm, const uint8_t argc) {
+// HTTP GET: android_http_get(url, callback, headers_optional) -> request handle
+void android_http_get(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_http_get");
     if (argc < 2) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
     }
 
-    Value elevVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int elevation = (elevVal.type == ValueType::INT) ? elevVal.current_value.i : 0;
+    // Pop headers if provided (optional JSON string)
+    std::string headers = "";
+    if (argc >= 3) {
+        Value headersVal = vm.stack_manager.pop();
+        headers = headersVal.toString();
+    }
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+    Value callback = vm.stack_manager.pop();
+    Value urlVal = vm.stack_manager.pop();
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewElevation", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, elevation);
+    for (int i = 3; i < argc; i++) vm.stack_manager.pop();
 
-    vm.stack_manager.push(Value::createNIL());
+    push_int_to_vm_stack(vm, submit_http_request("GET", urlVal.toString(), "", std::move(headers), callback));
 }
 
-void android_set_view_corner_radius(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
+// HTTP POST: android_http_post(url, body, callback, headers_optional) -> request handle
+void android_http_post(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_http_post");
+    if (argc < 3) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
     }
 
-    Value radiusVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 2; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int radius = (radiusVal.type == ValueType::INT) ? radiusVal.current_value.i : 0;
+    std::string headers = "";
+    if (argc >= 4) {
+        Value headersVal = vm.stack_manager.pop();
+        headers = headersVal.toString();
+    }
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+    Value callback = vm.stack_manager.pop();
+    Value bodyVal = vm.stack_manager.pop();
+    Value urlVal = vm.stack_manager.pop();
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewCornerRadius", "(II)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, radius);
+    for (int i = 4; i < argc; i++) vm.stack_manager.pop();
 
-    vm.stack_manager.push(Value::createNIL());
+    push_int_to_vm_stack(vm, submit_http_request("POST", urlVal.toString(), bodyVal.toString(),
+                                                 std::move(headers), callback));
 }
 
-void android_set_view_border(VM& vm, const uint8_t argc) {
+// HTTP PUT: android_http_put(url, body, callback, headers_optional) -> request handle
+void android_http_put(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_http_put");
     if (argc < 3) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
     }
 
-    Value colorVal = vm.stack_manager.pop();
-    Value widthVal = vm.stack_manager.pop();
-    Value idVal = vm.stack_manager.pop();
-    for (int i = 3; i < argc; i++) vm.stack_manager.pop();
-
-    int viewId = (idVal.type == ValueType::INT) ? idVal.current_value.i : -1;
-    int width = (widthVal.type == ValueType::INT) ? widthVal.current_value.i : 1;
-    int color = (colorVal.type == ValueType::INT) ? colorVal.current_value.i : 0xFF000000;
+    std::string headers = "";
+    if (argc >= 4) {
+        Value headersVal = vm.stack_manager.pop();
+        headers = headersVal.toString();
+    }
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+    Value callback = vm.stack_manager.pop();
+    Value bodyVal = vm.stack_manager.pop();
+    Value urlVal = vm.stack_manager.pop();
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "setViewBorder", "(III)V");
-    env->CallVoidMethod(droplet_activity, method, viewId, width, color);
+    for (int i = 4; i < argc; i++) vm.stack_manager.pop();
 
-    vm.stack_manager.push(Value::createNIL());
+    push_int_to_vm_stack(vm, submit_http_request("PUT", urlVal.toString(), bodyVal.toString(),
+                                                 std::move(headers), callback));
 }
 
-// ============================================
-// HTTP FUNCTIONS
-// ============================================
-
-// Replace your HTTP functions with these fixed versions that properly initialize userData
-
-// HTTP GET: android_http_get(url, callback, headers_optional)
-void android_http_get(VM& vm, const uint8_t argc) {
+// HTTP DELETE: android_http_delete(url, callback, headers_optional) -> request handle
+void android_http_delete(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_http_delete");
     if (argc < 2) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
     }
 
-    // Pop headers if provided (optional JSON string)
     std::string headers = "";
     if (argc >= 3) {
         Value headersVal = vm.stack_manager.pop();
@@ -1071,240 +963,335 @@ void android_http_get(VM& vm, const uint8_t argc) {
 
     for (int i = 3; i < argc; i++) vm.stack_manager.pop();
 
-    std::string url = urlVal.toString();
-    int callbackId = g_next_callback_id++;
-
-    CallbackInfo info;
-    info.callback = callback;
-    info.userData = -1;  // INITIALIZE userData for HTTP callbacks
-    if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-        info.gcRoot = callback.current_value.object;
-        g_callback_gc_roots.push_back(callback.current_value.object);
-    } else {
-        info.gcRoot = nullptr;
-    }
-    g_callbacks[callbackId] = info;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "httpGet", "(Ljava/lang/String;ILjava/lang/String;)V");
-    jstring jurl = env->NewStringUTF(url.c_str());
-    jstring jheaders = env->NewStringUTF(headers.c_str());
-    env->CallVoidMethod(droplet_activity, method, jurl, callbackId, jheaders);
-    env->DeleteLocalRef(jurl);
-    env->DeleteLocalRef(jheaders);
-
-    vm.stack_manager.push(Value::createNIL());
+    push_int_to_vm_stack(vm, submit_http_request("DELETE", urlVal.toString(), "", std::move(headers), callback));
 }
 
-// HTTP POST: android_http_post(url, body, callback, headers_optional)
-void android_http_post(VM& vm, const uint8_t argc) {
+// android_http_batch(url, query, callback, windowMs_optional) -> request handle
+//
+// For endpoints that take an array of queries: queries for the same URL within
+// windowMs (default 20) of the first are POSTed together as one JSON array, and
+// each callback receives its element of the JSON array that comes back. `query`
+// is JSON text.
+void android_http_batch(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_http_batch");
     if (argc < 3) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
     }
 
-    std::string headers = "";
+    int windowMs = 20;
     if (argc >= 4) {
-        Value headersVal = vm.stack_manager.pop();
-        headers = headersVal.toString();
+        Value windowVal = vm.stack_manager.pop();
+        if (windowVal.type == ValueType::INT && windowVal.current_value.i >= 0) windowMs = windowVal.current_value.i;
     }
 
     Value callback = vm.stack_manager.pop();
-    Value bodyVal = vm.stack_manager.pop();
+    Value queryVal = vm.stack_manager.pop();
     Value urlVal = vm.stack_manager.pop();
 
     for (int i = 4; i < argc; i++) vm.stack_manager.pop();
 
-    std::string url = urlVal.toString();
-    std::string body = bodyVal.toString();
-    int callbackId = g_next_callback_id++;
-
-    CallbackInfo info;
-    info.callback = callback;
-    info.userData = -1;  // INITIALIZE userData
-    if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-        info.gcRoot = callback.current_value.object;
-        g_callback_gc_roots.push_back(callback.current_value.object);
-    } else {
-        info.gcRoot = nullptr;
+    CallbackHandle handle = g_callbacks.insert(callback, -1, kNoCallbackOwner, true);
+    if (handle == kInvalidCallback || !g_http) {
+        push_int_to_vm_stack(vm, -1);
+        return;
     }
-    g_callbacks[callbackId] = info;
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+    std::string url = urlVal.toString();
+    std::string query = queryVal.toString();
+
+    std::lock_guard<std::mutex> lock(g_http_batches_mutex);
+    auto open = g_http_batches.find(url);
+    bool joined = open != g_http_batches.end() &&
+                  g_http->join(open->second, handle, [&](HttpRequest& request) {
+                      request.body.back() = ',';
+                      request.body += query;
+                      request.body += ']';
+                  });
+
+    if (!joined) {
+        HttpRequest request{"POST", url, "[" + query + "]", R"({"Content-Type":"application/json"})"};
+        request.batch = true;
+        request.notBefore = std::chrono::steady_clock::now() + std::chrono::milliseconds(windowMs);
+        // Entered before submit so the completion always finds it
+        g_http_batches[url] = handle;
+        g_http->submit(handle, std::move(request));
+    }
+    DROPLET_TRACE("http_batch", handle, joined ? 1 : 0);
+    push_int_to_vm_stack(vm, handle);
+}
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "httpPost", "(Ljava/lang/String;Ljava/lang/String;ILjava/lang/String;)V");
-    jstring jurl = env->NewStringUTF(url.c_str());
-    jstring jbody = env->NewStringUTF(body.c_str());
-    jstring jheaders = env->NewStringUTF(headers.c_str());
-    env->CallVoidMethod(droplet_activity, method, jurl, jbody, callbackId, jheaders);
-    env->DeleteLocalRef(jurl);
-    env->DeleteLocalRef(jbody);
-    env->DeleteLocalRef(jheaders);
+// A streaming GET's elements on their way to the VM thread. The worker parses
+// each chunk and posts the elements it completes; once more than
+// kMaxQueuedStreamItems wait for the VM it stops reading, so memory stays bounded
+// when Droplet code is slower than the network.
+struct HttpStream {
+    JsonArrayStream parser;
+    CallbackHandle itemCallback = kInvalidCallback;
+    size_t delivered = 0;  // VM thread: index of the next element
+
+    std::mutex mutex;
+    std::condition_variable drained;
+    size_t queued = 0;
+};
 
-    vm.stack_manager.push(Value::createNIL());
-}
+constexpr size_t kMaxQueuedStreamItems = 4096;
+
+// VM thread: each element to the item callback, then one UI flush for all of them
+static void deliver_stream_items(HttpStream& stream, std::vector<std::string>& items) {
+    for (std::string& item : items) {
+        // Looked up per element: a callback may cancel the request
+        CallbackEntry* info = g_callbacks.find(stream.itemCallback);
+        if (info && g_vm_instance && g_vm_instance->is_ready()) {
+            ObjString* itemObj = g_vm_instance->allocator.allocate_string(std::move(item));
+            invoke_callback(*info, {Value::createOBJECT(itemObj), Value::createINT(static_cast<int>(stream.delivered))},
+                            false);
+        }
+        stream.delivered++;
+    }
+    android_flush_ui_commands();
 
-// HTTP PUT: android_http_put(url, body, callback, headers_optional)
-void android_http_put(VM& vm, const uint8_t argc) {
-    if (argc < 3) {
-        for (int i = 0; i < argc; i++) vm.stack_manager.pop();
-        vm.stack_manager.push(Value::createNIL());
-        return;
+    {
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        stream.queued -= items.size();
     }
+    stream.drained.notify_one();
+}
 
-    std::string headers = "";
-    if (argc >= 4) {
-        Value headersVal = vm.stack_manager.pop();
-        headers = headersVal.toString();
+// Worker thread, HttpRequest::stream of android_http_get_stream
+static bool stream_http_chunk(const std::shared_ptr<HttpStream>& stream, HttpCall& call, std::string_view chunk) {
+    if (chunk.empty()) {
+        // End of the body: a successful response must have been one whole array
+        bool ok = call.statusCode < 200 || call.statusCode > 299 || stream->parser.finished();
+        if (!ok) {
+            call.statusCode = 0;
+            call.response = stream->parser.failed() ? "Error: response is not a JSON array"
+                                                    : "Error: JSON array ended early";
+        }
+        return ok;
     }
 
-    Value callback = vm.stack_manager.pop();
-    Value bodyVal = vm.stack_manager.pop();
-    Value urlVal = vm.stack_manager.pop();
+    std::vector<std::string> items;
+    bool ok = stream->parser.feed(chunk, items);
+    if (items.empty()) return ok;
 
-    for (int i = 4; i < argc; i++) vm.stack_manager.pop();
+    VmEventLoop* loop = g_event_loop.load(std::memory_order_acquire);
+    if (!loop) return false;
 
-    std::string url = urlVal.toString();
-    std::string body = bodyVal.toString();
-    int callbackId = g_next_callback_id++;
-
-    CallbackInfo info;
-    info.callback = callback;
-    info.userData = -1;  // INITIALIZE userData
-    if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-        info.gcRoot = callback.current_value.object;
-        g_callback_gc_roots.push_back(callback.current_value.object);
-    } else {
-        info.gcRoot = nullptr;
+    size_t count = items.size();
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->queued += count;
     }
-    g_callbacks[callbackId] = info;
-
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
-
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "httpPut", "(Ljava/lang/String;Ljava/lang/String;ILjava/lang/String;)V");
-    jstring jurl = env->NewStringUTF(url.c_str());
-    jstring jbody = env->NewStringUTF(body.c_str());
-    jstring jheaders = env->NewStringUTF(headers.c_str());
-    env->CallVoidMethod(droplet_activity, method, jurl, jbody, callbackId, jheaders);
-    env->DeleteLocalRef(jurl);
-    env->DeleteLocalRef(jbody);
-    env->DeleteLocalRef(jheaders);
+    VmEvent event;
+    event.task = [stream, items = std::move(items)]() mutable { deliver_stream_items(*stream, items); };
+    loop->post(std::move(event));
 
-    vm.stack_manager.push(Value::createNIL());
+    // Cancellation (or shutdown, where the VM thread is already gone) ends the wait
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    while (stream->queued > kMaxQueuedStreamItems && !call.cancelled.load()) {
+        stream->drained.wait_for(lock, std::chrono::milliseconds(50));
+    }
+    return ok && !call.cancelled.load();
 }
 
-// HTTP DELETE: android_http_delete(url, callback, headers_optional)
-void android_http_delete(VM& vm, const uint8_t argc) {
-    if (argc < 2) {
+// android_http_get_stream(url, onItem, onDone, headers_optional) -> request handle
+//
+// For a response that is one large JSON array: onItem(item, index) runs for each
+// element as soon as it has arrived, with the element's JSON text, and onDone
+// (success, error, statusCode) once the download ends. The body is never held
+// whole, neither in Java nor here. Bypasses the response cache.
+void android_http_get_stream(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_http_get_stream");
+    if (argc < 3) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
         return;
     }
 
     std::string headers = "";
-    if (argc >= 3) {
+    if (argc >= 4) {
         Value headersVal = vm.stack_manager.pop();
         headers = headersVal.toString();
     }
 
-    Value callback = vm.stack_manager.pop();
+    Value onDone = vm.stack_manager.pop();
+    Value onItem = vm.stack_manager.pop();
     Value urlVal = vm.stack_manager.pop();
 
-    for (int i = 3; i < argc; i++) vm.stack_manager.pop();
+    for (int i = 4; i < argc; i++) vm.stack_manager.pop();
 
-    std::string url = urlVal.toString();
-    int callbackId = g_next_callback_id++;
-
-    CallbackInfo info;
-    info.callback = callback;
-    info.userData = -1;  // INITIALIZE userData
-    if (callback.type == ValueType::OBJECT && callback.current_value.object) {
-        info.gcRoot = callback.current_value.object;
-        g_callback_gc_roots.push_back(callback.current_value.object);
-    } else {
-        info.gcRoot = nullptr;
+    CallbackHandle item = g_callbacks.insert(onItem, -1, kNoCallbackOwner, false);
+    CallbackHandle done = g_callbacks.insert(onDone, -1, kNoCallbackOwner, true);
+    if (item == kInvalidCallback || done == kInvalidCallback || !g_http) {
+        g_callbacks.release(item);
+        g_callbacks.release(done);
+        push_int_to_vm_stack(vm, -1);
+        return;
     }
-    g_callbacks[callbackId] = info;
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+    auto stream = std::make_shared<HttpStream>();
+    stream->itemCallback = item;
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "httpDelete", "(Ljava/lang/String;ILjava/lang/String;)V");
-    jstring jurl = env->NewStringUTF(url.c_str());
-    jstring jheaders = env->NewStringUTF(headers.c_str());
-    env->CallVoidMethod(droplet_activity, method, jurl, callbackId, jheaders);
-    env->DeleteLocalRef(jurl);
-    env->DeleteLocalRef(jheaders);
+    HttpRequest request{"GET", urlVal.toString(), "", std::move(headers)};
+    request.stream = [stream](HttpCall& call, std::string_view chunk) {
+        return stream_http_chunk(stream, call, chunk);
+    };
+    g_http_streams[done] = item;
+    g_http->submit(done, std::move(request));
+    push_int_to_vm_stack(vm, done);
+}
 
-    vm.stack_manager.push(Value::createNIL());
+// The item callback of a streaming request goes with its request handle
+static void release_http_stream(CallbackHandle handle) {
+    auto it = g_http_streams.find(handle);
+    if (it == g_http_streams.end()) return;
+    g_callbacks.release(it->second);
+    g_http_streams.erase(it);
 }
 
-// HTTP Response callback (called from Java)
-extern "C"
-JNIEXPORT void JNICALL
-Java_com_mist_example_MainActivity_onHttpResponse(JNIEnv* env, jobject thiz,
-                                                  jint callbackId,
-                                                  jboolean success,
-                                                  jstring response,
-                                                  jint statusCode) {
-    __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "HTTP response received for callback %d", callbackId);
+// android_http_cancel(requestHandle): the callback will not run
+void android_http_cancel(int handle) {
+    // A batch every waiter has left is never completed, so nothing else drops its entry
+    if (g_http && g_http->cancel(handle)) prune_http_batches();
+    g_callbacks.release(handle);
+    release_http_stream(handle);
+}
+
+// Runs on the VM thread for a response completed by g_http
+static void dispatch_http_response(VmEvent& event) {
+    int callbackId = event.callbackId;
+    DROPLET_TRACE("http_response", callbackId, event.statusCode);
+
+    // The revalidation confirmed the cached body the callback already received
+    if (event.unchanged) {
+        g_callbacks.release(callbackId);
+        return;
+    }
 
     if (!g_vm_instance) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "VM instance not set");
+        DROPLET_LOGE("VM instance not set");
         return;
     }
 
     if (!g_vm_instance->is_ready()) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "VM is not ready");
+        DROPLET_LOGE("VM is not ready");
         return;
     }
 
-    auto it = g_callbacks.find(callbackId);
-    if (it == g_callbacks.end()) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Callback %d not found", callbackId);
+    CallbackEntry* info = g_callbacks.find(callbackId);
+    if (!info) {
+        DROPLET_LOGE("Callback %d not found", callbackId);
         return;
     }
 
-    CallbackInfo& info = it->second;
-    Value callback = info.callback;
+    // success (int), response (string), statusCode (int)
+    ObjString* responseObj = g_vm_instance->allocator.allocate_string(std::move(event.body));
+    bool success = invoke_callback(*info, {Value::createINT(event.success ? 1 : 0),
+                                           Value::createOBJECT(responseObj),
+                                           Value::createINT(event.statusCode)});
 
-    const char* responseStr = env->GetStringUTFChars(response, nullptr);
-    std::string responseData = std::string(responseStr);
-    env->ReleaseStringUTFChars(response, responseStr);
+    if (!success) {
+        DROPLET_LOGE("HTTP callback execution failed");
+    }
 
-    try {
-        // Create arguments: success (bool), response (string), statusCode (int)
-        std::vector<Value> args;
-        args.push_back(Value::createINT(success ? 1 : 0));
+    // A cached body being revalidated: the callback stays for the network response
+    if (!event.revalidating) {
+        g_callbacks.release(callbackId);
+        release_http_stream(callbackId);
+    }
+}
 
-        ObjString* responseObj = g_vm_instance->allocator.allocate_string(responseData);
-        args.push_back(Value::createOBJECT(responseObj));
+void android_dispatch_vm_event(VmEvent& event) {
+    switch (event.kind) {
+        case VmEvent::Kind::ButtonClick:
+            dispatch_button_click(event.callbackId);
+            break;
+        case VmEvent::Kind::HttpResponse:
+            dispatch_http_response(event);
+            break;
+        default:
+            break;
+    }
+}
 
-        args.push_back(Value::createINT(statusCode));
+// Called from Java (UI thread) when a button is clicked
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_mist_example_MainActivity_onButtonClick(JNIEnv* env, jobject thiz, jint callbackId) {
+    VmEventLoop* loop = g_event_loop.load(std::memory_order_acquire);
+    if (!loop) {
+        DROPLET_LOGE("VM event loop not running");
+        return;
+    }
 
-        bool execSuccess = g_vm_instance->execute_callback(callback, args);
+    VmEvent event;
+    event.kind = VmEvent::Kind::ButtonClick;
+    event.callbackId = callbackId;
+    loop->post(std::move(event));
+}
 
-        if (execSuccess) {
-            __android_log_print(ANDROID_LOG_INFO, LOG_TAG, "HTTP callback executed successfully");
-        } else {
-            __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "HTTP callback execution failed");
-        }
+// Body bytes for the request the calling worker is executing (MainActivity.httpExecute).
+// Returns false once the request is cancelled so Java stops reading.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_mist_example_MainActivity_onHttpChunk(JNIEnv* env, jobject thiz,
+                                               jint requestId,
+                                               jobject buffer,
+                                               jint length) {
+    HttpCall* call = t_http_call;
+    if (!call || call->id != requestId) return JNI_FALSE;
+
+    auto* bytes = static_cast<const char*>(env->GetDirectBufferAddress(buffer));
+    if (!bytes || length <= 0) return JNI_TRUE;
+    return call->append(bytes, static_cast<size_t>(length)) ? JNI_TRUE : JNI_FALSE;
+}
 
-    } catch (const std::exception& e) {
-        __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, "Exception in HTTP callback: %s", e.what());
-    }
+// Whether the request the calling worker is executing was cancelled. MainActivity
+// asks once its connection is registered for httpAbort, which covers an abort
+// that came before that.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_mist_example_MainActivity_isHttpCancelled(JNIEnv* env, jobject thiz, jint requestId) {
+    HttpCall* call = t_http_call;
+    return (!call || call->id != requestId || call->cancelled.load()) ? JNI_TRUE : JNI_FALSE;
+}
+
+// Status and response headers ("Name: value" lines), reported before the body.
+// A gzip or deflate Content-Encoding makes the call decode the chunks that follow.
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_mist_example_MainActivity_onHttpHeaders(JNIEnv* env, jobject thiz,
+                                                 jint requestId,
+                                                 jint statusCode,
+                                                 jstring headers) {
+    HttpCall* call = t_http_call;
+    if (!call || call->id != requestId) return;
+
+    call->statusCode = statusCode;
+
+    const char* text = env->GetStringUTFChars(headers, nullptr);
+    call->set_response_headers(text);
+    env->ReleaseStringUTFChars(headers, text);
+}
+
+// Transport error: the message replaces whatever body was received
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_mist_example_MainActivity_onHttpFailed(JNIEnv* env, jobject thiz,
+                                                jint requestId,
+                                                jstring message) {
+    HttpCall* call = t_http_call;
+    if (!call || call->id != requestId) return;
+
+    const char* msg = env->GetStringUTFChars(message, nullptr);
+    call->response = msg;
+    env->ReleaseStringUTFChars(message, msg);
 }
 
 void android_clear_screen(VM& vm, const uint8_t argc) {
+    DROPLET_SPAN("android_clear_screen");
     if (argc < 1) {
         for (int i = 0; i < argc; i++) vm.stack_manager.pop();
         vm.stack_manager.push(Value::createNIL());
@@ -1316,13 +1303,41 @@ void android_clear_screen(VM& vm, const uint8_t argc) {
 
     int screenId = (screenIdVal.type == ValueType::INT) ? screenIdVal.current_value.i : -1;
 
-    JNIEnv* env;
-    droplet_java_vm->AttachCurrentThread(&env, nullptr);
+    // Buttons and lists on the screen go away with their views, and so do
+    // their callbacks and rows
+    g_callbacks.release_owned(screenId);
+    std::erase_if(g_view_screen, [screenId](const auto& view) {
+        if (view.second != screenId || view.first == screenId) return false;
+        g_recycler_rows.erase(view.first);
+        return true;
+    });
 
-    jclass cls = env->GetObjectClass(droplet_activity);
-    jmethodID method = env->GetMethodID(cls, "clearScreen", "(I)V");
-    env->CallVoidMethod(droplet_activity, method, screenId);
+    std::vector<ViewTree::Removed> dropped;
+    g_view_tree.clear(screenId, dropped);
+
+    g_ui_commands.emit(UiOp::ClearScreen, {screenId});
 
     vm.stack_manager.push(Value::createNIL());
 }
+
+// Start re-running a screen's build code; see ViewTree.h for how views are reused.
+// An unfinished rebuild is ended first.
+void android_begin_rebuild(int screenId) {
+    if (g_view_tree.rebuilding()) android_end_rebuild();
+    g_view_tree.begin_rebuild(screenId);
+}
+
+// Remove the views the rebuild did not place again, with their callbacks and rows
+void android_end_rebuild() {
+    DROPLET_SPAN("android_end_rebuild");
+    std::vector<ViewTree::Removed> removed;
+    g_view_tree.end_rebuild(removed);
+
+    for (const ViewTree::Removed& view : removed) {
+        if (view.callback != kInvalidCallback) g_callbacks.release(view.callback);
+        g_recycler_rows.erase(view.viewId);
+        g_view_screen.erase(view.viewId);
+        g_ui_commands.emit(UiOp::RemoveView, {view.viewId});
+    }
+}
 #endif
\ No newline at end of file
@@ -1,118 +1,172 @@
 #ifndef DROPLET_ANDROIDNATIVE_H
 #define DROPLET_ANDROIDNATIVE_H
 
-#if defined(__ANDROID__)
+#if defined(__ANDROID__) || defined(DROPLET_HOST_BRIDGE)
 #include <cstdint>
+#include <span>
+#include <string>
 #include "../droplet/src/vm/VM.h"
+#include "../vm_event_loop.h"
+#include "CallbackRegistry.h"
+#include "NativeBinding.h"
 
 void android_set_vm_instance(VM* vm);
 
+// Drop everything the natives hold for the VM being torn down, so the next VM starts
+// clean. Call after the VM thread and the HTTP workers have stopped.
+void android_reset_vm_state();
+
+// Callbacks Java still holds handles to. Their Values are only referenced from here,
+// so the VM's collector must treat every entry's `callback` as a root. VM thread only.
+std::span<const CallbackEntry> android_callback_roots();
+
+// Loop that onButtonClick/onHttpResponse post to, nullptr while the VM is down
+void android_set_event_loop(VmEventLoop* loop);
+
+// VmEventLoop handler: runs the Droplet callback for a click or HTTP response
+void android_dispatch_vm_event(VmEvent& event);
+
+// Hand the view ops recorded since the last flush to MainActivity in one JNI call.
+// Called at the end of every VM turn (runBytecode, button and HTTP callbacks).
+void android_flush_ui_commands();
+
+// Natives with a fixed signature are plain functions registered through
+// bind_native<>; the ones taking optional arguments or callbacks keep the raw form.
+
 // existing
-void android_native_toast(VM& vm, const uint8_t argc);
+void android_native_toast(const std::string& msg);
 void android_create_button(VM& vm, const uint8_t argc);
 
 // view creation
 void android_create_textview(VM& vm, const uint8_t argc);
 void android_create_imageview(VM& vm, const uint8_t argc);
 void android_create_linearlayout(VM& vm, const uint8_t argc);
-void android_add_view_to_parent(VM& vm, const uint8_t argc);
+void android_add_view_to_parent(int parentId, int childId);
 
 // NEW: Text Input
 void android_create_edittext(VM& vm, const uint8_t argc);
-void android_get_edittext_value(VM& vm, const uint8_t argc);
-void android_set_edittext_hint(VM& vm, const uint8_t argc);
-void android_set_edittext_input_type(VM& vm, const uint8_t argc);
+std::string android_get_edittext_value(int viewId);
+void android_set_edittext_hint(int viewId, const std::string& hint);
+void android_set_edittext_input_type(int viewId, int inputType);
 
 // programmatic updates
-void android_set_view_text(VM& vm, const uint8_t argc);
-void android_set_view_image(VM& vm, const uint8_t argc);
-void android_set_view_visibility(VM& vm, const uint8_t argc);
+void android_set_view_text(int viewId, const std::string& text);
+void android_set_view_image(int viewId, const std::string& path);
+void android_set_view_visibility(int viewId, int visibility);
 void android_set_view_property(VM& vm, const uint8_t argc);
 void android_create_scrollview(VM& vm, const uint8_t argc);
 void android_create_cardview(VM& vm, const uint8_t argc);
 void android_create_recyclerview(VM& vm, const uint8_t argc);
-void android_recyclerview_add_item(VM& vm, const uint8_t argc);
-void android_recyclerview_clear(VM& vm, const uint8_t argc);
-void android_set_view_background_color(VM& vm, const uint8_t argc);
-void android_set_view_padding(VM& vm, const uint8_t argc);
-void android_set_view_size(VM& vm, const uint8_t argc);
+void android_recyclerview_add_item(int viewId, const std::string& text);
+void android_recyclerview_clear(int viewId);
+int android_recyclerview_set_items_json(int viewId, int doc, const std::string& arrayPath, const std::string& field);
+void android_set_view_background_color(int viewId, int color);
+void android_set_view_padding(int viewId, int left, int top, int right, int bottom);
+void android_set_view_size(int viewId, int width, int height);
 
 // NEW: Styling Functions
-void android_set_text_size(VM& vm, const uint8_t argc);
-void android_set_text_color(VM& vm, const uint8_t argc);
-void android_set_text_style(VM& vm, const uint8_t argc);
-void android_set_view_margin(VM& vm, const uint8_t argc);
-void android_set_view_gravity(VM& vm, const uint8_t argc);
-void android_set_view_elevation(VM& vm, const uint8_t argc);
-void android_set_view_corner_radius(VM& vm, const uint8_t argc);
-void android_set_view_border(VM& vm, const uint8_t argc);
+void android_set_text_size(int viewId, int size);
+void android_set_text_color(int viewId, int color);
+void android_set_text_style(int viewId, int style);
+void android_set_view_margin(int viewId, int left, int top, int right, int bottom);
+void android_set_view_gravity(int viewId, int gravity);
+void android_set_view_elevation(int viewId, int elevation);
+void android_set_view_corner_radius(int viewId, int radius);
+void android_set_view_border(int viewId, int width, int color);
+
+// Style sheets (StyleSheet.h): define once, apply every property in one op
+int android_create_style(const std::string& declarations);
+void android_apply_style(int viewId, int styleId);
 
 // Toolbar and Navigation
-void android_set_toolbar_title(VM& vm, const uint8_t argc);
-void android_create_screen(VM& vm, const uint8_t argc);
-void android_navigate_to_screen(VM& vm, const uint8_t argc);
-void android_navigate_back(VM& vm, const uint8_t argc);
-void android_set_back_button_visible(VM& vm, const uint8_t argc);
+void android_set_toolbar_title(const std::string& title);
+int android_create_screen(const std::string& name);
+void android_navigate_to_screen(int screenId);
+void android_navigate_back();
+void android_set_back_button_visible(int visible);
 void android_clear_screen(VM& vm, const uint8_t argc);
 
+// Retained view tree: re-run a screen's build code between these two calls and
+// only the views and properties that changed are sent to MainActivity
+void android_begin_rebuild(int screenId);
+void android_end_rebuild();
+
 // HTTP Functions
 void android_http_get(VM& vm, const uint8_t argc);
 void android_http_post(VM& vm, const uint8_t argc);
 void android_http_put(VM& vm, const uint8_t argc);
 void android_http_delete(VM& vm, const uint8_t argc);
+void android_http_batch(VM& vm, const uint8_t argc);
+void android_http_get_stream(VM& vm, const uint8_t argc);
+void android_http_cancel(int handle);
+
+// Worker pool behind the android_http_* natives, started/stopped with the VM
+void android_http_start();
+void android_http_shutdown();
+
+// On-disk cache for android_http_get responses, opened once per VM
+void android_http_cache_open(const std::string& directory);
 
 inline void register_android_native_functions(VM& vm) {
-    vm.register_native("android_native_toast", android_native_toast);
+    vm.register_native("android_native_toast", bind_native<android_native_toast>);
     vm.register_native("android_create_button", android_create_button);
 
     // existing views
     vm.register_native("android_create_textview", android_create_textview);
     vm.register_native("android_create_imageview", android_create_imageview);
     vm.register_native("android_create_linearlayout", android_create_linearlayout);
-    vm.register_native("android_add_view_to_parent", android_add_view_to_parent);
+    vm.register_native("android_add_view_to_parent", bind_native<android_add_view_to_parent>);
 
     // NEW: Text Input
     vm.register_native("android_create_edittext", android_create_edittext);
-    vm.register_native("android_get_edittext_value", android_get_edittext_value);
-    vm.register_native("android_set_edittext_hint", android_set_edittext_hint);
-    vm.register_native("android_set_edittext_input_type", android_set_edittext_input_type);
+    vm.register_native("android_get_edittext_value", bind_native<android_get_edittext_value>);
+    vm.register_native("android_set_edittext_hint", bind_native<android_set_edittext_hint>);
+    vm.register_native("android_set_edittext_input_type", bind_native<android_set_edittext_input_type>);
 
-    vm.register_native("android_set_view_text", android_set_view_text);
-    vm.register_native("android_set_view_image", android_set_view_image);
-    vm.register_native("android_set_view_visibility", android_set_view_visibility);
+    vm.register_native("android_set_view_text", bind_native<android_set_view_text>);
+    vm.register_native("android_set_view_image", bind_native<android_set_view_image>);
+    vm.register_native("android_set_view_visibility", bind_native<android_set_view_visibility>);
     vm.register_native("android_set_view_property", android_set_view_property);
     vm.register_native("android_create_scrollview", android_create_scrollview);
     vm.register_native("android_create_cardview", android_create_cardview);
     vm.register_native("android_create_recyclerview", android_create_recyclerview);
-    vm.register_native("android_recyclerview_add_item", android_recyclerview_add_item);
-    vm.register_native("android_recyclerview_clear", android_recyclerview_clear);
-    vm.register_native("android_set_view_background_color", android_set_view_background_color);
-    vm.register_native("android_set_view_padding", android_set_view_padding);
-    vm.register_native("android_set_view_size", android_set_view_size);
+    vm.register_native("android_recyclerview_add_item", bind_native<android_recyclerview_add_item>);
+    vm.register_native("android_recyclerview_clear", bind_native<android_recyclerview_clear>);
+    vm.register_native("android_recyclerview_set_items_json", bind_native<android_recyclerview_set_items_json>);
+    vm.register_native("android_set_view_background_color", bind_native<android_set_view_background_color>);
+    vm.register_native("android_set_view_padding", bind_native<android_set_view_padding>);
+    vm.register_native("android_set_view_size", bind_native<android_set_view_size>);
 
     // Styling Functions
-    vm.register_native("android_set_text_size", android_set_text_size);
-    vm.register_native("android_set_text_color", android_set_text_color);
-    vm.register_native("android_set_text_style", android_set_text_style);
-    vm.register_native("android_set_view_margin", android_set_view_margin);
-    vm.register_native("android_set_view_gravity", android_set_view_gravity);
-    vm.register_native("android_set_view_elevation", android_set_view_elevation);
-    vm.register_native("android_set_view_corner_radius", android_set_view_corner_radius);
-    vm.register_native("android_set_view_border", android_set_view_border);
+    vm.register_native("android_set_text_size", bind_native<android_set_text_size>);
+    vm.register_native("android_set_text_color", bind_native<android_set_text_color>);
+    vm.register_native("android_set_text_style", bind_native<android_set_text_style>);
+    vm.register_native("android_set_view_margin", bind_native<android_set_view_margin>);
+    vm.register_native("android_set_view_gravity", bind_native<android_set_view_gravity>);
+    vm.register_native("android_set_view_elevation", bind_native<android_set_view_elevation>);
+    vm.register_native("android_set_view_corner_radius", bind_native<android_set_view_corner_radius>);
+    vm.register_native("android_set_view_border", bind_native<android_set_view_border>);
+    vm.register_native("android_create_style", bind_native<android_create_style>);
+    vm.register_native("android_apply_style", bind_native<android_apply_style>);
 
     // Toolbar and Navigation
-    vm.register_native("android_set_toolbar_title", android_set_toolbar_title);
-    vm.register_native("android_create_screen", android_create_screen);
-    vm.register_native("android_navigate_to_screen", android_navigate_to_screen);
-    vm.register_native("android_navigate_back", android_navigate_back);
-    vm.register_native("android_set_back_button_visible", android_set_back_button_visible);
+    vm.register_native("android_set_toolbar_title", bind_native<android_set_toolbar_title>);
+    vm.register_native("android_create_screen", bind_native<android_create_screen>);
+    vm.register_native("android_navigate_to_screen", bind_native<android_navigate_to_screen>);
+    vm.register_native("android_navigate_back", bind_native<android_navigate_back>);
+    vm.register_native("android_set_back_button_visible", bind_native<android_set_back_button_visible>);
     vm.register_native("android_clear_screen", android_clear_screen);
+    vm.register_native("android_begin_rebuild", bind_native<android_begin_rebuild>);
+    vm.register_native("android_end_rebuild", bind_native<android_end_rebuild>);
 
     // HTTP Functions
     vm.register_native("android_http_get", android_http_get);
     vm.register_native("android_http_post", android_http_post);
     vm.register_native("android_http_put", android_http_put);
     vm.register_native("android_http_delete", android_http_delete);
+    vm.register_native("android_http_batch", android_http_batch);
+    vm.register_native("android_http_get_stream", android_http_get_stream);
+    vm.register_native("android_http_cancel", bind_native<android_http_cancel>);
 }
 #endif
 
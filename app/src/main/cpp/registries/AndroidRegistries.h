@@ -3,10 +3,15 @@
 
 #include "../droplet/src/compiler/TypeChecker.h"
 #include "../droplet/src/native/NativeRegisteries.h"
+#include "AndroidNative.h"
+#include "JsonNative.h"
+#include "NativeBinding.h"
 
+// Natives bound through bind_native<> take their signature from the C++
+// function; the raw (VM&, argc) ones are registered with an open parameter list.
 inline void initAndroidBuiltins() {
     registerNative({"android_create_button", Type::String(), {}});
-    registerNative({"android_native_toast", Type::String(), {}});
+    register_native_signature<android_native_toast>("android_native_toast");
 
     // Layout views
     registerNative({"android_create_linearlayout", Type::Int(), {}});
@@ -18,30 +23,61 @@ inline void initAndroidBuiltins() {
     registerNative({"android_create_textview", Type::Int(), {}});
     registerNative({"android_create_imageview", Type::Int(), {}});
 
+    // Text input
+    registerNative({"android_create_edittext", Type::Int(), {}});
+    register_native_signature<android_get_edittext_value>("android_get_edittext_value");
+    register_native_signature<android_set_edittext_hint>("android_set_edittext_hint");
+    register_native_signature<android_set_edittext_input_type>("android_set_edittext_input_type");
+
     // View manipulation
-    registerNative({"android_add_view_to_parent", Type::Null(), {}});
-    registerNative({"android_set_view_text", Type::Null(), {}});
-    registerNative({"android_set_view_image", Type::Null(), {}});
-    registerNative({"android_set_view_visibility", Type::Null(), {}});
-    registerNative({"android_set_view_background_color", Type::Null(), {}});
-    registerNative({"android_set_view_padding", Type::Null(), {}});
-    registerNative({"android_set_view_size", Type::Null(), {}});
+    register_native_signature<android_add_view_to_parent>("android_add_view_to_parent");
+    register_native_signature<android_set_view_text>("android_set_view_text");
+    register_native_signature<android_set_view_image>("android_set_view_image");
+    register_native_signature<android_set_view_visibility>("android_set_view_visibility");
+    register_native_signature<android_set_view_background_color>("android_set_view_background_color");
+    register_native_signature<android_set_view_padding>("android_set_view_padding");
+    register_native_signature<android_set_view_size>("android_set_view_size");
+
+    // Styling
+    register_native_signature<android_set_text_size>("android_set_text_size");
+    register_native_signature<android_set_text_color>("android_set_text_color");
+    register_native_signature<android_set_text_style>("android_set_text_style");
+    register_native_signature<android_set_view_margin>("android_set_view_margin");
+    register_native_signature<android_set_view_gravity>("android_set_view_gravity");
+    register_native_signature<android_set_view_elevation>("android_set_view_elevation");
+    register_native_signature<android_set_view_corner_radius>("android_set_view_corner_radius");
+    register_native_signature<android_set_view_border>("android_set_view_border");
+    register_native_signature<android_create_style>("android_create_style");
+    register_native_signature<android_apply_style>("android_apply_style");
 
     // RecyclerView specific
-    registerNative({"android_recyclerview_add_item", Type::Null(), {}});
-    registerNative({"android_recyclerview_clear", Type::Null(), {}});
+    register_native_signature<android_recyclerview_add_item>("android_recyclerview_add_item");
+    register_native_signature<android_recyclerview_clear>("android_recyclerview_clear");
+    register_native_signature<android_recyclerview_set_items_json>("android_recyclerview_set_items_json");
 
     // Toolbar and Navigation
-    registerNative({"android_set_toolbar_title", Type::Null(), {}});
-    registerNative({"android_create_screen", Type::Int(), {}});
-    registerNative({"android_navigate_to_screen", Type::Null(), {}});
-    registerNative({"android_navigate_back", Type::Null(), {}});
-    registerNative({"android_set_back_button_visible", Type::Null(), {}});
-
-    registerNative({"android_http_get", Type::Null(), {}});
-    registerNative({"android_http_post", Type::Null(), {}});
-    registerNative({"android_http_put", Type::Null(), {}});
-    registerNative({"android_http_delete", Type::Null(), {}});
+    register_native_signature<android_set_toolbar_title>("android_set_toolbar_title");
+    register_native_signature<android_create_screen>("android_create_screen");
+    register_native_signature<android_navigate_to_screen>("android_navigate_to_screen");
+    register_native_signature<android_navigate_back>("android_navigate_back");
+    register_native_signature<android_set_back_button_visible>("android_set_back_button_visible");
+    register_native_signature<android_begin_rebuild>("android_begin_rebuild");
+    register_native_signature<android_end_rebuild>("android_end_rebuild");
+
+    registerNative({"android_http_get", Type::Int(), {}});
+    registerNative({"android_http_post", Type::Int(), {}});
+    registerNative({"android_http_put", Type::Int(), {}});
+    registerNative({"android_http_delete", Type::Int(), {}});
+    registerNative({"android_http_batch", Type::Int(), {}});
+    registerNative({"android_http_get_stream", Type::Int(), {}});
+    register_native_signature<android_http_cancel>("android_http_cancel");
+
+    // JSON documents
+    register_native_signature<json_parse>("json_parse");
+    register_native_signature<json_get_path>("json_get_path");
+    register_native_signature<json_array_len>("json_array_len");
+    register_native_signature<json_array_at>("json_array_at");
+    register_native_signature<json_free>("json_free");
 }
 
-#endif //MIST_ANDROIDREGISTRIES_H
\ No newline at end of file
+#endif //MIST_ANDROIDREGISTRIES_H
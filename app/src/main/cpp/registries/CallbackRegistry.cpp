@@ -0,0 +1,24 @@
+#include "CallbackRegistry.h"
+
+static void resolve_callable(CallbackEntry& entry) {
+    if (entry.callback.type != ValueType::OBJECT || !entry.callback.current_value.object) return;
+
+    Object* object = entry.callback.current_value.object;
+    if (auto* method = dynamic_cast<ObjBoundMethod*>(object)) {
+        entry.kind = CallbackKind::BoundMethod;
+        entry.functionIndex = method->methodIndex;
+    } else if (auto* function = dynamic_cast<ObjFunction*>(object)) {
+        entry.kind = CallbackKind::Function;
+        entry.functionIndex = function->functionIndex;
+    }
+}
+
+CallbackHandle CallbackRegistry::insert(const Value& callback, int userData, int owner, bool oneShot) {
+    CallbackEntry entry{callback, userData, owner, oneShot};
+    resolve_callable(entry);
+    return entries.insert(entry);
+}
+
+size_t CallbackRegistry::release_owned(int owner) {
+    return entries.release_if([owner](const CallbackEntry& entry) { return entry.owner == owner; });
+}
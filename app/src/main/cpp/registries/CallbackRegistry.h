@@ -0,0 +1,55 @@
+#ifndef MIST_CALLBACKREGISTRY_H
+#define MIST_CALLBACKREGISTRY_H
+
+#include <climits>
+#include <cstdint>
+#include <span>
+#include "../droplet/src/vm/VM.h"
+#include "SlotMap.h"
+
+// Handle given to Java in place of the callback (a SlotMap handle)
+using CallbackHandle = SlotHandle;
+constexpr CallbackHandle kInvalidCallback = kInvalidSlot;
+
+// Owner for callbacks that no screen clear should drop (HTTP completions)
+constexpr int kNoCallbackOwner = INT_MIN;
+
+// What the callback value is, resolved once at insert so dispatch needs no RTTI
+enum class CallbackKind : uint8_t { Function, BoundMethod, Other };
+
+struct CallbackEntry {
+    Value callback;
+    int userData = -1;
+    int owner = kNoCallbackOwner;  // screen that releases it on clear
+    bool oneShot = false;           // released after its first dispatch
+    CallbackKind kind = CallbackKind::Other;
+    int functionIndex = -1;         // function or method index, -1 for Other
+};
+
+// Live Droplet callbacks: O(1) insert, lookup and release (see SlotMap).
+// Entries are kept dense, so the callbacks the GC must keep alive form one span.
+class CallbackRegistry {
+public:
+    CallbackHandle insert(const Value& callback, int userData, int owner, bool oneShot);
+
+    // nullptr if the handle was released (or never issued)
+    CallbackEntry* find(CallbackHandle handle) { return entries.find(handle); }
+
+    bool release(CallbackHandle handle) { return entries.release(handle); }
+
+    // Release every callback owned by `owner`, returns how many were dropped
+    size_t release_owned(int owner);
+
+    // Drop every callback, e.g. when the VM that owns the Values goes away
+    void clear() { entries.clear(); }
+
+    // Every live entry; each one's `callback` is a GC root while it is here
+    std::span<const CallbackEntry> roots() const { return entries.values(); }
+
+    size_t size() const { return entries.size(); }
+
+private:
+    SlotMap<CallbackEntry> entries;
+};
+
+#endif //MIST_CALLBACKREGISTRY_H
@@ -0,0 +1,401 @@
+#include "HttpCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "HttpClient.h"
+#include "JsonDocument.h"
+
+static int64_t now_seconds() {
+    return static_cast<int64_t>(std::time(nullptr));
+}
+
+HttpCache::HttpCache(std::string directory, uint64_t maxBytes)
+        : directory(std::move(directory)), maxBytes(maxBytes) {
+    ::mkdir(this->directory.c_str(), 0700);
+    load_index();
+}
+
+uint64_t HttpCache::hash_body(std::string_view body) {
+    // FNV-1a; the length check on read catches the unlikely collision
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : body) h = (h ^ c) * 1099511628211ull;
+    return h;
+}
+
+std::string HttpCache::body_path(uint64_t hash) const {
+    char name[24];
+    std::snprintf(name, sizeof(name), "/%016" PRIx64, hash);
+    return directory + name;
+}
+
+bool HttpCache::fresh(const HttpCacheEntry& entry, int64_t now) {
+    return entry.maxAge >= 0 && now - entry.storedAt < entry.maxAge;
+}
+
+static char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Header names of a Vary value: lowercase, sorted, comma joined ("*" stays "*")
+static std::string vary_names(std::string_view vary) {
+    std::vector<std::string> names;
+    while (!vary.empty()) {
+        size_t comma = vary.find(',');
+        std::string_view name = vary.substr(0, comma);
+        vary = (comma == std::string_view::npos) ? std::string_view{} : vary.substr(comma + 1);
+
+        size_t start = name.find_first_not_of(" \t");
+        if (start == std::string_view::npos) continue;
+        name = name.substr(start, name.find_last_not_of(" \t") - start + 1);
+        std::string out(name.size(), ' ');
+        std::transform(name.begin(), name.end(), out.begin(), lower);
+        names.push_back(std::move(out));
+    }
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    std::string joined;
+    for (const std::string& name : names) {
+        if (!joined.empty()) joined += ',';
+        joined += name;
+    }
+    return joined;
+}
+
+// Hash of the request's values for the `vary` names and Authorization; a header
+// the request does not set counts as a value of its own
+static uint64_t variant_of(std::string_view vary, std::string_view requestHeaders) {
+    std::vector<std::pair<std::string, std::string>> headers;
+    JsonDocument document;
+    if (!requestHeaders.empty() && document.parse(std::string(requestHeaders))) {
+        document.for_each_field(document.root(), [&](std::string key, uint32_t value) {
+            std::transform(key.begin(), key.end(), key.begin(), lower);
+            headers.emplace_back(std::move(key), document.value(value));
+        });
+    }
+
+    std::string selected;
+    auto select = [&](std::string_view name) {
+        selected.append(name);
+        auto it = std::find_if(headers.begin(), headers.end(), [&](const auto& h) { return h.first == name; });
+        if (it != headers.end()) {
+            selected += '=';
+            selected += it->second;
+        }
+        selected += '\n';
+    };
+    select("authorization");
+    while (!vary.empty()) {
+        size_t comma = vary.find(',');
+        select(vary.substr(0, comma));
+        vary = (comma == std::string_view::npos) ? std::string_view{} : vary.substr(comma + 1);
+    }
+    return HttpCache::hash_body(selected);
+}
+
+HttpCacheEntry* HttpCache::find(const std::string& url, std::string_view requestHeaders) {
+    auto it = entries.find(url);
+    if (it == entries.end()) return nullptr;
+    for (HttpCacheEntry& entry : it->second) {
+        if (variant_of(entry.vary, requestHeaders) == entry.variant) return &entry;
+    }
+    return nullptr;
+}
+
+std::optional<HttpCacheEntry> HttpCache::lookup(const std::string& url, std::string_view requestHeaders) {
+    std::lock_guard<std::mutex> lock(mutex);
+    HttpCacheEntry* entry = find(url, requestHeaders);
+    if (!entry) return std::nullopt;
+    entry->lastUsed = now_seconds();
+    return *entry;
+}
+
+bool HttpCache::read_body(const HttpCacheEntry& entry, std::string& out) {
+    int fd = ::open(body_path(entry.hash).c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st{};
+    bool ok = fd >= 0 && ::fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) == entry.size;
+
+    // Read straight into the string the caller hands on
+    if (ok) {
+        out.resize(entry.size);
+        size_t done = 0;
+        while (done < entry.size) {
+            ssize_t n = ::read(fd, out.data() + done, entry.size - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                ok = false;
+                break;
+            }
+            done += static_cast<size_t>(n);
+        }
+    }
+    if (fd >= 0) ::close(fd);
+
+    if (!ok) {
+        out.clear();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end();) {
+            std::erase_if(it->second, [&](const HttpCacheEntry& e) { return e.hash == entry.hash; });
+            it = it->second.empty() ? entries.erase(it) : std::next(it);
+        }
+        save_index();
+    }
+    return ok;
+}
+
+void HttpCache::apply_headers(HttpCacheEntry& entry, std::string_view headers, int64_t now) const {
+    std::string_view etag = http_header(headers, "ETag");
+    std::string_view lastModified = http_header(headers, "Last-Modified");
+    if (!etag.empty()) entry.etag.assign(etag);
+    if (!lastModified.empty()) entry.lastModified.assign(lastModified);
+
+    std::string_view control = http_header(headers, "Cache-Control");
+    entry.maxAge = -1;
+    if (control.find("no-cache") != std::string_view::npos) {
+        entry.maxAge = 0;
+    } else if (size_t at = control.find("max-age="); at != std::string_view::npos) {
+        std::string_view digits = control.substr(at + 8);
+        int64_t maxAge = 0;
+        auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), maxAge);
+        if (ec == std::errc()) entry.maxAge = maxAge;
+    }
+    entry.storedAt = now;
+    entry.lastUsed = now;
+}
+
+uint64_t HttpCache::store(const std::string& url, std::string_view requestHeaders, std::string_view body,
+                          std::string_view headers) {
+    uint64_t hash = hash_body(body);
+    std::string vary = vary_names(http_header(headers, "Vary"));
+
+    // The index is tab separated, one entry per line
+    bool storable = http_header(headers, "Cache-Control").find("no-store") == std::string_view::npos &&
+                    vary != "*" && url.find_first_of("\t\n") == std::string::npos &&
+                    vary.find_first_of("\t\n") == std::string::npos;
+    if (!storable) {
+        // Whatever was cached for the URL must not be served any more
+        std::lock_guard<std::mutex> lock(mutex);
+        if (entries.count(url)) {
+            erase_url(url);
+            save_index();
+        }
+        return hash;
+    }
+
+    std::string path = body_path(hash);
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0 || static_cast<uint64_t>(st.st_size) != body.size()) {
+        // Written aside and renamed, so a reader never sees a half written body
+        std::string partial = path + ".part";
+        FILE* out = std::fopen(partial.c_str(), "wb");
+        if (!out) return hash;
+        bool written = std::fwrite(body.data(), 1, body.size(), out) == body.size();
+        written = std::fclose(out) == 0 && written;
+        if (!written || std::rename(partial.c_str(), path.c_str()) != 0) {
+            std::remove(partial.c_str());
+            return hash;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<HttpCacheEntry>& variants = entries[url];
+    uint64_t variant = variant_of(vary, requestHeaders);
+
+    // Entries stored under a different Vary are stale now; so is this variant's old body
+    std::vector<uint64_t> replaced;
+    std::erase_if(variants, [&](const HttpCacheEntry& e) {
+        bool drop = e.vary != vary || e.variant == variant;
+        if (drop && e.hash != hash) replaced.push_back(e.hash);
+        return drop;
+    });
+
+    HttpCacheEntry& entry = variants.emplace_back();
+    entry.vary = vary;
+    entry.variant = variant;
+    entry.hash = hash;
+    entry.size = body.size();
+    apply_headers(entry, headers, now_seconds());
+
+    for (uint64_t old : replaced) remove_unused_body(old);
+    evict(url, variant);
+    save_index();
+    return hash;
+}
+
+void HttpCache::refresh(const std::string& url, std::string_view requestHeaders, std::string_view headers) {
+    std::lock_guard<std::mutex> lock(mutex);
+    HttpCacheEntry* entry = find(url, requestHeaders);
+    if (!entry) return;
+    apply_headers(*entry, headers, now_seconds());
+    save_index();
+}
+
+void HttpCache::erase_url(const std::string& url) {
+    auto it = entries.find(url);
+    if (it == entries.end()) return;
+    std::vector<HttpCacheEntry> dropped = std::move(it->second);
+    entries.erase(it);
+    for (const HttpCacheEntry& entry : dropped) remove_unused_body(entry.hash);
+}
+
+void HttpCache::remove_unused_body(uint64_t hash) {
+    for (const auto& [url, variants] : entries) {
+        for (const HttpCacheEntry& entry : variants) {
+            if (entry.hash == hash) return;
+        }
+    }
+    std::remove(body_path(hash).c_str());
+}
+
+void HttpCache::evict(const std::string& keepUrl, uint64_t keepVariant) {
+    // Bodies are shared between entries, so each is counted once: size and users
+    std::unordered_map<uint64_t, std::pair<uint64_t, int>> bodies;
+    uint64_t total = 0;
+    for (const auto& [url, variants] : entries) {
+        for (const HttpCacheEntry& entry : variants) {
+            auto [body, added] = bodies.try_emplace(entry.hash, entry.size, 0);
+            if (added) total += entry.size;
+            body->second.second++;
+        }
+    }
+    if (total <= maxBytes) return;
+
+    struct Candidate {
+        int64_t lastUsed;
+        const std::string* url;
+        uint64_t variant;
+        uint64_t hash;
+    };
+    std::vector<Candidate> byAge;
+    for (const auto& [url, variants] : entries) {
+        for (const HttpCacheEntry& entry : variants) byAge.push_back({entry.lastUsed, &url, entry.variant, entry.hash});
+    }
+    std::sort(byAge.begin(), byAge.end(), [](const Candidate& a, const Candidate& b) { return a.lastUsed < b.lastUsed; });
+
+    // Oldest first until the bodies fit; a body goes once its last user does
+    std::unordered_map<std::string, std::vector<uint64_t>> evicted;
+    for (const Candidate& candidate : byAge) {
+        if (total <= maxBytes) break;
+        if (*candidate.url == keepUrl && candidate.variant == keepVariant) continue;
+        evicted[*candidate.url].push_back(candidate.variant);
+
+        auto& [size, users] = bodies[candidate.hash];
+        if (--users == 0) {
+            std::remove(body_path(candidate.hash).c_str());
+            total -= size;
+        }
+    }
+
+    for (const auto& [url, variants] : evicted) {
+        auto it = entries.find(url);
+        std::erase_if(it->second, [&](const HttpCacheEntry& e) {
+            return std::find(variants.begin(), variants.end(), e.variant) != variants.end();
+        });
+        if (it->second.empty()) entries.erase(it);
+    }
+}
+
+// The request's JSON headers object with the validators added as further fields
+std::string HttpCache::with_validators(const std::string& requestHeaders, const HttpCacheEntry& entry) {
+    auto append_json_string = [](std::string& out, std::string_view s) {
+        out += '"';
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) out += c;
+        }
+        out += '"';
+    };
+
+    std::string validators;
+    auto add = [&](std::string_view name, const std::string& value) {
+        if (value.empty()) return;
+        if (!validators.empty()) validators += ',';
+        append_json_string(validators, name);
+        validators += ':';
+        append_json_string(validators, value);
+    };
+    add("If-None-Match", entry.etag);
+    add("If-Modified-Since", entry.lastModified);
+    if (validators.empty()) return requestHeaders;
+
+    size_t close = requestHeaders.rfind('}');
+    if (close == std::string::npos) return "{" + validators + "}";
+    size_t last = requestHeaders.find_last_not_of(" \t\r\n", close - 1);
+    bool empty = last == std::string::npos || requestHeaders[last] == '{';
+    return requestHeaders.substr(0, close) + (empty ? "" : ",") + validators + requestHeaders.substr(close);
+}
+
+// Index line: url, vary, variant, etag, last-modified, storedAt, maxAge, hash, size, lastUsed
+void HttpCache::load_index() {
+    FILE* in = std::fopen((directory + "/index").c_str(), "r");
+    if (!in) return;
+
+    constexpr size_t kFields = 10;
+    std::string line;
+    char buffer[4096];
+    while (std::fgets(buffer, sizeof(buffer), in)) {
+        line += buffer;
+        if (line.empty() || line.back() != '\n') continue;
+        line.pop_back();
+
+        std::string_view fields[kFields];
+        std::string_view rest = line;
+        size_t count = 0;
+        for (; count < kFields && !rest.empty(); count++) {
+            size_t tab = rest.find('\t');
+            fields[count] = rest.substr(0, tab);
+            rest = (tab == std::string_view::npos) ? std::string_view{} : rest.substr(tab + 1);
+        }
+
+        if (count == kFields) {
+            HttpCacheEntry entry;
+            auto number = [](std::string_view s, auto& out, int base = 10) {
+                std::from_chars(s.data(), s.data() + s.size(), out, base);
+            };
+            entry.vary.assign(fields[1]);
+            number(fields[2], entry.variant, 16);
+            entry.etag.assign(fields[3]);
+            entry.lastModified.assign(fields[4]);
+            number(fields[5], entry.storedAt);
+            number(fields[6], entry.maxAge);
+            number(fields[7], entry.hash, 16);
+            number(fields[8], entry.size);
+            number(fields[9], entry.lastUsed);
+            entries[std::string(fields[0])].push_back(std::move(entry));
+        }
+        line.clear();
+    }
+    std::fclose(in);
+}
+
+void HttpCache::save_index() {
+    std::string path = directory + "/index";
+    std::string partial = path + ".part";
+    FILE* out = std::fopen(partial.c_str(), "w");
+    if (!out) return;
+
+    for (const auto& [url, variants] : entries) {
+        for (const HttpCacheEntry& entry : variants) {
+            // Validators come from response headers; drop any that would break the format
+            bool plain = entry.etag.find_first_of("\t\n") == std::string::npos &&
+                         entry.lastModified.find_first_of("\t\n") == std::string::npos;
+            std::fprintf(out, "%s\t%s\t%" PRIx64 "\t%s\t%s\t%" PRId64 "\t%" PRId64 "\t%" PRIx64 "\t%" PRIu64 "\t%" PRId64 "\n",
+                         url.c_str(), entry.vary.c_str(), entry.variant, plain ? entry.etag.c_str() : "",
+                         plain ? entry.lastModified.c_str() : "", entry.storedAt, entry.maxAge, entry.hash,
+                         entry.size, entry.lastUsed);
+        }
+    }
+
+    if (std::fclose(out) == 0) {
+        std::rename(partial.c_str(), path.c_str());
+    } else {
+        std::remove(partial.c_str());
+    }
+}
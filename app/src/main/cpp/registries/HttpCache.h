@@ -0,0 +1,81 @@
+#ifndef MIST_HTTPCACHE_H
+#define MIST_HTTPCACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct HttpCacheEntry {
+    std::string vary;      // request header names the response varies on, lowercase, sorted, comma separated
+    uint64_t variant = 0;  // hash of the request's values for those names, see HttpCache
+    std::string etag;
+    std::string lastModified;
+    int64_t storedAt = 0;  // unix seconds of the last 200 or 304
+    int64_t maxAge = -1;   // Cache-Control max-age, -1: revalidate on every use
+    uint64_t hash = 0;     // body file, see HttpCache
+    uint64_t size = 0;
+    int64_t lastUsed = 0;
+};
+
+// On-disk cache for GET responses.
+//
+// An entry is keyed by URL plus the request headers that select the response:
+// the ones its Vary header names, and always Authorization, so one user's
+// responses are never served for another's credentials. A URL can hold one
+// entry per combination of those header values. Vary: * and no-store are not
+// cached, and no-store drops what was cached for the URL.
+//
+// Bodies are content addressed: each is stored once in a file named after its
+// hash, however many entries return it. An index file next to them maps each
+// entry to its body and validators (ETag, Last-Modified) and to its
+// Cache-Control freshness. The least recently used entries are evicted once the
+// bodies exceed maxBytes.
+//
+// Request headers are the JSON object Droplet code passes. Thread safe: the VM
+// thread looks entries up, HTTP workers store responses.
+class HttpCache {
+public:
+    explicit HttpCache(std::string directory, uint64_t maxBytes = 32ull * 1024 * 1024);
+
+    std::optional<HttpCacheEntry> lookup(const std::string& url, std::string_view requestHeaders);
+
+    // False if the body file has gone missing (the entry is dropped)
+    bool read_body(const HttpCacheEntry& entry, std::string& out);
+
+    // Records a 200 response unless its Cache-Control says no-store or it varies
+    // on "*". `headers` is the response's "Name: value" lines. Returns the body's
+    // hash either way.
+    uint64_t store(const std::string& url, std::string_view requestHeaders, std::string_view body,
+                   std::string_view headers);
+
+    // A 304 for a cached request: its body is current again
+    void refresh(const std::string& url, std::string_view requestHeaders, std::string_view headers);
+
+    static bool fresh(const HttpCacheEntry& entry, int64_t now);
+    static uint64_t hash_body(std::string_view body);
+
+    // The request's JSON headers object plus If-None-Match/If-Modified-Since for `entry`
+    static std::string with_validators(const std::string& requestHeaders, const HttpCacheEntry& entry);
+
+private:
+    std::string body_path(uint64_t hash) const;
+    void apply_headers(HttpCacheEntry& entry, std::string_view headers, int64_t now) const;
+    HttpCacheEntry* find(const std::string& url, std::string_view requestHeaders);  // mutex held
+    void erase_url(const std::string& url);   // mutex held
+    void remove_unused_body(uint64_t hash);   // mutex held
+    void load_index();
+    void save_index();                        // mutex held
+    void evict(const std::string& keepUrl, uint64_t keepVariant);  // mutex held, never drops that entry
+
+    std::string directory;
+    uint64_t maxBytes;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<HttpCacheEntry>> entries;  // per URL, one per variant
+};
+
+#endif //MIST_HTTPCACHE_H
@@ -0,0 +1,281 @@
+#include "HttpClient.h"
+
+#include <algorithm>
+#include <charconv>
+
+// Largest Content-Length reserved up front; a bigger body still grows as it arrives
+constexpr size_t kMaxReservedBody = 256u << 20;
+
+void HttpCall::set_response_headers(std::string headers) {
+    responseHeaders = std::move(headers);
+    decoder = HttpDecoder::for_encoding(http_header(responseHeaders, "Content-Encoding"));
+
+    // An unencoded body collected whole arrives in one allocation, without the
+    // doubling copies (and twice-the-body peak) of growing as it streams in
+    if (decoder || request.stream) return;
+    std::string_view length = http_header(responseHeaders, "Content-Length");
+    size_t bytes = 0;
+    auto [ptr, ec] = std::from_chars(length.data(), length.data() + length.size(), bytes);
+    if (ec == std::errc() && ptr == length.data() + length.size() && bytes <= kMaxReservedBody) {
+        response.reserve(bytes);
+    }
+}
+
+bool HttpCall::append(const char* data, size_t size) {
+    if (cancelled.load(std::memory_order_relaxed)) return false;
+    if (!decoder) return deliver({data, size});
+
+    decoded.clear();
+    if (!decoder->decode({data, size}, decoded)) {
+        corrupt = true;
+        return false;
+    }
+    return decoded.empty() || deliver(decoded);
+}
+
+bool HttpCall::deliver(std::string_view data) {
+    // An error body is kept as the response even for a streaming request
+    if (request.stream && statusCode >= 200 && statusCode <= 299) return request.stream(*this, data);
+    response.append(data);
+    return true;
+}
+
+void HttpCall::end_body() {
+    if (!decoder || cancelled.load() || statusCode == 0) return;
+    if (corrupt || decoder->truncated()) {
+        statusCode = 0;
+        response = corrupt ? "Error: undecodable response body" : "Error: compressed response body ended early";
+    }
+    decoder.reset();
+    decoded = std::string();
+}
+
+std::string_view http_header(std::string_view headers, std::string_view name) {
+    auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; };
+
+    while (!headers.empty()) {
+        size_t end = headers.find('\n');
+        std::string_view line = headers.substr(0, end);
+        headers = (end == std::string_view::npos) ? std::string_view{} : headers.substr(end + 1);
+
+        size_t colon = line.find(':');
+        if (colon != name.size()) continue;
+        if (!std::equal(name.begin(), name.end(), line.begin(),
+                        [&](char a, char b) { return lower(a) == lower(b); })) continue;
+
+        std::string_view value = line.substr(colon + 1);
+        size_t start = value.find_first_not_of(" \t");
+        if (start == std::string_view::npos) return {};
+        size_t last = value.find_last_not_of(" \t\r");
+        return value.substr(start, last - start + 1);
+    }
+    return {};
+}
+
+HttpClient::HttpClient(HttpTransport transport, HttpCompletion completion, HttpClientConfig config)
+        : transport(transport), completion(completion), config(config) {
+    int count = std::max(1, config.workers);
+    workers.reserve(count);
+    for (int i = 0; i < count; i++) {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+HttpClient::~HttpClient() {
+    std::vector<std::shared_ptr<HttpCall>> inFlight;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+        for (auto& [id, call] : calls) call->cancelled.store(true);
+        for (auto& call : running) call->cancelled.store(true);
+        inFlight = running;
+    }
+    cv.notify_all();
+
+    // Outside the lock: the transport's abort may call into Java
+    if (config.abort) {
+        for (auto& call : inFlight) config.abort(*call);
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+std::string HttpClient::host_of(const std::string& url) {
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of("/?#", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+// Requests that may share one call, keyed by everything that makes them identical
+static std::string coalescing_key(const HttpRequest& request) {
+    const std::string& m = request.method;
+    if (request.stream) return {};
+    if (m != "GET" && m != "HEAD" && m != "PUT" && m != "DELETE") return {};
+
+    std::string key = m;
+    key += '\n';
+    key += request.url;
+    key += '\n';
+    key += request.headers;
+    key += '\n';
+    key += std::to_string(std::hash<std::string>{}(request.body));
+    key += '\n';
+    key += std::to_string(request.revalidates);
+    return key;
+}
+
+void HttpClient::submit(HttpRequestId id, HttpRequest request) {
+    std::string key = config.coalesce ? coalescing_key(request) : std::string();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+
+        if (!key.empty()) {
+            auto shared = byKey.find(key);
+            if (shared != byKey.end()) {
+                shared->second->waiters.push_back(id);
+                calls[id] = shared->second;
+                return;
+            }
+        }
+
+        auto call = std::make_shared<HttpCall>();
+        call->id = id;
+        call->host = host_of(request.url);
+        call->request = std::move(request);
+        call->waiters.push_back(id);
+        if (!key.empty()) {
+            call->key = std::move(key);
+            byKey[call->key] = call;
+        }
+
+        calls[id] = call;
+        queue.push_back(std::move(call));
+    }
+    cv.notify_one();
+}
+
+// The queue holds exactly the calls not yet started that still have a waiter
+bool HttpClient::join(HttpRequestId call, HttpRequestId id, const std::function<void(HttpRequest&)>& amend) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(queue.begin(), queue.end(), [call](const auto& queued) { return queued->id == call; });
+    if (it == queue.end()) return false;
+
+    amend((*it)->request);
+    (*it)->waiters.push_back(id);
+    calls[id] = *it;
+    return true;
+}
+
+bool HttpClient::queued(HttpRequestId call) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::any_of(queue.begin(), queue.end(), [call](const auto& queued) { return queued->id == call; });
+}
+
+bool HttpClient::cancel(HttpRequestId id) {
+    std::shared_ptr<HttpCall> call;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = calls.find(id);
+        if (it == calls.end()) return false;
+
+        call = it->second;
+        calls.erase(it);
+
+        // Positions are kept: a batch's waiters line up with its queries
+        std::replace(call->waiters.begin(), call->waiters.end(), id, kCancelledWaiter);
+        bool answered = std::any_of(call->waiters.begin(), call->waiters.end(),
+                                    [](HttpRequestId waiter) { return waiter != kCancelledWaiter; });
+        if (answered) return true;
+
+        call->cancelled.store(true);
+        auto shared = byKey.find(call->key);
+        if (shared != byKey.end() && shared->second == call) byKey.erase(shared);
+        auto queued = std::find(queue.begin(), queue.end(), call);
+        if (queued != queue.end()) queue.erase(queued);
+        if (!call->started || !config.abort) return true;
+    }
+
+    // Running: free its worker now rather than when the response would have ended
+    config.abort(*call);
+    return true;
+}
+
+// First queued call that is due and whose host is below its in-flight limit,
+// preferring one for `preferHost` (the host the worker just finished with).
+// `wake` is set to the earliest time a call held back by notBefore becomes due.
+std::shared_ptr<HttpCall> HttpClient::take_runnable(const std::string& preferHost, Clock::time_point& wake) {
+    Clock::time_point now = Clock::now();
+    wake = Clock::time_point::max();
+
+    auto chosen = queue.end();
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        Clock::time_point due = (*it)->request.notBefore;
+        if (due > now) {
+            wake = std::min(wake, due);
+            continue;
+        }
+
+        auto active = activePerHost.find((*it)->host);
+        if (active != activePerHost.end() && active->second >= config.maxPerHost) continue;
+        if (chosen == queue.end()) chosen = it;
+        if (preferHost.empty() || (*it)->host == preferHost) {
+            chosen = it;
+            break;
+        }
+    }
+    if (chosen == queue.end()) return nullptr;
+
+    std::shared_ptr<HttpCall> call = std::move(*chosen);
+    queue.erase(chosen);
+    activePerHost[call->host]++;
+    call->started = true;
+    running.push_back(call);
+    return call;
+}
+
+void HttpClient::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::string lastHost;
+    while (true) {
+        std::shared_ptr<HttpCall> call;
+        Clock::time_point wake;
+        while (!stopping && !(call = take_runnable(lastHost, wake))) {
+            if (wake == Clock::time_point::max()) {
+                cv.wait(lock);
+            } else {
+                cv.wait_until(lock, wake);
+            }
+        }
+        if (!call) return;
+
+        lock.unlock();
+        transport(*call);
+        call->end_body();
+        if (call->request.stream && !call->cancelled.load()) call->request.stream(*call, {});
+        lock.lock();
+        running.erase(std::find(running.begin(), running.end(), call));
+
+        // Identical requests from here on need a fresh response
+        auto shared = byKey.find(call->key);
+        if (shared != byKey.end() && shared->second == call) byKey.erase(shared);
+
+        std::vector<HttpRequestId> waiters = std::move(call->waiters);
+        for (HttpRequestId waiter : waiters) {
+            if (waiter != kCancelledWaiter) calls.erase(waiter);
+        }
+        bool cancelled = call->cancelled.load();
+
+        lock.unlock();
+        if (!cancelled) completion(*call, waiters);
+        lock.lock();
+
+        if (--activePerHost[call->host] == 0) activePerHost.erase(call->host);
+        lastHost = call->host;
+
+        // A slot for this host opened up
+        cv.notify_all();
+    }
+}
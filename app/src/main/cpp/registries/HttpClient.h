@@ -0,0 +1,169 @@
+#ifndef MIST_HTTPCLIENT_H
+#define MIST_HTTPCLIENT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "HttpDecoder.h"
+
+using HttpRequestId = int32_t;
+
+struct HttpCall;
+
+// Slot of a waiter that cancelled, see HttpCall::waiters
+constexpr HttpRequestId kCancelledWaiter = -1;
+
+struct HttpRequest {
+    std::string method;
+    std::string url;
+    std::string body;
+    std::string headers;  // JSON object, as passed by Droplet code
+    uint64_t revalidates = 0;  // HttpCache hash of a cached body already delivered, 0 if none
+    bool batch = false;        // body is a JSON array of queries, one per waiter, see HttpClient::join
+    std::chrono::steady_clock::time_point notBefore{};  // stays queued until then
+
+    // Set for a streaming request: a successful body is handed over here chunk by
+    // chunk on the worker thread instead of collecting in HttpCall::response, and
+    // returning false aborts the transfer. Called once more with an empty chunk
+    // after the transport returns, before the completion handler. Never coalesced.
+    std::function<bool(HttpCall& call, std::string_view chunk)> stream = nullptr;
+};
+
+// One request as seen by the transport and the completion handler
+struct HttpCall {
+    HttpRequestId id = 0;  // the first waiter, identifies the call to the transport
+    HttpRequest request;
+    std::string host;
+
+    // Guarded by the client's mutex
+    std::string key;                      // coalescing key, empty if the call is not shared
+    std::vector<HttpRequestId> waiters;   // every request id answered by this call
+    bool started = false;                 // taken by a worker, no longer joinable
+
+    int statusCode = 0;   // 0 = transport failure, response holds the error text; set before the body arrives
+    std::string response;
+    std::string responseHeaders;  // "Name: value" lines
+    std::unique_ptr<HttpDecoder> decoder;  // from Content-Encoding; bodies reach append() still encoded
+
+    std::atomic<bool> cancelled{false};
+
+    // Transport: the response headers, before any body bytes
+    void set_response_headers(std::string headers);
+
+    // Transport sink for body bytes; false tells the transport to abort
+    bool append(const char* data, size_t size);
+
+    // After the transport returns: a body that did not decode fails the call
+    void end_body();
+
+private:
+    bool deliver(std::string_view data);
+
+    std::string decoded;   // append() scratch
+    bool corrupt = false;
+};
+
+// Value of the first `name` header in "Name: value" lines, matched case-insensitively;
+// empty if absent
+std::string_view http_header(std::string_view headers, std::string_view name);
+
+// Performs the call synchronously on a worker thread: streams the body through
+// call.append() and fills call.statusCode.
+using HttpTransport = void (*)(HttpCall& call);
+
+// Runs on the worker thread once a call finishes without being cancelled. `waiters`
+// are the request ids to answer, in the order they joined; cancelled ones are
+// kCancelledWaiter so positions still match a batch's queries.
+using HttpCompletion = void (*)(HttpCall& call, const std::vector<HttpRequestId>& waiters);
+
+// Makes the transport give up on a call it is executing (close its connection),
+// so a worker blocked in connect or read returns. Called from the cancelling
+// thread, possibly before the transport has opened the connection: the
+// transport checks call.cancelled once it has. It should not block; the
+// destructor calls it on whatever thread tears the client down (the UI thread
+// on Android), so a slow close belongs on the transport's own thread.
+using HttpAbort = void (*)(HttpCall& call);
+
+struct HttpClientConfig {
+    int workers = 4;
+    int maxPerHost = 2;     // keeps reuse on the transport's keep-alive connections
+    bool coalesce = true;   // identical idempotent requests share one call
+    HttpAbort abort = nullptr;  // without one, cancelling a running call waits for the transport
+};
+
+// Bounded HTTP dispatcher behind the android_http_* natives: a fixed worker pool
+// pulling from one FIFO, at most maxPerHost requests in flight per host, and
+// cancellation by request id. Destruction aborts the calls in flight, so it
+// returns without waiting out the transport's timeouts.
+//
+// A worker that finishes a call takes the next queued call for the same host
+// first, so a host's requests go out back to back over the connection the
+// transport just released. Requests are not pipelined on one connection:
+// HttpURLConnection cannot, and a slow response would hold up the ones behind it.
+//
+// A GET, HEAD, PUT or DELETE identical to one still queued or in flight (method,
+// URL, headers and body hash) joins that call instead of making its own, and the
+// response fans out to every waiter. POST is never coalesced: two submissions are
+// two submissions.
+class HttpClient {
+public:
+    HttpClient(HttpTransport transport, HttpCompletion completion, HttpClientConfig config = {});
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    void submit(HttpRequestId id, HttpRequest request);
+
+    // Adds `id` as a waiter on the call first submitted as `call` (HttpCall::id) if
+    // it is still queued, letting `amend` extend its request (e.g. append a query
+    // to a batch). The call stays joinable while any of its waiters remains, even
+    // if `call` itself was cancelled. False once it has been taken by a worker,
+    // dropped or completed.
+    bool join(HttpRequestId call, HttpRequestId id, const std::function<void(HttpRequest&)>& amend);
+
+    // Whether join() on `call` could still succeed
+    bool queued(HttpRequestId call) const;
+
+    // Drops the request's callback from its call; the call itself is dropped from
+    // the queue, or aborted in flight, once no waiter is left.
+    // Returns false if the id is unknown (already completed or never submitted).
+    bool cancel(HttpRequestId id);
+
+    static std::string host_of(const std::string& url);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void worker_loop();
+    // mutex held
+    std::shared_ptr<HttpCall> take_runnable(const std::string& preferHost, Clock::time_point& wake);
+
+    HttpTransport transport;
+    HttpCompletion completion;
+    HttpClientConfig config;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    std::deque<std::shared_ptr<HttpCall>> queue;
+    std::unordered_map<HttpRequestId, std::shared_ptr<HttpCall>> calls;  // every waiter, queued + in flight
+    std::unordered_map<std::string, std::shared_ptr<HttpCall>> byKey;    // coalescable calls
+    std::unordered_map<std::string, int> activePerHost;
+    std::vector<std::shared_ptr<HttpCall>> running;  // taken by a worker, transport not yet returned
+
+    std::vector<std::thread> workers;
+};
+
+#endif //MIST_HTTPCLIENT_H
@@ -0,0 +1,100 @@
+#include "HttpDecoder.h"
+
+#include <algorithm>
+
+// zlib window bits: 15 plus 32 detects a gzip or zlib header, negative means raw deflate
+static constexpr int kAutoHeader = 15 + 32;
+static constexpr int kRawDeflate = -15;
+
+static bool encoding_is(std::string_view value, std::string_view name) {
+    size_t start = value.find_first_not_of(" \t");
+    size_t end = value.find_last_not_of(" \t");
+    if (start == std::string_view::npos || end - start + 1 != name.size()) return false;
+    for (size_t i = 0; i < name.size(); i++) {
+        char c = value[start + i];
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (c != name[i]) return false;
+    }
+    return true;
+}
+
+std::unique_ptr<HttpDecoder> HttpDecoder::for_encoding(std::string_view contentEncoding) {
+    if (encoding_is(contentEncoding, "gzip") || encoding_is(contentEncoding, "x-gzip")) {
+        return std::unique_ptr<HttpDecoder>(new HttpDecoder(false));
+    }
+    if (encoding_is(contentEncoding, "deflate")) {
+        return std::unique_ptr<HttpDecoder>(new HttpDecoder(true));
+    }
+    return nullptr;
+}
+
+HttpDecoder::HttpDecoder(bool deflate) : rawFallback(deflate) {
+    reset(kAutoHeader);
+}
+
+HttpDecoder::~HttpDecoder() {
+    if (ready) inflateEnd(&zs);
+}
+
+bool HttpDecoder::reset(int windowBits) {
+    if (ready) inflateEnd(&zs);
+    zs = z_stream{};
+    ready = inflateInit2(&zs, windowBits) == Z_OK;
+    return ready;
+}
+
+bool HttpDecoder::decode(std::string_view input, std::string& out) {
+    if (!ready) return false;
+    fed = fed || !input.empty();
+    if (rawFallback) held.append(input);
+
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in = static_cast<uInt>(input.size());
+
+    // Until the input is used up and inflate had room to write all it holds
+    bool full = false;
+    while (zs.avail_in > 0 || (full && !ended)) {
+        // Another gzip member follows the one that ended
+        if (ended) {
+            if (inflateReset(&zs) != Z_OK) return false;
+            ended = false;
+        }
+
+        // Decode straight into the output's spare capacity
+        size_t used = out.size();
+        out.resize(used + std::max<size_t>(zs.avail_in * 4, 16 * 1024));
+        zs.next_out = reinterpret_cast<Bytef*>(out.data() + used);
+        zs.avail_out = static_cast<uInt>(out.size() - used);
+
+        uInt availIn = zs.avail_in;
+        int rc = inflate(&zs, Z_NO_FLUSH);
+        full = zs.avail_out == 0;
+        out.resize(out.size() - zs.avail_out);
+
+        if (rc == Z_DATA_ERROR && rawFallback && zs.total_out == 0) {
+            // "deflate" without the zlib wrapper: start over on everything so far as raw
+            rawFallback = false;
+            if (!reset(kRawDeflate)) return false;
+            zs.next_in = reinterpret_cast<Bytef*>(held.data());
+            zs.avail_in = static_cast<uInt>(held.size());
+            full = false;
+            continue;
+        }
+        if (rc == Z_STREAM_END) {
+            ended = true;
+        } else if (rc == Z_BUF_ERROR && zs.avail_in == availIn && !full) {
+            // No progress possible: the rest comes with the next chunk
+            break;
+        } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            return false;
+        }
+        rawFallback = rawFallback && zs.total_out == 0;
+    }
+
+    // Decided once output appears: zlib wrapped after all, or already raw
+    if (!rawFallback && !held.empty()) {
+        held.clear();
+        held.shrink_to_fit();
+    }
+    return true;
+}
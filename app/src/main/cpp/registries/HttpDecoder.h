@@ -0,0 +1,45 @@
+#ifndef MIST_HTTPDECODER_H
+#define MIST_HTTPDECODER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <zlib.h>
+
+// Streaming Content-Encoding decoder for response bodies: gzip and deflate via
+// zlib, fed the transport's chunks as they arrive. "deflate" is accepted both as
+// specified (zlib wrapped) and as the raw stream some servers send instead.
+// brotli and zstd are not in the NDK, so only gzip and deflate are advertised.
+class HttpDecoder {
+public:
+    // The encodings MainActivity asks for, as an Accept-Encoding value
+    static constexpr const char* kAcceptEncoding = "gzip, deflate";
+
+    // Decoder for a Content-Encoding header value; nullptr for identity or an
+    // encoding that was not asked for (the body is passed through as is)
+    static std::unique_ptr<HttpDecoder> for_encoding(std::string_view contentEncoding);
+
+    ~HttpDecoder();
+
+    HttpDecoder(const HttpDecoder&) = delete;
+    HttpDecoder& operator=(const HttpDecoder&) = delete;
+
+    // Appends what `input` decodes to to `out`. False on corrupt input.
+    bool decode(std::string_view input, std::string& out);
+
+    // Input arrived but the compressed stream never reached its end
+    bool truncated() const { return fed && !ended; }
+
+private:
+    explicit HttpDecoder(bool deflate);
+    bool reset(int windowBits);
+
+    z_stream zs{};
+    bool ready = false;
+    bool rawFallback;   // deflate: retry as a raw stream if the zlib header is missing
+    std::string held;   // input kept for that retry until the first output
+    bool fed = false;
+    bool ended = false;
+};
+
+#endif //MIST_HTTPDECODER_H
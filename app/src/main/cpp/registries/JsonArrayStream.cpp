@@ -0,0 +1,128 @@
+#include "JsonArrayStream.h"
+
+static constexpr uint32_t kMaxDepth = 512;
+
+static bool is_ws(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool JsonArrayStream::fail() {
+    state = State::Failed;
+    current.clear();
+    current.shrink_to_fit();
+    return false;
+}
+
+bool JsonArrayStream::feed(std::string_view data, std::vector<std::string>& out) {
+    size_t n = data.size();
+    size_t i = 0;
+    size_t from = 0;  // where the current element starts in `data` (Element state)
+
+    auto complete = [&](size_t end) {
+        current.append(data.data() + from, end - from);
+        if (current.size() > maxElementBytes) return false;
+        out.push_back(std::move(current));
+        current.clear();
+        elements++;
+        state = State::After;
+        return true;
+    };
+
+    while (i < n) {
+        char c = data[i];
+        switch (state) {
+            case State::Start:
+                if (c == '[') {
+                    state = State::Open;
+                } else if (!is_ws(c)) {
+                    return fail();
+                }
+                i++;
+                break;
+
+            case State::Open:
+            case State::Next:
+                if (is_ws(c)) {
+                    i++;
+                    break;
+                }
+                if (c == ']' && state == State::Open) {
+                    state = State::Done;
+                    i++;
+                    break;
+                }
+                if (c == ']' || c == ',') return fail();
+
+                state = State::Element;
+                from = i;
+                depth = (c == '[' || c == '{') ? 1 : 0;
+                inString = c == '"';
+                escape = false;
+                scalar = !inString && depth == 0;
+                i++;
+                break;
+
+            case State::Element:
+                if (inString) {
+                    if (escape) {
+                        escape = false;
+                        i++;
+                        break;
+                    }
+                    // Plain string bytes in one go
+                    while (i < n && data[i] != '"' && data[i] != '\\') i++;
+                    if (i == n) break;
+                    if (data[i] == '\\') {
+                        escape = true;
+                    } else {
+                        inString = false;
+                        if (depth == 0 && !complete(i + 1)) return fail();
+                    }
+                    i++;
+                } else if (scalar) {
+                    if (is_ws(c) || c == ',' || c == ']') {
+                        // The delimiter is read again in After
+                        if (!complete(i)) return fail();
+                    } else {
+                        i++;
+                    }
+                } else {
+                    if (c == '"') {
+                        inString = true;
+                    } else if (c == '[' || c == '{') {
+                        if (++depth > kMaxDepth) return fail();
+                    } else if (c == ']' || c == '}') {
+                        if (--depth == 0 && !complete(i + 1)) return fail();
+                    }
+                    i++;
+                }
+                break;
+
+            case State::After:
+                if (c == ',') {
+                    state = State::Next;
+                } else if (c == ']') {
+                    state = State::Done;
+                } else if (!is_ws(c)) {
+                    return fail();
+                }
+                i++;
+                break;
+
+            case State::Done:
+                if (!is_ws(c)) return fail();
+                i++;
+                break;
+
+            case State::Failed:
+                return false;
+        }
+    }
+
+    // Carry the unfinished element over to the next chunk
+    if (state == State::Element) {
+        current.append(data.data() + from, n - from);
+        if (current.size() > maxElementBytes) return fail();
+    }
+    return state != State::Failed;
+}
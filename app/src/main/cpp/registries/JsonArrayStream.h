@@ -0,0 +1,54 @@
+#ifndef MIST_JSONARRAYSTREAM_H
+#define MIST_JSONARRAYSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Splits a JSON array into its elements as the text arrives in arbitrary chunks.
+// Only the element being read is buffered, so memory is bounded by the largest
+// element rather than the whole document.
+//
+// Elements are delimited (strings, escapes and bracket nesting are tracked) but
+// not validated; each is handed out as its JSON text for JsonDocument to parse.
+class JsonArrayStream {
+public:
+    explicit JsonArrayStream(size_t maxElementBytes = 16 * 1024 * 1024) : maxElementBytes(maxElementBytes) {}
+
+    // Appends every element completed by `data` to `out`. False once the text is
+    // not a JSON array or an element outgrows maxElementBytes; the stream then
+    // stays failed.
+    bool feed(std::string_view data, std::vector<std::string>& out);
+
+    // The closing bracket has been seen
+    bool finished() const { return state == State::Done; }
+    bool failed() const { return state == State::Failed; }
+
+    size_t count() const { return elements; }
+
+private:
+    enum class State : uint8_t {
+        Start,    // before '['
+        Open,     // after '[': an element or ']'
+        Next,     // after ',': an element
+        Element,  // inside an element
+        After,    // after an element: ',' or ']'
+        Done,
+        Failed
+    };
+
+    bool fail();
+
+    State state = State::Start;
+    std::string current;  // bytes of the element being read, from earlier chunks
+    uint32_t depth = 0;
+    bool inString = false;
+    bool escape = false;
+    bool scalar = false;  // number, true, false or null: ends at the next delimiter
+    size_t elements = 0;
+    size_t maxElementBytes;
+};
+
+#endif //MIST_JSONARRAYSTREAM_H
@@ -0,0 +1,319 @@
+#include "JsonDocument.h"
+
+#include <array>
+#include <charconv>
+
+static constexpr int kMaxDepth = 512;
+
+bool JsonDocument::parse(std::string input) {
+    text = std::move(input);
+    nodes.clear();
+    elementIndex.clear();
+
+    if (text.size() >= npos) return false;
+
+    uint32_t pos = 0;
+    skip_ws(pos);
+    bool ok = parse_value(pos, 0);
+    skip_ws(pos);
+
+    if (!ok || pos != text.size()) {
+        nodes.clear();
+        elementIndex.clear();
+        return false;
+    }
+    return true;
+}
+
+void JsonDocument::skip_ws(uint32_t& pos) const {
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+        pos++;
+    }
+}
+
+static bool is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Bytes that end a run of plain string content: the quote, backslash and the
+// control characters JSON requires to be escaped
+static constexpr auto kStringSpecial = [] {
+    std::array<bool, 256> special{};
+    for (int c = 0; c < 0x20; c++) special[c] = true;
+    special['"'] = true;
+    special['\\'] = true;
+    return special;
+}();
+
+bool JsonDocument::parse_string(uint32_t& pos) {
+    // pos is on the opening quote
+    uint32_t start = ++pos;
+    bool escaped = false;
+    auto size = static_cast<uint32_t>(text.size());
+    const char* data = text.data();
+
+    while (true) {
+        // Skip plain content in bulk; what stops it is a quote, backslash or control
+        while (pos < size && !kStringSpecial[static_cast<unsigned char>(data[pos])]) pos++;
+        if (pos >= size) return false;
+
+        auto c = static_cast<unsigned char>(data[pos]);
+        if (c == '"') {
+            Node node{Kind::String};
+            node.escaped = escaped;
+            node.start = start;
+            node.length = pos - start;
+            node.end = static_cast<uint32_t>(nodes.size()) + 1;
+            nodes.push_back(node);
+            pos++;
+            return true;
+        }
+        // Control characters must be escaped
+        if (c != '\\') return false;
+
+        escaped = true;
+        if (++pos >= size) return false;
+        switch (text[pos]) {
+            case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                pos++;
+                break;
+            case 'u':
+                if (size - pos < 5) return false;
+                for (uint32_t i = 1; i <= 4; i++) {
+                    if (!is_hex(text[pos + i])) return false;
+                }
+                pos += 5;
+                break;
+            default:
+                return false;
+        }
+    }
+}
+
+// -? (0 | [1-9][0-9]*) (.[0-9]+)? ([eE][+-]?[0-9]+)?
+bool JsonDocument::parse_number(uint32_t& pos) const {
+    auto size = static_cast<uint32_t>(text.size());
+    auto digits = [&] {
+        uint32_t from = pos;
+        while (pos < size && is_digit(text[pos])) pos++;
+        return pos > from;
+    };
+
+    if (pos < size && text[pos] == '-') pos++;
+    if (pos < size && text[pos] == '0') {
+        pos++;
+    } else if (!digits()) {
+        return false;
+    }
+    if (pos < size && text[pos] == '.') {
+        pos++;
+        if (!digits()) return false;
+    }
+    if (pos < size && (text[pos] == 'e' || text[pos] == 'E')) {
+        pos++;
+        if (pos < size && (text[pos] == '+' || text[pos] == '-')) pos++;
+        if (!digits()) return false;
+    }
+    return true;
+}
+
+bool JsonDocument::parse_value(uint32_t& pos, int depth) {
+    if (pos >= text.size() || depth > kMaxDepth) return false;
+
+    char c = text[pos];
+    if (c == '"') return parse_string(pos);
+
+    if (c == '{' || c == '[') {
+        bool isObject = c == '{';
+        char close = isObject ? '}' : ']';
+        uint32_t self = static_cast<uint32_t>(nodes.size());
+        Node node{isObject ? Kind::Object : Kind::Array};
+        node.start = pos;
+        nodes.push_back(node);
+
+        pos++;
+        skip_ws(pos);
+        uint32_t count = 0;
+
+        if (pos < text.size() && text[pos] == close) {
+            pos++;
+        } else {
+            while (true) {
+                if (isObject) {
+                    if (pos >= text.size() || text[pos] != '"' || !parse_string(pos)) return false;
+                    skip_ws(pos);
+                    if (pos >= text.size() || text[pos] != ':') return false;
+                    pos++;
+                    skip_ws(pos);
+                }
+                if (!parse_value(pos, depth + 1)) return false;
+                count++;
+                skip_ws(pos);
+
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') {
+                    pos++;
+                    skip_ws(pos);
+                    continue;
+                }
+                if (text[pos] != close) return false;
+                pos++;
+                break;
+            }
+        }
+
+        Node& done = nodes[self];
+        done.length = pos - done.start;
+        done.end = static_cast<uint32_t>(nodes.size());
+        done.count = count;
+
+        if (!isObject) {
+            done.elements = static_cast<uint32_t>(elementIndex.size());
+            for (uint32_t child = self + 1; child < done.end; child = nodes[child].end) {
+                elementIndex.push_back(child);
+            }
+        }
+        return true;
+    }
+
+    Node node{Kind::Number};
+    node.start = pos;
+    if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 4, "null") == 0) {
+        node.kind = c == 't' ? Kind::Bool : Kind::Null;
+        pos += 4;
+    } else if (text.compare(pos, 5, "false") == 0) {
+        node.kind = Kind::Bool;
+        pos += 5;
+    } else if (!parse_number(pos)) {
+        return false;
+    }
+    node.length = pos - node.start;
+    node.end = static_cast<uint32_t>(nodes.size()) + 1;
+    nodes.push_back(node);
+    return true;
+}
+
+uint32_t JsonDocument::size(uint32_t node) const {
+    if (node >= nodes.size()) return 0;
+    const Node& n = nodes[node];
+    return (n.kind == Kind::Array || n.kind == Kind::Object) ? n.count : 0;
+}
+
+uint32_t JsonDocument::at(uint32_t array, uint32_t index) const {
+    if (array >= nodes.size()) return npos;
+    const Node& n = nodes[array];
+    if (n.kind != Kind::Array || index >= n.count) return npos;
+    return elementIndex[n.elements + index];
+}
+
+uint32_t JsonDocument::field(uint32_t object, std::string_view key) const {
+    if (object >= nodes.size() || nodes[object].kind != Kind::Object) return npos;
+
+    uint32_t end = nodes[object].end;
+    for (uint32_t k = object + 1; k < end;) {
+        uint32_t v = k + 1;
+        const Node& keyNode = nodes[k];
+        if (!keyNode.escaped) {
+            if (std::string_view(text).substr(keyNode.start, keyNode.length) == key) return v;
+        } else if (value(k) == key) {
+            return v;
+        }
+        k = nodes[v].end;
+    }
+    return npos;
+}
+
+uint32_t JsonDocument::find(std::string_view path) const {
+    uint32_t node = root();
+    while (node != npos && !path.empty()) {
+        size_t dot = path.find('.');
+        std::string_view segment = path.substr(0, dot);
+        path = (dot == std::string_view::npos) ? std::string_view{} : path.substr(dot + 1);
+
+        if (nodes[node].kind == Kind::Array) {
+            uint32_t index = 0;
+            auto [ptr, ec] = std::from_chars(segment.data(), segment.data() + segment.size(), index);
+            if (ec != std::errc() || ptr != segment.data() + segment.size()) return npos;
+            node = at(node, index);
+        } else {
+            node = field(node, segment);
+        }
+    }
+    return node;
+}
+
+static void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// U+FFFD if the four characters at i are not hex digits
+static uint32_t read_hex4(std::string_view s, size_t i) {
+    uint32_t v = 0;
+    if (i + 4 > s.size()) return 0xFFFD;
+    auto [ptr, ec] = std::from_chars(s.data() + i, s.data() + i + 4, v, 16);
+    if (ec != std::errc() || ptr != s.data() + i + 4) return 0xFFFD;
+    return v;
+}
+
+std::string JsonDocument::value(uint32_t node) const {
+    if (node >= nodes.size()) return "";
+    const Node& n = nodes[node];
+    std::string_view raw = std::string_view(text).substr(n.start, n.length);
+
+    if (n.kind != Kind::String || !n.escaped) return std::string(raw);
+
+    std::string out;
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); i++) {
+        char c = raw[i];
+        if (c != '\\' || i + 1 >= raw.size()) {
+            out += c;
+            continue;
+        }
+        char e = raw[++i];
+        switch (e) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                uint32_t cp = read_hex4(raw, i + 1);
+                i += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                    uint32_t low = read_hex4(raw, i + 3);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                // A surrogate left unpaired has no UTF-8 encoding
+                if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0xFFFD;
+                append_utf8(out, cp);
+                break;
+            }
+            default: out += e; break;  // \" \\ \/
+        }
+    }
+    return out;
+}
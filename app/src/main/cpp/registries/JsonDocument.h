@@ -0,0 +1,66 @@
+#ifndef MIST_JSONDOCUMENT_H
+#define MIST_JSONDOCUMENT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// JSON text parsed once into a flat tape. Every value is a node; a container's
+// node records where its subtree ends, so siblings are skipped in O(1) and no
+// lookup ever re-scans the text. Arrays additionally index their elements, so
+// element access is O(1).
+class JsonDocument {
+public:
+    enum class Kind : uint8_t { Null, Bool, Number, String, Array, Object };
+
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    // False (and an empty document) on input that is not RFC 8259 JSON
+    bool parse(std::string text);
+
+    uint32_t root() const { return nodes.empty() ? npos : 0; }
+    // Null for npos or any other node not in the document
+    Kind kind(uint32_t node) const { return node < nodes.size() ? nodes[node].kind : Kind::Null; }
+
+    // Array element count, or field count for objects
+    uint32_t size(uint32_t node) const;
+
+    uint32_t at(uint32_t array, uint32_t index) const;
+    uint32_t field(uint32_t object, std::string_view key) const;
+
+    // Dot separated path from the root, numeric segments index arrays: "items.3.title"
+    uint32_t find(std::string_view path) const;
+
+    // Strings are unescaped, everything else is returned as its JSON text
+    std::string value(uint32_t node) const;
+
+    // Calls fn(key, valueNode) for each field of an object, in order
+    template <typename Fn>
+    void for_each_field(uint32_t object, Fn&& fn) const {
+        if (object >= nodes.size() || nodes[object].kind != Kind::Object) return;
+        for (uint32_t k = object + 1; k < nodes[object].end; k = nodes[k + 1].end) fn(value(k), k + 1);
+    }
+
+private:
+    struct Node {
+        Kind kind;
+        bool escaped = false;   // string contains backslash escapes
+        uint32_t start = 0;     // text offset (strings: after the opening quote)
+        uint32_t length = 0;    // text length (strings: without quotes)
+        uint32_t end = 0;       // index one past this node's subtree
+        uint32_t count = 0;     // children (object: fields)
+        uint32_t elements = 0;  // arrays: offset into elementIndex
+    };
+
+    bool parse_value(uint32_t& pos, int depth);
+    bool parse_string(uint32_t& pos);
+    bool parse_number(uint32_t& pos) const;
+    void skip_ws(uint32_t& pos) const;
+
+    std::string text;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> elementIndex;
+};
+
+#endif //MIST_JSONDOCUMENT_H
@@ -0,0 +1,54 @@
+#include "JsonNative.h"
+
+#include <memory>
+#include "JsonDocument.h"
+#include "SlotMap.h"
+
+// Generation-tagged handles, so a handle kept after json_free stops resolving
+// instead of aliasing the next document parsed into its slot
+static SlotMap<std::unique_ptr<JsonDocument>> g_documents;
+
+static JsonDocument* document_of(int handle) {
+    std::unique_ptr<JsonDocument>* document = g_documents.find(handle);
+    return document ? document->get() : nullptr;
+}
+
+const JsonDocument* json_document(int doc) {
+    return document_of(doc);
+}
+
+int json_parse(const std::string& text) {
+    auto doc = std::make_unique<JsonDocument>();
+    if (!doc->parse(text)) return -1;
+
+    return g_documents.insert(std::move(doc));
+}
+
+std::string json_get_path(int doc, const std::string& path) {
+    JsonDocument* document = document_of(doc);
+    if (!document) return "";
+
+    uint32_t node = document->find(path);
+    return node == JsonDocument::npos ? "" : document->value(node);
+}
+
+int json_array_len(int doc, const std::string& path) {
+    JsonDocument* document = document_of(doc);
+    if (!document) return 0;
+
+    uint32_t node = document->find(path);
+    if (node == JsonDocument::npos || document->kind(node) != JsonDocument::Kind::Array) return 0;
+    return static_cast<int>(document->size(node));
+}
+
+std::string json_array_at(int doc, const std::string& path, int index) {
+    JsonDocument* document = document_of(doc);
+    if (!document || index < 0) return "";
+
+    uint32_t node = document->at(document->find(path), static_cast<uint32_t>(index));
+    return node == JsonDocument::npos ? "" : document->value(node);
+}
+
+void json_free(int doc) {
+    g_documents.release(doc);
+}
@@ -0,0 +1,30 @@
+#ifndef MIST_JSONNATIVE_H
+#define MIST_JSONNATIVE_H
+
+#include <string>
+#include "../droplet/src/vm/VM.h"
+#include "NativeBinding.h"
+
+// Parsed JSON documents handed to Droplet as int handles. Parse once with
+// json_parse, then read any number of paths without re-scanning the text;
+// json_free releases the document. VM thread only.
+int json_parse(const std::string& text);                              // -1 on malformed input
+std::string json_get_path(int doc, const std::string& path);          // "" if missing
+int json_array_len(int doc, const std::string& path);                 // 0 if not an array
+std::string json_array_at(int doc, const std::string& path, int index);
+void json_free(int doc);
+
+class JsonDocument;
+
+// Document behind a json_parse handle, nullptr if freed or never issued
+const JsonDocument* json_document(int doc);
+
+inline void register_json_native_functions(VM& vm) {
+    vm.register_native("json_parse", bind_native<json_parse>);
+    vm.register_native("json_get_path", bind_native<json_get_path>);
+    vm.register_native("json_array_len", bind_native<json_array_len>);
+    vm.register_native("json_array_at", bind_native<json_array_at>);
+    vm.register_native("json_free", bind_native<json_free>);
+}
+
+#endif //MIST_JSONNATIVE_H
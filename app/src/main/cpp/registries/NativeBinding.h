@@ -0,0 +1,115 @@
+#ifndef MIST_NATIVEBINDING_H
+#define MIST_NATIVEBINDING_H
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "../droplet/src/vm/VM.h"
+#include "../droplet/src/compiler/TypeChecker.h"
+#include "../droplet/src/native/NativeRegisteries.h"
+#include "SpanTrace.h"
+
+// Typed natives: write a plain C++ function
+//
+//     int android_create_screen(const std::string& name);
+//
+// and register bind_native<android_create_screen> with the VM and
+// register_native_signature<android_create_screen>(name) with the TypeChecker.
+// The binder pops the arguments, converts them and pushes the result. The
+// registered signature lets the compiler reject calls of the wrong shape; code
+// it did not see still gets each argument's ValueType checked, and a mismatch
+// skips the call and pushes the return type's default (0, "" or nil).
+//
+// Supported parameter types: int, std::string (by value or const&).
+// Supported return types: void, int, std::string.
+
+template <typename T>
+struct NativeType;
+
+template <>
+struct NativeType<int> {
+    static auto type() { return Type::Int(); }
+    static bool accepts(const Value& v) { return v.type == ValueType::INT; }
+    static int from(const Value& v) { return static_cast<int>(v.current_value.i); }
+    static Value to(VM&, int n) { return Value::createINT(n); }
+};
+
+template <>
+struct NativeType<std::string> {
+    static auto type() { return Type::String(); }
+    static bool accepts(const Value&) { return true; }  // toString() covers every type
+    static std::string from(const Value& v) { return v.toString(); }
+    static Value to(VM& vm, std::string s) { return Value::createOBJECT(vm.allocator.allocate_string(std::move(s))); }
+};
+
+template <>
+struct NativeType<void> {
+    static auto type() { return Type::Null(); }
+};
+
+template <auto Fn>
+struct NativeBinder;
+
+template <typename R, typename... Args, R (*Fn)(Args...)>
+struct NativeBinder<Fn> {
+    using Return = std::decay_t<R>;
+    static constexpr size_t arity = sizeof...(Args);
+
+    // Set by register_signature, used to label trace spans
+    static inline const char* name = "native";
+
+    static void call(VM& vm, const uint8_t argc) {
+        DROPLET_SPAN(name);
+        if (argc != arity) {
+            // Only reachable from code the TypeChecker did not see
+            for (int i = 0; i < argc; i++) vm.stack_manager.pop();
+            push_default(vm);
+            return;
+        }
+        invoke(vm, std::index_sequence_for<Args...>{});
+    }
+
+private:
+    template <size_t... I>
+    static void invoke(VM& vm, std::index_sequence<I...>) {
+        // Braced initialisation runs left to right: popped[0] is the last argument
+        [[maybe_unused]] Value popped[arity + 1] = {(static_cast<void>(I), vm.stack_manager.pop())..., Value::createNIL()};
+        if (!(NativeType<std::decay_t<Args>>::accepts(popped[arity - 1 - I]) && ...)) {
+            push_default(vm);
+            return;
+        }
+
+        if constexpr (std::is_void_v<R>) {
+            Fn(NativeType<std::decay_t<Args>>::from(popped[arity - 1 - I])...);
+            vm.stack_manager.push(Value::createNIL());
+        } else {
+            Return result = Fn(NativeType<std::decay_t<Args>>::from(popped[arity - 1 - I])...);
+            vm.stack_manager.push(NativeType<Return>::to(vm, std::move(result)));
+        }
+    }
+
+    static void push_default(VM& vm) {
+        if constexpr (std::is_void_v<R>) {
+            vm.stack_manager.push(Value::createNIL());
+        } else {
+            vm.stack_manager.push(NativeType<Return>::to(vm, Return{}));
+        }
+    }
+
+public:
+    static void register_signature(const char* nativeName) {
+        name = nativeName;
+        registerNative({nativeName, NativeType<Return>::type(), {NativeType<std::decay_t<Args>>::type()...}});
+    }
+};
+
+template <auto Fn>
+inline constexpr auto bind_native = &NativeBinder<Fn>::call;
+
+template <auto Fn>
+inline void register_native_signature(const char* name) {
+    NativeBinder<Fn>::register_signature(name);
+}
+
+#endif //MIST_NATIVEBINDING_H
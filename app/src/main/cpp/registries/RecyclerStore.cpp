@@ -0,0 +1,131 @@
+#include "RecyclerStore.h"
+
+#include <algorithm>
+#include <atomic>
+
+std::string_view RecyclerRows::row(size_t i) const {
+    const Block& block = *blocks[i / kBlockRows];
+    size_t j = i % kBlockRows;
+    return std::string_view(block.arena).substr(block.offsets[j], block.offsets[j + 1] - block.offsets[j]);
+}
+
+void RecyclerRows::append(std::string_view row) {
+    if (count % kBlockRows == 0) {
+        blocks.push_back(std::make_shared<Block>());
+        blocks.back()->offsets.reserve(kBlockRows + 1);
+    } else if (blocks.back().use_count() > 1) {
+        // The last block is part of a snapshot: append to a copy
+        blocks.back() = std::make_shared<Block>(*blocks.back());
+    } else {
+        // Sole owner: pairs with the release of the snapshot that last read it
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    Block& block = *blocks.back();
+    block.arena.append(row);
+    block.offsets.push_back(static_cast<uint32_t>(block.arena.size()));
+    count++;
+}
+
+void RecyclerRows::clear() {
+    blocks.clear();
+    count = 0;
+}
+
+void RecyclerStore::notify(View& view, UiOp op, int32_t start, int32_t count) {
+    if (count <= 0) return;
+
+    // Appends arrive one row at a time: grow the previous insert instead
+    if (!view.pending.empty()) {
+        Range& last = view.pending.back();
+        if (op == UiOp::RecyclerViewInsert && last.op == op && last.start + last.count == start) {
+            last.count += count;
+            return;
+        }
+    }
+    view.pending.push_back({op, start, count});
+}
+
+void RecyclerStore::append(int viewId, std::string_view row) {
+    View& view = views[viewId];
+    view.rows.append(row);
+    notify(view, UiOp::RecyclerViewInsert, static_cast<int32_t>(view.rows.size() - 1), 1);
+}
+
+void RecyclerStore::clear(int viewId) {
+    View& view = views[viewId];
+    notify(view, UiOp::RecyclerViewRemove, 0, static_cast<int32_t>(view.rows.size()));
+    view.rows.clear();
+}
+
+void RecyclerStore::replace(int viewId, const std::vector<std::string>& rows) {
+    View& view = views[viewId];
+    const RecyclerRows& old = view.rows;
+
+    size_t oldSize = old.size();
+    size_t newSize = rows.size();
+    size_t limit = std::min(oldSize, newSize);
+
+    size_t prefix = 0;
+    while (prefix < limit && old.row(prefix) == rows[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < limit - prefix && old.row(oldSize - 1 - suffix) == rows[newSize - 1 - suffix]) suffix++;
+
+    // Rows [prefix, size - suffix) differ: change the overlap, insert or remove the rest
+    auto oldMiddle = static_cast<int32_t>(oldSize - prefix - suffix);
+    auto newMiddle = static_cast<int32_t>(newSize - prefix - suffix);
+    auto start = static_cast<int32_t>(prefix);
+    int32_t changed = std::min(oldMiddle, newMiddle);
+
+    notify(view, UiOp::RecyclerViewChange, start, changed);
+    if (newMiddle > oldMiddle) notify(view, UiOp::RecyclerViewInsert, start + changed, newMiddle - oldMiddle);
+    if (oldMiddle > newMiddle) notify(view, UiOp::RecyclerViewRemove, start + changed, oldMiddle - newMiddle);
+
+    if (prefix == oldSize) {
+        // Pure append: keep the blocks
+        for (size_t i = prefix; i < newSize; i++) view.rows.append(rows[i]);
+        return;
+    }
+    view.rows.clear();
+    for (const std::string& row : rows) view.rows.append(row);
+}
+
+void RecyclerStore::erase(int viewId) {
+    views.erase(viewId);
+    std::lock_guard<std::mutex> lock(mutex);
+    published.erase(viewId);
+}
+
+void RecyclerStore::flush_notifications(UiCommandBuffer& out) {
+    for (auto& [viewId, view] : views) {
+        if (view.pending.empty()) continue;
+
+        view.version++;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            published[viewId].queued.emplace_back(view.version, view.rows);
+        }
+        out.emit(UiOp::RecyclerViewCommit, {viewId, view.version});
+        for (const Range& range : view.pending) out.emit(range.op, {viewId, range.start, range.count});
+        view.pending.clear();
+    }
+}
+
+void RecyclerStore::adopt(int viewId, int32_t version) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = published.find(viewId);
+    if (it == published.end()) return;
+
+    // Commits are applied in order, so everything up to `version` is current or stale
+    auto& queued = it->second.queued;
+    while (!queued.empty() && queued.front().first <= version) {
+        if (queued.front().first == version) it->second.current = std::move(queued.front().second);
+        queued.pop_front();
+    }
+}
+
+std::string RecyclerStore::row(int viewId, int position) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = published.find(viewId);
+    if (it == published.end() || position < 0 || static_cast<size_t>(position) >= it->second.current.size()) return "";
+    return std::string(it->second.current.row(static_cast<size_t>(position)));
+}
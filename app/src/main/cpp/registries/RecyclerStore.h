@@ -0,0 +1,94 @@
+#ifndef MIST_RECYCLERSTORE_H
+#define MIST_RECYCLERSTORE_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "UiCommandBuffer.h"
+
+// Rows of one RecyclerView: UTF-8 bytes packed in an arena plus an offset table
+// per block of kBlockRows rows, so a list of N rows is a few allocations rather
+// than N strings. Copies share the blocks; a shared block is cloned before it is
+// appended to, so a copy is a cheap, immutable snapshot of the rows.
+class RecyclerRows {
+public:
+    static constexpr size_t kBlockRows = 256;
+
+    size_t size() const { return count; }
+    std::string_view row(size_t i) const;
+
+    void append(std::string_view row);
+    void clear();
+
+private:
+    struct Block {
+        std::string arena;
+        std::vector<uint32_t> offsets{0};
+    };
+
+    std::vector<std::shared_ptr<Block>> blocks;
+    size_t count = 0;
+};
+
+// Native data source behind every RecyclerView. Droplet code mutates the rows on
+// the VM thread; mutations are turned into the fewest range notifications:
+// consecutive appends coalesce, replace() diffs against the current rows by
+// common prefix and suffix.
+//
+// The UI thread never sees rows ahead of the notifications. Each flush that has
+// ranges for a view also queues a snapshot of its rows and emits
+// RecyclerViewCommit(viewId, version) before those ranges; MainActivity passes
+// that to adopt() while applying the batch, and recyclerRow binds from the
+// adopted snapshot only. The adapter's count and the rows it reads always
+// describe the same state.
+class RecyclerStore {
+public:
+    // VM thread
+    void append(int viewId, std::string_view row);
+    void clear(int viewId);
+    void replace(int viewId, const std::vector<std::string>& rows);
+    void erase(int viewId);
+
+    // VM thread, at flush: the range ops recorded since the last flush, each
+    // view's preceded by the commit of its snapshot
+    void flush_notifications(UiCommandBuffer& out);
+
+    // UI thread
+    void adopt(int viewId, int32_t version);
+    std::string row(int viewId, int position) const;  // "" for a row that does not exist
+
+private:
+    struct Range {
+        UiOp op;
+        int32_t start;
+        int32_t count;
+    };
+
+    // VM thread only
+    struct View {
+        RecyclerRows rows;
+        std::vector<Range> pending;
+        int32_t version = 0;
+    };
+
+    // What the UI thread binds from, and the snapshots flushed but not yet adopted
+    struct Published {
+        RecyclerRows current;
+        std::deque<std::pair<int32_t, RecyclerRows>> queued;
+    };
+
+    static void notify(View& view, UiOp op, int32_t start, int32_t count);
+
+    std::unordered_map<int, View> views;
+
+    mutable std::mutex mutex;  // guards published
+    std::unordered_map<int, Published> published;
+};
+
+#endif //MIST_RECYCLERSTORE_H
@@ -0,0 +1,127 @@
+#ifndef MIST_SLOTMAP_H
+#define MIST_SLOTMAP_H
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Handle to a SlotMap value: slot index in the low 20 bits, slot generation in the
+// next 11. Always positive so it survives the jint round trip; a handle whose slot
+// has since been released no longer resolves, even after the slot is reused.
+using SlotHandle = int32_t;
+constexpr SlotHandle kInvalidSlot = -1;
+
+// O(1) insert, lookup and release behind generation-tagged handles. Values are
+// kept dense (release moves the last value into the hole), so every live value is
+// in one contiguous span.
+template <typename T>
+class SlotMap {
+public:
+    static constexpr uint32_t kIndexBits = 20;
+    static constexpr uint32_t kGenerationBits = 11;
+    static constexpr size_t kMaxSlots = size_t(1) << kIndexBits;
+
+    // kInvalidSlot once kMaxSlots values are live
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slots.size() >= kMaxSlots) return kInvalidSlot;
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+
+        Slot& slot = slots[index];
+        slot.live = true;
+        slot.dense = static_cast<uint32_t>(dense.size());
+        dense.push_back(std::move(value));
+        denseToSlot.push_back(index);
+        return static_cast<SlotHandle>((slot.generation << kIndexBits) | index);
+    }
+
+    // nullptr if the handle was released (or never issued). Invalidated by the next insert.
+    T* find(SlotHandle handle) {
+        if (handle < 0) return nullptr;
+
+        auto raw = static_cast<uint32_t>(handle);
+        uint32_t index = raw & kIndexMask;
+        if (index >= slots.size()) return nullptr;
+
+        const Slot& slot = slots[index];
+        if (!slot.live || slot.generation != (raw >> kIndexBits)) return nullptr;
+        return &dense[slot.dense];
+    }
+
+    const T* find(SlotHandle handle) const { return const_cast<SlotMap*>(this)->find(handle); }
+
+    bool release(SlotHandle handle) {
+        if (!find(handle)) return false;
+        erase_dense(slots[static_cast<uint32_t>(handle) & kIndexMask].dense);
+        return true;
+    }
+
+    // Release every value `pred` accepts, returns how many were dropped
+    template <typename Pred>
+    size_t release_if(Pred pred) {
+        size_t released = 0;
+        // Walk backwards: erase_dense moves the last value into the hole
+        for (size_t i = dense.size(); i-- > 0;) {
+            if (pred(dense[i])) {
+                erase_dense(static_cast<uint32_t>(i));
+                released++;
+            }
+        }
+        return released;
+    }
+
+    // Release everything; handles issued before stay invalid
+    void clear() { release_if([](const T&) { return true; }); }
+
+    size_t size() const { return dense.size(); }
+
+    // All live values, in no particular order
+    std::span<T> values() { return dense; }
+    std::span<const T> values() const { return dense; }
+
+private:
+    static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static constexpr uint32_t kGenerationMask = (1u << kGenerationBits) - 1;
+
+    struct Slot {
+        uint32_t generation = 1;
+        uint32_t dense = 0;
+        bool live = false;
+    };
+
+    void erase_dense(uint32_t at) {
+        uint32_t index = denseToSlot[at];
+        auto last = static_cast<uint32_t>(dense.size() - 1);
+
+        if (at != last) {
+            dense[at] = std::move(dense[last]);
+            denseToSlot[at] = denseToSlot[last];
+            slots[denseToSlot[at]].dense = at;
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+
+        Slot& slot = slots[index];
+        slot.live = false;
+        // Generation 0 is never issued, so a handle is never 0
+        slot.generation = (slot.generation + 1) & kGenerationMask;
+        if (slot.generation == 0) slot.generation = 1;
+        freeSlots.push_back(index);
+    }
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+
+    // Parallel to each other
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot;
+};
+
+#endif //MIST_SLOTMAP_H
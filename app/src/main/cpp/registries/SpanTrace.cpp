@@ -0,0 +1,99 @@
+#include "SpanTrace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct Span {
+    const char* name;
+    uint64_t beginNs;
+    uint64_t durationNs;
+};
+
+// One per thread. The owner appends under its own (uncontended) mutex so an
+// export from another thread sees whole records.
+struct SpanBuffer {
+    static constexpr size_t kMaxSpans = 1 << 20;
+
+    int threadIndex = 0;
+    std::mutex mutex;
+    std::vector<Span> spans;
+};
+
+std::atomic<bool> g_recording{false};
+
+std::mutex g_buffers_mutex;
+std::vector<std::unique_ptr<SpanBuffer>> g_buffers;
+
+thread_local SpanBuffer* t_buffer = nullptr;
+
+SpanBuffer* thread_buffer() {
+    if (!t_buffer) {
+        auto buffer = std::make_unique<SpanBuffer>();
+        std::lock_guard<std::mutex> lock(g_buffers_mutex);
+        buffer->threadIndex = static_cast<int>(g_buffers.size()) + 1;
+        t_buffer = buffer.get();
+        g_buffers.push_back(std::move(buffer));
+    }
+    return t_buffer;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}  // namespace
+
+SpanScope::SpanScope(const char* name)
+        : name(g_recording.load(std::memory_order_relaxed) ? name : nullptr) {
+    if (this->name) beginNs = now_ns();
+}
+
+SpanScope::~SpanScope() {
+    if (!name) return;
+
+    uint64_t end = now_ns();
+    SpanBuffer* buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (buffer->spans.size() < SpanBuffer::kMaxSpans) {
+        buffer->spans.push_back({name, beginNs, end - beginNs});
+    }
+}
+
+void droplet_spans_set_recording(bool recording) {
+    g_recording.store(recording, std::memory_order_relaxed);
+}
+
+bool droplet_spans_recording() {
+    return g_recording.load(std::memory_order_relaxed);
+}
+
+bool droplet_spans_write_json(const std::string& path) {
+    FILE* out = std::fopen(path.c_str(), "w");
+    if (!out) return false;
+
+    std::fputs("{\"traceEvents\":[\n", out);
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(g_buffers_mutex);
+    for (auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        for (const Span& span : buffer->spans) {
+            // Complete events, timestamps in microseconds. Names are C++ literals
+            // and native names, neither needs JSON escaping.
+            std::fprintf(out, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         first ? "" : ",\n", span.name, buffer->threadIndex,
+                         span.beginNs / 1000.0, span.durationNs / 1000.0);
+            first = false;
+        }
+    }
+
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+    return std::fclose(out) == 0;
+}
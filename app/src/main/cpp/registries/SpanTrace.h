@@ -0,0 +1,44 @@
+#ifndef MIST_SPANTRACE_H
+#define MIST_SPANTRACE_H
+
+#include <cstdint>
+#include <string>
+
+// Opt-in execution spans (bundle load, VM run, callbacks, natives, JNI upcalls)
+// exported as Chrome trace-event JSON, which chrome://tracing and the Perfetto
+// UI both open. Compiled out unless DROPLET_SPANS_ENABLED (CMake option
+// DROPLET_SPANS); when compiled in, recording still starts switched off.
+#ifndef DROPLET_SPANS_ENABLED
+#define DROPLET_SPANS_ENABLED 0
+#endif
+
+// Records [construction, destruction) under `name`, a string literal
+class SpanScope {
+public:
+    explicit SpanScope(const char* name);
+    ~SpanScope();
+
+    SpanScope(const SpanScope&) = delete;
+    SpanScope& operator=(const SpanScope&) = delete;
+
+private:
+    const char* name;  // nullptr while not recording
+    uint64_t beginNs = 0;
+};
+
+void droplet_spans_set_recording(bool recording);
+bool droplet_spans_recording();
+
+// Writes every span recorded so far, false if the file cannot be written
+bool droplet_spans_write_json(const std::string& path);
+
+#define DROPLET_SPAN_CAT_(a, b) a##b
+#define DROPLET_SPAN_CAT(a, b) DROPLET_SPAN_CAT_(a, b)
+
+#if DROPLET_SPANS_ENABLED
+#define DROPLET_SPAN(name) SpanScope DROPLET_SPAN_CAT(droplet_span_, __LINE__)(name)
+#else
+#define DROPLET_SPAN(name) do {} while (0)
+#endif
+
+#endif //MIST_SPANTRACE_H
@@ -0,0 +1,163 @@
+#include "StyleSheet.h"
+
+#include <charconv>
+
+namespace {
+
+struct Property {
+    std::string_view name;
+    StyleField first;
+    bool sides;  // padding/margin: 1 to 4 values
+    bool color;
+};
+
+constexpr Property kProperties[] = {
+    {"padding",          StyleField::PaddingLeft,     true,  false},
+    {"margin",           StyleField::MarginLeft,      true,  false},
+    {"width",            StyleField::Width,           false, false},
+    {"height",           StyleField::Height,          false, false},
+    {"background-color", StyleField::BackgroundColor, false, true},
+    {"corner-radius",    StyleField::CornerRadius,    false, false},
+    {"elevation",        StyleField::Elevation,       false, false},
+    {"border-width",     StyleField::BorderWidth,     false, false},
+    {"border-color",     StyleField::BorderColor,     false, true},
+    {"gravity",          StyleField::Gravity,         false, false},
+    {"text-size",        StyleField::TextSize,        false, false},
+    {"text-color",       StyleField::TextColor,       false, true},
+    {"text-style",       StyleField::TextStyle,       false, false},
+};
+
+std::string_view trim(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) return {};
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+// Decimal, accepting the unsigned ARGB range as well
+bool parse_number(std::string_view s, int32_t& out) {
+    int64_t v = 0;
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc() || ptr != s.data() + s.size() || v < INT32_MIN || v > UINT32_MAX) return false;
+    out = static_cast<int32_t>(static_cast<uint32_t>(v));
+    return true;
+}
+
+bool parse_value(std::string_view s, bool color, int32_t& out) {
+    if (color && !s.empty() && s[0] == '#') {
+        std::string_view hex = s.substr(1);
+        if (hex.size() != 6 && hex.size() != 8) return false;
+        uint32_t v = 0;
+        auto [ptr, ec] = std::from_chars(hex.data(), hex.data() + hex.size(), v, 16);
+        if (ec != std::errc() || ptr != hex.data() + hex.size()) return false;
+        if (hex.size() == 6) v |= 0xFF000000u;
+        out = static_cast<int32_t>(v);
+        return true;
+    }
+    // Same sentinels as android_set_view_size
+    if (s == "wrap") { out = -1; return true; }
+    if (s == "match") { out = -2; return true; }
+    return parse_number(s, out);
+}
+
+}  // namespace
+
+bool StyleSheet::parse(std::string_view source, Style& out) {
+    out = Style{};
+
+    while (!source.empty()) {
+        size_t semicolon = source.find(';');
+        std::string_view declaration = trim(source.substr(0, semicolon));
+        source = (semicolon == std::string_view::npos) ? std::string_view{} : source.substr(semicolon + 1);
+        if (declaration.empty()) continue;
+
+        size_t colon = declaration.find(':');
+        if (colon == std::string_view::npos) return false;
+        std::string_view name = trim(declaration.substr(0, colon));
+        std::string_view rest = trim(declaration.substr(colon + 1));
+
+        const Property* property = nullptr;
+        for (const Property& p : kProperties) {
+            if (p.name == name) property = &p;
+        }
+        if (!property) return false;
+
+        int32_t values[4];
+        size_t count = 0;
+        while (!rest.empty()) {
+            size_t space = rest.find_first_of(" \t");
+            if (count == 4 || !parse_value(rest.substr(0, space), property->color, values[count])) return false;
+            count++;
+            rest = (space == std::string_view::npos) ? std::string_view{} : trim(rest.substr(space));
+        }
+
+        auto first = static_cast<size_t>(property->first);
+        if (!property->sides) {
+            if (count != 1) return false;
+            out.values[first] = values[0];
+            out.mask |= 1u << first;
+            continue;
+        }
+
+        int32_t left, top, right, bottom;
+        if (count == 1) {
+            left = top = right = bottom = values[0];
+        } else if (count == 2) {
+            top = bottom = values[0];
+            left = right = values[1];
+        } else if (count == 3) {
+            top = values[0];
+            left = right = values[1];
+            bottom = values[2];
+        } else if (count == 4) {
+            top = values[0];
+            right = values[1];
+            bottom = values[2];
+            left = values[3];
+        } else {
+            return false;
+        }
+        out.values[first] = left;
+        out.values[first + 1] = top;
+        out.values[first + 2] = right;
+        out.values[first + 3] = bottom;
+        out.mask |= 0xFu << first;
+    }
+    return true;
+}
+
+size_t StyleSheet::StyleHash::operator()(const Style& style) const {
+    uint64_t h = 1469598103934665603ull ^ style.mask;
+    for (int32_t v : style.values) {
+        h = (h ^ static_cast<uint32_t>(v)) * 1099511628211ull;
+    }
+    return static_cast<size_t>(h);
+}
+
+int StyleSheet::define(std::string_view source, bool& created) {
+    created = false;
+    auto known = bySource.find(source);
+    if (known != bySource.end()) return known->second;
+
+    Style style;
+    if (!parse(source, style)) return -1;
+
+    auto [it, inserted] = ids.emplace(style, static_cast<int>(styles.size()) + 1);
+    if (inserted) {
+        styles.push_back(style);
+        created = true;
+    }
+    bySource.emplace(std::string(source), it->second);
+    return it->second;
+}
+
+const Style* StyleSheet::find(int styleId) const {
+    if (styleId < 1 || static_cast<size_t>(styleId) > styles.size()) return nullptr;
+    return &styles[styleId - 1];
+}
+
+void StyleSheet::clear() {
+    styles.clear();
+    ids.clear();
+    bySource.clear();
+}
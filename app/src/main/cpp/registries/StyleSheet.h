@@ -0,0 +1,77 @@
+#ifndef MIST_STYLESHEET_H
+#define MIST_STYLESHEET_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One value per field; a style sets only the fields in its mask.
+// Indices are mirrored by StyleField in MainActivity.kt - keep them in sync.
+enum class StyleField : uint8_t {
+    PaddingLeft, PaddingTop, PaddingRight, PaddingBottom,
+    MarginLeft, MarginTop, MarginRight, MarginBottom,
+    Width, Height,
+    BackgroundColor,
+    CornerRadius,
+    Elevation,
+    BorderWidth, BorderColor,
+    Gravity,
+    TextSize, TextColor, TextStyle,
+    Count
+};
+
+constexpr size_t kStyleFieldCount = static_cast<size_t>(StyleField::Count);
+
+struct Style {
+    uint32_t mask = 0;  // bit i set: values[i] applies
+    std::array<int32_t, kStyleFieldCount> values{};
+
+    bool operator==(const Style& other) const { return mask == other.mask && values == other.values; }
+};
+
+// Immutable styles defined from Droplet code with CSS-like declarations,
+//
+//     "padding: 24; margin: 16 12; background-color: #FFFFFF; corner-radius: 20"
+//
+// and applied to a view in one op. Lengths are dp like the android_set_* natives,
+// colors are #RRGGBB, #AARRGGBB or a decimal ARGB int. Padding and margin take
+// one to four values in CSS order: all sides; vertical horizontal; top horizontal
+// bottom; top right bottom left.
+//
+// Styles are interned: the same source, or a different source with the same
+// resolved fields, yields the same id, so MainActivity resolves each distinct
+// style once. Ids start at 1.
+class StyleSheet {
+public:
+    // Id for the declarations, -1 if they do not parse. `created` is set when the
+    // style is new and still has to be sent to MainActivity.
+    int define(std::string_view source, bool& created);
+
+    // nullptr for an id that was never issued
+    const Style* find(int styleId) const;
+
+    // Forget every style, e.g. with the VM whose UI they were sent to. Ids start
+    // at 1 again and each style is created (and sent) anew.
+    void clear();
+
+    static bool parse(std::string_view source, Style& out);
+
+private:
+    struct StyleHash {
+        size_t operator()(const Style& style) const;
+    };
+
+    struct SourceHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    std::vector<Style> styles;  // id - 1
+    std::unordered_map<Style, int, StyleHash> ids;
+    std::unordered_map<std::string, int, SourceHash, std::equal_to<>> bySource;
+};
+
+#endif //MIST_STYLESHEET_H
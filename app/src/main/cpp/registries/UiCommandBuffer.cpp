@@ -0,0 +1,138 @@
+#include "UiCommandBuffer.h"
+
+#include <cassert>
+#include <cstring>
+
+static constexpr int8_t kArity[] = {
+    -1, // DefineString
+    1,  // ShowToast
+    4,  // CreateButton
+    3,  // CreateTextView
+    5,  // CreateImageView
+    3,  // CreateLinearLayout
+    2,  // CreateScrollView
+    4,  // CreateCardView
+    3,  // CreateRecyclerView
+    3,  // CreateEditText
+    2,  // CreateScreen
+    2,  // AddViewToParent
+    2,  // SetViewText
+    2,  // SetViewImage
+    2,  // SetViewVisibility
+    2,  // SetViewBackgroundColor
+    5,  // SetViewPadding
+    3,  // SetViewSize
+    5,  // SetViewMargin
+    2,  // SetViewGravity
+    2,  // SetViewElevation
+    2,  // SetViewCornerRadius
+    3,  // SetViewBorder
+    2,  // SetTextSize
+    2,  // SetTextColor
+    2,  // SetTextStyle
+    2,  // SetEditTextHint
+    2,  // SetEditTextInputType
+    3,  // RecyclerViewInsert
+    3,  // RecyclerViewRemove
+    3,  // RecyclerViewChange
+    1,  // SetToolbarTitle
+    1,  // NavigateToScreen
+    0,  // NavigateBack
+    1,  // SetBackButtonVisible
+    1,  // ClearScreen
+    1,  // RemoveView
+    2,  // SetButtonCallback
+    21, // DefineStyle
+    2,  // ApplyStyle
+    2,  // RecyclerViewCommit
+};
+static_assert(sizeof(kArity) == static_cast<size_t>(UiOp::Count), "arity table out of sync with UiOp");
+
+int ui_op_arity(UiOp op) {
+    auto i = static_cast<size_t>(op);
+    return i < sizeof(kArity) ? kArity[i] : -1;
+}
+
+void UiCommandBuffer::put_u32(uint32_t v) {
+    uint8_t raw[4] = {
+        static_cast<uint8_t>(v),
+        static_cast<uint8_t>(v >> 8),
+        static_cast<uint8_t>(v >> 16),
+        static_cast<uint8_t>(v >> 24),
+    };
+    bytes.insert(bytes.end(), raw, raw + 4);
+}
+
+int32_t UiCommandBuffer::intern(std::string_view s) {
+    auto it = strings.find(s);
+    if (it != strings.end()) return it->second;
+
+    auto id = static_cast<int32_t>(strings.size());
+    strings.emplace(std::string(s), id);
+
+    bytes.push_back(static_cast<uint8_t>(UiOp::DefineString));
+    put_u32(static_cast<uint32_t>(s.size()));
+    bytes.insert(bytes.end(), s.begin(), s.end());
+    return id;
+}
+
+void UiCommandBuffer::emit(UiOp op, std::initializer_list<int32_t> args) {
+    emit(op, args.begin(), args.size());
+}
+
+void UiCommandBuffer::emit(UiOp op, const int32_t* args, size_t count) {
+    // The reader takes the argument count from the opcode alone, so a call site that
+    // disagrees with kArity would shift every op after it. Refuse it in release builds.
+    int arity = ui_op_arity(op);
+    assert(arity >= 0 && static_cast<size_t>(arity) == count && "UiOp emitted with the wrong argument count");
+    if (arity < 0 || static_cast<size_t>(arity) != count) return;
+
+    bytes.push_back(static_cast<uint8_t>(op));
+    for (size_t i = 0; i < count; i++) put_u32(static_cast<uint32_t>(args[i]));
+}
+
+void UiCommandBuffer::clear() {
+    bytes.clear();
+    strings.clear();
+}
+
+bool UiCommandReader::read_u32(uint32_t& v) {
+    if (end - cur < 4) return false;
+    v = static_cast<uint32_t>(cur[0]) |
+        static_cast<uint32_t>(cur[1]) << 8 |
+        static_cast<uint32_t>(cur[2]) << 16 |
+        static_cast<uint32_t>(cur[3]) << 24;
+    cur += 4;
+    return true;
+}
+
+bool UiCommandReader::next(UiCommand& out) {
+    while (cur < end) {
+        auto op = static_cast<UiOp>(*cur++);
+
+        if (op == UiOp::DefineString) {
+            uint32_t len;
+            if (!read_u32(len) || static_cast<size_t>(end - cur) < len) return false;
+            strings.emplace_back(reinterpret_cast<const char*>(cur), len);
+            cur += len;
+            continue;
+        }
+
+        int arity = ui_op_arity(op);
+        if (arity < 0 || arity > kMaxUiOpArgs) return false;
+
+        out.op = op;
+        for (int i = 0; i < arity; i++) {
+            uint32_t v;
+            if (!read_u32(v)) return false;
+            out.args[i] = static_cast<int32_t>(v);
+        }
+        return true;
+    }
+    return false;
+}
+
+std::string_view UiCommandReader::string(int32_t id) const {
+    if (id < 0 || static_cast<size_t>(id) >= strings.size()) return {};
+    return strings[id];
+}
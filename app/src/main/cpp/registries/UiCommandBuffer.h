@@ -0,0 +1,125 @@
+#ifndef MIST_UICOMMANDBUFFER_H
+#define MIST_UICOMMANDBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// View mutations recorded while the VM runs and handed to MainActivity.applyUiCommands
+// in one batch per VM turn.
+//
+// Encoding (little endian): a u8 opcode followed by ui_op_arity(op) int32 arguments.
+// String arguments are indices into the batch's string table; DefineString
+// (u32 byte length + UTF-8 bytes) appends to that table and always precedes
+// the first op that references it. The table is reset on every flush.
+//
+// Opcode values are mirrored by UiOp in MainActivity.kt - keep them in sync.
+enum class UiOp : uint8_t {
+    DefineString = 0,
+    ShowToast,              // msg
+    CreateButton,           // title, viewId, callbackId, parentId
+    CreateTextView,         // text, viewId, parentId
+    CreateImageView,        // path, viewId, parentId, width, height
+    CreateLinearLayout,     // orientation, viewId, parentId
+    CreateScrollView,       // viewId, parentId
+    CreateCardView,         // viewId, parentId, elevation, cornerRadius
+    CreateRecyclerView,     // viewId, parentId, layoutType
+    CreateEditText,         // hint, viewId, parentId
+    CreateScreen,           // screenId, name
+    AddViewToParent,        // parentId, childId
+    SetViewText,            // viewId, text
+    SetViewImage,           // viewId, path
+    SetViewVisibility,      // viewId, visibility
+    SetViewBackgroundColor, // viewId, color
+    SetViewPadding,         // viewId, left, top, right, bottom
+    SetViewSize,            // viewId, width, height
+    SetViewMargin,          // viewId, left, top, right, bottom
+    SetViewGravity,         // viewId, gravity
+    SetViewElevation,       // viewId, elevation
+    SetViewCornerRadius,    // viewId, radius
+    SetViewBorder,          // viewId, width, color
+    SetTextSize,            // viewId, size
+    SetTextColor,           // viewId, color
+    SetTextStyle,           // viewId, style
+    SetEditTextHint,        // viewId, hint
+    SetEditTextInputType,   // viewId, inputType
+    RecyclerViewInsert,     // viewId, start, count (rows are pulled via recyclerRow)
+    RecyclerViewRemove,     // viewId, start, count
+    RecyclerViewChange,     // viewId, start, count
+    SetToolbarTitle,        // title
+    NavigateToScreen,       // screenId
+    NavigateBack,           //
+    SetBackButtonVisible,   // visible
+    ClearScreen,            // screenId
+    RemoveView,             // viewId
+    SetButtonCallback,      // viewId, callbackId
+    DefineStyle,            // styleId, mask, one value per StyleField (StyleSheet.h)
+    ApplyStyle,             // viewId, styleId
+    RecyclerViewCommit,     // viewId, version (rows the following Recycler ops describe)
+    Count
+};
+
+// Widest op: DefineStyle
+constexpr int kMaxUiOpArgs = 21;
+
+// Number of int32 arguments following the opcode (DefineString is variable length)
+int ui_op_arity(UiOp op);
+
+class UiCommandBuffer {
+public:
+    // Index of s in this batch's string table, emitting DefineString on first use
+    int32_t intern(std::string_view s);
+
+    // args must hold exactly ui_op_arity(op) values; anything else asserts in debug
+    // builds and is dropped in release ones rather than desynchronising the batch
+    void emit(UiOp op, std::initializer_list<int32_t> args);
+    void emit(UiOp op, const int32_t* args, size_t count);
+
+    const uint8_t* data() const { return bytes.data(); }
+    size_t size() const { return bytes.size(); }
+    bool empty() const { return bytes.empty(); }
+
+    // Drop the recorded ops and the string table, keeping capacity
+    void clear();
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    void put_u32(uint32_t v);
+
+    std::vector<uint8_t> bytes;
+    std::unordered_map<std::string, int32_t, StringHash, std::equal_to<>> strings;
+};
+
+struct UiCommand {
+    UiOp op;
+    int32_t args[kMaxUiOpArgs];
+};
+
+// Host-side decoder for a flushed batch; resolves the string table as it goes.
+class UiCommandReader {
+public:
+    UiCommandReader(const uint8_t* data, size_t size) : cur(data), end(data + size) {}
+
+    // Next view op (DefineString records are consumed internally).
+    // Returns false at the end of the batch or on a malformed stream.
+    bool next(UiCommand& out);
+
+    std::string_view string(int32_t id) const;
+
+private:
+    bool read_u32(uint32_t& v);
+
+    const uint8_t* cur;
+    const uint8_t* end;
+    std::vector<std::string_view> strings;
+};
+
+#endif //MIST_UICOMMANDBUFFER_H
@@ -0,0 +1,178 @@
+#include "ViewTree.h"
+
+#include <algorithm>
+
+ViewTree::ViewTree() {
+    add_screen(-1);
+}
+
+void ViewTree::add_screen(int screenId) {
+    Node& node = nodes[screenId];
+    node.kind = UiOp::CreateScreen;
+}
+
+void ViewTree::visit(Node& node) {
+    node.epoch = epoch;
+    node.matched = 0;
+    node.diverged = false;
+}
+
+int ViewTree::reuse(int parentId, UiOp kind, Shape shape) {
+    if (!active) return -1;
+    auto it = nodes.find(parentId);
+    if (it == nodes.end() || !placed(it->second)) return -1;
+
+    Node& parent = it->second;
+    if (parent.diverged || parent.matched >= parent.children.size()) {
+        parent.diverged = true;
+        return -1;
+    }
+
+    int candidate = parent.children[parent.matched];
+    Node& child = nodes[candidate];
+    if (child.kind != kind || child.shape != shape) {
+        parent.diverged = true;
+        return -1;
+    }
+
+    parent.matched++;
+    visit(child);
+    return candidate;
+}
+
+void ViewTree::insert(int viewId, int parentId, UiOp kind, Shape shape) {
+    Node& node = nodes[viewId];
+    node = Node{};
+    node.kind = kind;
+    node.shape = shape;
+    node.parent = parentId;
+    if (active) visit(node);
+
+    auto it = nodes.find(parentId);
+    if (it == nodes.end()) return;
+    it->second.children.push_back(viewId);
+    // Past the reused prefix now; the new child must never be matched itself
+    if (placed(it->second)) it->second.diverged = true;
+}
+
+void ViewTree::detach(int viewId, int parentId) {
+    auto it = nodes.find(parentId);
+    if (it == nodes.end()) return;
+    auto& children = it->second.children;
+    auto pos = std::find(children.begin(), children.end(), viewId);
+    if (pos != children.end()) children.erase(pos);
+}
+
+bool ViewTree::move(int viewId, int parentId) {
+    auto it = nodes.find(viewId);
+    if (it == nodes.end()) return true;
+
+    Node& node = it->second;
+    if (node.parent == parentId && placed(node)) return false;
+
+    detach(viewId, node.parent);
+    node.parent = parentId;
+
+    auto parent = nodes.find(parentId);
+    if (parent == nodes.end()) return true;
+    parent->second.children.push_back(viewId);
+    if (placed(parent->second)) parent->second.diverged = true;
+    return true;
+}
+
+bool ViewTree::update(UiOp op, std::initializer_list<int32_t> args, std::string_view text) {
+    if (args.size() == 0) return true;
+    auto it = nodes.find(*args.begin());
+    if (it == nodes.end()) return true;
+
+    Node& node = it->second;
+    auto count = static_cast<uint8_t>(std::min<size_t>(args.size() - 1, 4));
+    const int32_t* values = args.begin() + 1;
+
+    auto prop = std::find_if(node.props.begin(), node.props.end(), [op](const Prop& p) { return p.op == op; });
+    if (prop == node.props.end()) {
+        prop = node.props.emplace(node.props.end());
+        prop->op = op;
+    } else if (placed(node) && prop->count == count && prop->text == text &&
+               std::equal(values, values + count, prop->values) &&
+               // The user edits an EditText's text, so the recorded value may be stale
+               !(op == UiOp::SetViewText && node.kind == UiOp::CreateEditText)) {
+        return false;
+    }
+
+    prop->count = count;
+    std::copy(values, values + count, prop->values);
+    prop->text.assign(text);
+    return true;
+}
+
+int32_t ViewTree::prop(int viewId, UiOp op) const {
+    auto it = nodes.find(viewId);
+    if (it == nodes.end()) return -1;
+    for (const Prop& p : it->second.props) {
+        if (p.op == op) return p.count > 0 ? p.values[0] : -1;
+    }
+    return -1;
+}
+
+void ViewTree::begin_rebuild(int screenId) {
+    if (!nodes.count(screenId)) add_screen(screenId);
+    active = true;
+    epoch++;
+    screen = screenId;
+    visit(nodes[screenId]);
+}
+
+// Breadth first, so parents are reported before their children
+void ViewTree::drop(int viewId, std::vector<Removed>& removed) {
+    size_t first = removed.size();
+    removed.push_back({viewId, UiOp::Count, -1});
+
+    for (size_t i = first; i < removed.size(); i++) {
+        auto it = nodes.find(removed[i].viewId);
+        if (it == nodes.end()) continue;
+
+        Node& node = it->second;
+        removed[i].kind = node.kind;
+        if (node.kind == UiOp::CreateButton) removed[i].callback = prop(removed[i].viewId, UiOp::SetButtonCallback);
+        for (int child : node.children) removed.push_back({child, UiOp::Count, -1});
+        nodes.erase(it);
+    }
+}
+
+void ViewTree::end_rebuild(std::vector<Removed>& removed) {
+    if (!active) return;
+
+    std::vector<int> pending{screen};
+    while (!pending.empty()) {
+        int viewId = pending.back();
+        pending.pop_back();
+
+        auto it = nodes.find(viewId);
+        if (it == nodes.end()) continue;
+
+        auto& children = it->second.children;
+        size_t kept = 0;
+        for (int child : children) {
+            auto c = nodes.find(child);
+            if (c == nodes.end()) continue;
+            if (c->second.epoch == epoch) {
+                children[kept++] = child;
+                pending.push_back(child);
+            } else {
+                drop(child, removed);
+            }
+        }
+        children.resize(kept);
+    }
+    active = false;
+}
+
+void ViewTree::clear(int screenId, std::vector<Removed>& removed) {
+    auto it = nodes.find(screenId);
+    if (it == nodes.end()) return;
+
+    std::vector<int> children = std::move(it->second.children);
+    it->second.children.clear();
+    for (int child : children) drop(child, removed);
+}
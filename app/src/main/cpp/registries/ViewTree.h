@@ -0,0 +1,106 @@
+#ifndef MIST_VIEWTREE_H
+#define MIST_VIEWTREE_H
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "UiCommandBuffer.h"
+
+// Retained copy of the view hierarchy the natives have built, keyed by the ids
+// MainActivity uses. It lets Droplet code rebuild a screen by running its build
+// code again instead of clearing it:
+//
+//     android_begin_rebuild(screen)
+//     ... the same android_create_* / android_set_* calls as the first build ...
+//     android_end_rebuild()
+//
+// During a rebuild every create is matched against the retained child in the
+// same slot of the same parent. A view of the same kind and shape is reused (the
+// create returns its old id and sends nothing) and property setters only emit
+// when the value differs from the one recorded. Matching under a parent stops at
+// its first mismatch: the old children from there on are removed and the new ones
+// created, so MainActivity's append-only child order stays right. Views that were
+// not placed again are removed at end_rebuild.
+//
+// A property the rebuild does not set again keeps its previous value.
+class ViewTree {
+public:
+    // Create arguments that have no setter (orientation, layout type, ...); a
+    // view is only reused when these match
+    using Shape = std::array<int32_t, 2>;
+
+    struct Removed {
+        int viewId;
+        UiOp kind;
+        int32_t callback;  // button callback handle, -1 for other views
+    };
+
+    ViewTree();
+
+    // Screen containers are the roots; -1 (the main screen) always exists
+    void add_screen(int screenId);
+
+    // During a rebuild: the retained view taking the parent's next child slot,
+    // -1 when the caller has to create one (and insert it)
+    int reuse(int parentId, UiOp kind, Shape shape);
+    void insert(int viewId, int parentId, UiOp kind, Shape shape);
+
+    // add_view_to_parent; false if a rebuild re-attaches a view where it already is
+    bool move(int viewId, int parentId);
+
+    // Records a setter: args are the op's int arguments starting with the view id,
+    // text replaces the string argument. False when a rebuild re-applies the value
+    // the view already has, i.e. the op need not be sent.
+    bool update(UiOp op, std::initializer_list<int32_t> args, std::string_view text = {});
+
+    // First int argument recorded for op (after the view id), or -1
+    int32_t prop(int viewId, UiOp op) const;
+
+    void begin_rebuild(int screenId);
+    bool rebuilding() const { return active; }
+
+    // Ends the rebuild and drops every view on the screen that was not placed
+    // again, parents before their children
+    void end_rebuild(std::vector<Removed>& removed);
+
+    // Drops every view below the screen (ClearScreen)
+    void clear(int screenId, std::vector<Removed>& removed);
+
+    size_t size() const { return nodes.size(); }
+
+private:
+    struct Prop {
+        UiOp op = UiOp::Count;
+        uint8_t count = 0;
+        int32_t values[4] = {};
+        std::string text;
+    };
+
+    struct Node {
+        UiOp kind;
+        Shape shape{};
+        int parent = -1;
+        std::vector<int> children;
+        std::vector<Prop> props;
+
+        uint32_t epoch = 0;     // last rebuild that placed this view
+        uint32_t matched = 0;   // children reused so far in that rebuild
+        bool diverged = false;  // no further children can be reused
+    };
+
+    void visit(Node& node);
+    bool placed(const Node& node) const { return active && node.epoch == epoch; }
+    void detach(int viewId, int parentId);
+    void drop(int viewId, std::vector<Removed>& removed);
+
+    std::unordered_map<int, Node> nodes;
+    bool active = false;
+    uint32_t epoch = 0;
+    int screen = -1;
+};
+
+#endif //MIST_VIEWTREE_H
@@ -0,0 +1,24 @@
+#ifndef MIST_TESTS_CHECK_H
+#define MIST_TESTS_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+// Test assertions that stay on in release builds. A failure prints the
+// expression and ends the test executable with a non-zero status.
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                           \
+        }                                                                           \
+    } while (0)
+
+// Runs one test function and reports it by name
+#define RUN_TEST(fn)                        \
+    do {                                    \
+        std::printf("-- %s\n", #fn);        \
+        fn();                               \
+    } while (0)
+
+#endif //MIST_TESTS_CHECK_H
@@ -0,0 +1,273 @@
+// HttpCache against a loopback server that counts requests: fresh entries skip
+// the network, stale ones revalidate with their validators, responses are kept
+// apart by Vary and Authorization, no-store drops what was cached, and the
+// bodies stay within their budget.
+//
+// get() follows AndroidNative's submit_http_request and android_http_complete.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "HttpCache.h"
+#include "LoopbackHttp.h"
+
+namespace fs = std::filesystem;
+
+static HttpCache* g_cache = nullptr;
+
+static std::mutex g_mutex;
+static std::condition_variable g_done;
+static bool g_finished = false;
+static int g_status = 0;
+static std::string g_body;
+
+static void complete(HttpCall& call, const std::vector<HttpRequestId>&) {
+    const HttpRequest& request = call.request;
+    if (call.statusCode == 304 && request.revalidates) {
+        g_cache->refresh(request.url, request.headers, call.responseHeaders);
+    } else if (call.statusCode == 200) {
+        g_cache->store(request.url, request.headers, call.response, call.responseHeaders);
+    }
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_status = call.statusCode;
+    g_body = call.response;
+    g_finished = true;
+    g_done.notify_all();
+}
+
+// The body a GET delivers first: from the cache if there is an entry (revalidated
+// when stale), else from the network
+static std::string get(HttpClient& client, const std::string& url, const std::string& headers = "") {
+    HttpRequest request{"GET", url, "", headers};
+    std::optional<HttpCacheEntry> cached = g_cache->lookup(url, headers);
+    std::string cachedBody;
+    bool hit = cached && g_cache->read_body(*cached, cachedBody);
+    if (hit && HttpCache::fresh(*cached, static_cast<int64_t>(std::time(nullptr)))) return cachedBody;
+    if (hit) {
+        request.revalidates = cached->hash;
+        request.headers = HttpCache::with_validators(headers, *cached);
+    }
+
+    std::unique_lock<std::mutex> lock(g_mutex);
+    g_finished = false;
+    lock.unlock();
+    client.submit(1, std::move(request));
+    lock.lock();
+    CHECK(g_done.wait_for(lock, std::chrono::seconds(5), [] { return g_finished; }));
+    return hit ? cachedBody : g_body;
+}
+
+static HttpClientConfig loopback_config() {
+    HttpClientConfig config;
+    config.workers = 1;
+    config.abort = loopback_abort;
+    return config;
+}
+
+// A cache in a fresh directory, removed afterwards
+struct TempCache {
+    fs::path directory;
+    std::unique_ptr<HttpCache> cache;
+
+    explicit TempCache(uint64_t maxBytes = 1 << 20) {
+        char name[] = "/tmp/http-cache-XXXXXX";
+        CHECK(::mkdtemp(name) != nullptr);
+        directory = name;
+        reopen(maxBytes);
+    }
+    ~TempCache() {
+        g_cache = nullptr;
+        cache.reset();
+        fs::remove_all(directory);
+    }
+
+    void reopen(uint64_t maxBytes = 1 << 20) {
+        cache.reset();
+        cache = std::make_unique<HttpCache>(directory.string(), maxBytes);
+        g_cache = cache.get();
+    }
+
+    size_t body_files() const {
+        size_t count = 0;
+        for (const auto& file : fs::directory_iterator(directory)) count += file.path().filename() != "index";
+        return count;
+    }
+};
+
+static void test_fresh_entry_skips_network() {
+    TempCache temp;
+    LoopbackServer server([](const LoopbackRequest&) {
+        LoopbackResponse response;
+        response.headers = "Cache-Control: max-age=60";
+        response.body = "v1";
+        return response;
+    });
+    HttpClient client(loopback_transport, complete, loopback_config());
+
+    CHECK(get(client, server.url("/feed")) == "v1");
+    CHECK(get(client, server.url("/feed")) == "v1");
+    CHECK(get(client, server.url("/feed")) == "v1");
+    CHECK(server.requests() == 1);
+}
+
+static void test_stale_entry_revalidates() {
+    TempCache temp;
+    std::mutex mutex;
+    std::vector<std::string> ifNoneMatch;
+    int bodies = 0;
+    LoopbackServer server([&](const LoopbackRequest& request) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string validator(http_header(request.headers, "If-None-Match"));
+        ifNoneMatch.push_back(validator);
+
+        LoopbackResponse response;
+        response.headers = "ETag: \"e1\"\nCache-Control: no-cache";
+        if (validator == "\"e1\"") {
+            response.status = 304;
+        } else {
+            response.body = "v1";
+            bodies++;
+        }
+        return response;
+    });
+    HttpClient client(loopback_transport, complete, loopback_config());
+
+    CHECK(get(client, server.url("/feed")) == "v1");
+    CHECK(get(client, server.url("/feed")) == "v1");
+    CHECK(g_status == 304);
+    CHECK(get(client, server.url("/feed")) == "v1");
+
+    CHECK(server.requests() == 3);
+    CHECK(bodies == 1);
+    CHECK(ifNoneMatch.size() == 3 && ifNoneMatch[0].empty() && ifNoneMatch[2] == "\"e1\"");
+}
+
+static void test_vary_keeps_variants_apart() {
+    TempCache temp;
+    LoopbackServer server([](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.headers = "Cache-Control: max-age=60\nVary: Accept-Language";
+        response.body = std::string(http_header(request.headers, "Accept-Language"));
+        return response;
+    });
+    HttpClient client(loopback_transport, complete, loopback_config());
+    std::string url = server.url("/greeting");
+
+    CHECK(get(client, url, R"({"Accept-Language":"en"})") == "en");
+    CHECK(get(client, url, R"({"Accept-Language":"hi"})") == "hi");
+    CHECK(server.requests() == 2);
+
+    // Both variants are cached; header names match in any case
+    CHECK(get(client, url, R"({"accept-language":"en"})") == "en");
+    CHECK(get(client, url, R"({"Accept-Language":"hi","X-Other":"1"})") == "hi");
+    CHECK(server.requests() == 2);
+
+    // No value is a variant of its own
+    CHECK(get(client, url).empty());
+    CHECK(server.requests() == 3);
+}
+
+static void test_authorization_always_keyed() {
+    TempCache temp;
+    LoopbackServer server([](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.headers = "Cache-Control: max-age=60";
+        response.body = "private to " + std::string(http_header(request.headers, "Authorization"));
+        return response;
+    });
+    HttpClient client(loopback_transport, complete, loopback_config());
+    std::string url = server.url("/me");
+
+    CHECK(get(client, url, R"({"Authorization":"a"})") == "private to a");
+    CHECK(get(client, url, R"({"Authorization":"b"})") == "private to b");
+    CHECK(get(client, url, R"({"Authorization":"a"})") == "private to a");
+    CHECK(server.requests() == 2);
+}
+
+static void test_no_store_drops_entry() {
+    TempCache temp;
+    std::atomic<bool> noStore{false};
+    LoopbackServer server([&](const LoopbackRequest&) {
+        LoopbackResponse response;
+        response.headers = noStore ? "Cache-Control: no-store" : "Cache-Control: no-cache";
+        response.body = noStore ? "secret" : "public";
+        return response;
+    });
+    HttpClient client(loopback_transport, complete, loopback_config());
+    std::string url = server.url("/doc");
+
+    CHECK(get(client, url) == "public");
+    CHECK(temp.cache->lookup(url, "").has_value());
+    CHECK(temp.body_files() == 1);
+
+    // The revalidation answers no-store: the old entry and its body go
+    noStore = true;
+    CHECK(get(client, url) == "public");
+    CHECK(g_body == "secret");
+    CHECK(!temp.cache->lookup(url, "").has_value());
+    CHECK(temp.body_files() == 0);
+
+    CHECK(get(client, url) == "secret");
+    CHECK(server.requests() == 3);
+}
+
+static void test_bodies_stay_within_budget() {
+    TempCache temp(2500);
+    std::string headers = "Cache-Control: max-age=60";
+    for (int i = 0; i < 10; i++) {
+        std::string url = "http://example.com/" + std::to_string(i);
+        temp.cache->store(url, "", std::string(1000, static_cast<char>('a' + i)), headers);
+        // The entry just stored is never the one evicted
+        CHECK(temp.cache->lookup(url, "").has_value());
+        CHECK(temp.body_files() <= 2);
+    }
+
+    // A body shared by several URLs counts once
+    TempCache shared(2500);
+    for (int i = 0; i < 10; i++) {
+        shared.cache->store("http://example.com/" + std::to_string(i), "", std::string(1000, 'x'), headers);
+    }
+    CHECK(shared.body_files() == 1);
+    for (int i = 0; i < 10; i++) CHECK(shared.cache->lookup("http://example.com/" + std::to_string(i), "").has_value());
+}
+
+static void test_index_survives_reopen() {
+    TempCache temp;
+    temp.cache->store("http://example.com/a", R"({"Accept":"json"})", "body",
+                      "ETag: \"x\"\nCache-Control: max-age=60\nVary: Accept");
+    temp.reopen();
+
+    std::optional<HttpCacheEntry> entry = temp.cache->lookup("http://example.com/a", R"({"Accept":"json"})");
+    CHECK(entry.has_value());
+    CHECK(entry->etag == "\"x\"" && entry->vary == "accept" && entry->maxAge == 60);
+    std::string body;
+    CHECK(temp.cache->read_body(*entry, body) && body == "body");
+    CHECK(!temp.cache->lookup("http://example.com/a", R"({"Accept":"xml"})").has_value());
+
+    // A body file that went missing drops its entry
+    for (const auto& file : fs::directory_iterator(temp.directory)) {
+        if (file.path().filename() != "index") fs::remove(file.path());
+    }
+    CHECK(!temp.cache->read_body(*entry, body));
+    CHECK(!temp.cache->lookup("http://example.com/a", R"({"Accept":"json"})").has_value());
+}
+
+int main() {
+    RUN_TEST(test_fresh_entry_skips_network);
+    RUN_TEST(test_stale_entry_revalidates);
+    RUN_TEST(test_vary_keeps_variants_apart);
+    RUN_TEST(test_authorization_always_keyed);
+    RUN_TEST(test_no_store_drops_entry);
+    RUN_TEST(test_bodies_stay_within_budget);
+    RUN_TEST(test_index_survives_reopen);
+    return 0;
+}
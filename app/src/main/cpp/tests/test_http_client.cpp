@@ -0,0 +1,251 @@
+// HttpClient against a loopback HTTP/1.1 server (host/LoopbackHttp.h): per-host
+// limits, keep-alive reuse, coalescing and batches, cancellation, and shutdown
+// with calls still blocked in the transport.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "LoopbackHttp.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Answer {
+    int statusCode;
+    std::string body;
+};
+
+// Completions land here, keyed by request id
+static std::mutex g_mutex;
+static std::condition_variable g_answered;
+static std::map<HttpRequestId, Answer> g_answers;
+
+static void record(HttpCall& call, const std::vector<HttpRequestId>& waiters) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (HttpRequestId id : waiters) {
+        if (id != kCancelledWaiter) g_answers[id] = {call.statusCode, call.response};
+    }
+    g_answered.notify_all();
+}
+
+static bool wait_for_answers(size_t count, int timeoutMs = 5000) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    return g_answered.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return g_answers.size() >= count; });
+}
+
+static void reset_answers() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_answers.clear();
+}
+
+static HttpClientConfig loopback_config(int workers, int maxPerHost) {
+    HttpClientConfig config;
+    config.workers = workers;
+    config.maxPerHost = maxPerHost;
+    config.abort = loopback_abort;
+    return config;
+}
+
+// The path back as the body, after a short delay so requests overlap
+static LoopbackResponse echo_path(const LoopbackRequest& request) {
+    LoopbackResponse response;
+    response.body = request.target;
+    response.delayMs = 2;
+    return response;
+}
+
+static void test_answers_within_host_limit() {
+    reset_answers();
+    LoopbackServer server(echo_path);
+    uint64_t opened = loopback_connections_opened();
+    {
+        HttpClient client(loopback_transport, record, loopback_config(4, 2));
+        for (int id = 0; id < 40; id++) {
+            client.submit(id, {"GET", server.url("/item/" + std::to_string(id)), "", ""});
+        }
+        CHECK(wait_for_answers(40));
+    }
+
+    for (int id = 0; id < 40; id++) {
+        CHECK(g_answers[id].statusCode == 200);
+        CHECK(g_answers[id].body == "/item/" + std::to_string(id));
+    }
+    CHECK(server.requests() == 40);
+    CHECK(server.peak_concurrency() <= 2);
+    // Keep-alive: at most one connection per worker thread
+    CHECK(loopback_connections_opened() - opened <= 4);
+    CHECK(server.connections() <= 4);
+}
+
+static void test_request_headers_and_body() {
+    reset_answers();
+    LoopbackServer server([](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.status = 201;
+        response.body = request.method + " " + std::string(http_header(request.headers, "X-Token")) + " " +
+                        request.body;
+        return response;
+    });
+    {
+        HttpClient client(loopback_transport, record, loopback_config(1, 1));
+        client.submit(1, {"POST", server.url("/items"), "{\"n\":1}", R"({"X-Token":"a\"b"})"});
+        CHECK(wait_for_answers(1));
+    }
+    CHECK(g_answers[1].statusCode == 201);
+    CHECK(g_answers[1].body == "POST a\"b {\"n\":1}");
+}
+
+static void test_connection_refused() {
+    reset_answers();
+    std::string url;
+    {
+        // A port nobody listens on any more
+        LoopbackServer gone(echo_path);
+        url = gone.url("/");
+    }
+    {
+        HttpClient client(loopback_transport, record, loopback_config(1, 1));
+        client.submit(1, {"GET", url, "", ""});
+        CHECK(wait_for_answers(1));
+    }
+    CHECK(g_answers[1].statusCode == 0);
+    CHECK(g_answers[1].body.rfind("Error", 0) == 0);
+}
+
+static void test_cancel_queued_and_running() {
+    reset_answers();
+    LoopbackServer server([](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.hang = request.target == "/hang";
+        response.body = "ok";
+        return response;
+    });
+    HttpClient client(loopback_transport, record, loopback_config(2, 1));
+
+    client.submit(1, {"GET", server.url("/hang"), "", ""});
+    client.submit(2, {"GET", server.url("/queued"), "", ""});  // behind 1: one per host
+    while (server.requests() < 1) std::this_thread::yield();
+
+    // Queued: dropped without reaching the server
+    CHECK(client.cancel(2));
+    CHECK(!client.cancel(2));
+
+    // Running: the abort closes its socket, so the worker is free again at once
+    auto start = Clock::now();
+    CHECK(client.cancel(1));
+    client.submit(3, {"GET", server.url("/after"), "", ""});
+    CHECK(wait_for_answers(1, 2000));
+    CHECK(Clock::now() - start < std::chrono::seconds(2));
+
+    CHECK(g_answers.size() == 1);
+    CHECK(g_answers[3].statusCode == 200);
+    CHECK(server.requests() == 2);
+}
+
+static void test_identical_gets_coalesce() {
+    reset_answers();
+    LoopbackServer server(echo_path);
+    {
+        HttpClient client(loopback_transport, record, loopback_config(2, 2));
+        for (int id = 0; id < 10; id++) client.submit(id, {"GET", server.url("/same"), "", ""});
+        // POST is never shared
+        for (int id = 10; id < 13; id++) client.submit(id, {"POST", server.url("/post"), "x", ""});
+        CHECK(wait_for_answers(13));
+    }
+    for (int id = 0; id < 10; id++) CHECK(g_answers[id].body == "/same");
+    CHECK(server.requests() == 1 + 3);
+}
+
+static void test_batch_joinable_while_a_waiter_remains() {
+    reset_answers();
+    LoopbackServer server([](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.body = request.body;
+        return response;
+    });
+    HttpClient client(loopback_transport, record, loopback_config(1, 1));
+    auto add = [](const char* query) {
+        return [query](HttpRequest& request) {
+            request.body.back() = ',';
+            request.body += query;
+            request.body += ']';
+        };
+    };
+
+    HttpRequest batch{"POST", server.url("/batch"), "[1]", ""};
+    batch.batch = true;
+    batch.notBefore = Clock::now() + std::chrono::milliseconds(200);
+    client.submit(1, std::move(batch));
+    CHECK(client.join(1, 2, add("2")));
+
+    // The waiter that opened the batch leaves; the batch stays open for the others
+    CHECK(client.cancel(1));
+    CHECK(client.queued(1));
+    CHECK(client.join(1, 3, add("3")));
+
+    CHECK(wait_for_answers(2));
+    CHECK(g_answers[2].body == "[1,2,3]");
+    CHECK(g_answers[3].body == "[1,2,3]");
+    CHECK(server.requests() == 1);
+    CHECK(!client.queued(1));
+    CHECK(!client.join(1, 4, add("4")));
+}
+
+static void test_shutdown_aborts_blocked_calls() {
+    reset_answers();
+    LoopbackServer server([](const LoopbackRequest&) {
+        LoopbackResponse response;
+        response.hang = true;
+        return response;
+    });
+
+    auto start = Clock::now();
+    {
+        HttpClient client(loopback_transport, record, loopback_config(4, 4));
+        for (int id = 0; id < 8; id++) client.submit(id, {"GET", server.url("/slow/" + std::to_string(id)), "", ""});
+        while (server.requests() < 4) std::this_thread::yield();
+        start = Clock::now();
+        // Without the abort this would wait for responses that never come
+    }
+    CHECK(Clock::now() - start < std::chrono::seconds(1));
+    CHECK(g_answers.empty());
+    CHECK(server.requests() == 4);
+}
+
+static void test_body_reserved_from_content_length() {
+    HttpCall sized;
+    sized.set_response_headers("Content-Type: application/json\nContent-Length: 100000\n");
+    CHECK(sized.response.capacity() >= 100000);
+    std::string body(100000, 'x');
+    const char* before = sized.response.data();
+    for (size_t offset = 0; offset < body.size(); offset += 4096) {
+        CHECK(sized.append(body.data() + offset, std::min<size_t>(4096, body.size() - offset)));
+    }
+    CHECK(sized.response == body);
+    CHECK(sized.response.data() == before);  // never reallocated
+
+    // Encoded bodies decode to an unknown size, and nonsense is ignored
+    for (const char* headers : {"Content-Length: 100000\nContent-Encoding: gzip\n", "Content-Length: -5\n",
+                                "Content-Length: 12abc\n", "Content-Length: 99999999999999\n"}) {
+        HttpCall call;
+        call.set_response_headers(headers);
+        CHECK(call.response.capacity() < 100000);
+    }
+}
+
+int main() {
+    RUN_TEST(test_answers_within_host_limit);
+    RUN_TEST(test_request_headers_and_body);
+    RUN_TEST(test_connection_refused);
+    RUN_TEST(test_cancel_queued_and_running);
+    RUN_TEST(test_identical_gets_coalesce);
+    RUN_TEST(test_batch_joinable_while_a_waiter_remains);
+    RUN_TEST(test_shutdown_aborts_blocked_calls);
+    RUN_TEST(test_body_reserved_from_content_length);
+    return 0;
+}
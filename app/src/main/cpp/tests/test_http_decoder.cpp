@@ -0,0 +1,162 @@
+// HttpDecoder on gzip, zlib-wrapped and raw deflate bodies fed in chunks of any
+// size, multi-member gzip, truncated and corrupt input, and a gzip response
+// decoded end to end through HttpClient.
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "check.h"
+#include "HttpDecoder.h"
+#include "LoopbackHttp.h"
+
+// windowBits: 15 + 16 gzip, 15 zlib, -15 raw deflate
+static std::string compress(const std::string& input, int windowBits) {
+    z_stream zs{};
+    CHECK(deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string out(deflateBound(&zs, static_cast<uLong>(input.size())), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in = static_cast<uInt>(input.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+    CHECK(deflate(&zs, Z_FINISH) == Z_STREAM_END);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return out;
+}
+
+static std::string sample_text(size_t size) {
+    std::string text;
+    for (int i = 0; text.size() < size; i++) text += "{\"id\":" + std::to_string(i) + ",\"title\":\"Bhajan\"},";
+    text.resize(size);
+    return text;
+}
+
+// Decodes `encoded` fed `chunk` bytes at a time; false if the decoder refused it
+static bool decode_in_chunks(std::string_view encoding, const std::string& encoded, size_t chunk,
+                             std::string& out, bool& truncated) {
+    std::unique_ptr<HttpDecoder> decoder = HttpDecoder::for_encoding(encoding);
+    CHECK(decoder != nullptr);
+    out.clear();
+    for (size_t at = 0; at < encoded.size(); at += chunk) {
+        if (!decoder->decode(std::string_view(encoded).substr(at, chunk), out)) return false;
+    }
+    truncated = decoder->truncated();
+    return true;
+}
+
+static void test_encodings_in_any_chunking() {
+    std::string text = sample_text(200 * 1024);
+    struct Case {
+        const char* encoding;
+        int windowBits;
+    };
+    for (Case c : {Case{"gzip", 15 + 16}, Case{"x-gzip", 15 + 16}, Case{"deflate", 15}, Case{"deflate", -15}}) {
+        std::string encoded = compress(text, c.windowBits);
+        for (size_t chunk : {size_t(1), size_t(7), size_t(4096), encoded.size()}) {
+            std::string out;
+            bool truncated = true;
+            CHECK(decode_in_chunks(c.encoding, encoded, chunk, out, truncated));
+            CHECK(!truncated);
+            CHECK(out == text);
+        }
+    }
+}
+
+static void test_encoding_names() {
+    CHECK(HttpDecoder::for_encoding(" GZip ") != nullptr);
+    CHECK(HttpDecoder::for_encoding("Deflate") != nullptr);
+    CHECK(HttpDecoder::for_encoding("") == nullptr);
+    CHECK(HttpDecoder::for_encoding("identity") == nullptr);
+    CHECK(HttpDecoder::for_encoding("br") == nullptr);
+}
+
+static void test_multi_member_gzip() {
+    std::string encoded = compress("first part, ", 15 + 16) + compress("second part", 15 + 16);
+    for (size_t chunk : {size_t(1), size_t(5), encoded.size()}) {
+        std::string out;
+        bool truncated = true;
+        CHECK(decode_in_chunks("gzip", encoded, chunk, out, truncated));
+        CHECK(!truncated);
+        CHECK(out == "first part, second part");
+    }
+}
+
+static void test_truncated_and_corrupt_input() {
+    std::string text = sample_text(64 * 1024);
+    std::string encoded = compress(text, 15 + 16);
+
+    std::string out;
+    bool truncated = false;
+    CHECK(decode_in_chunks("gzip", encoded.substr(0, encoded.size() / 2), 1024, out, truncated));
+    CHECK(truncated);
+    CHECK(out.size() < text.size());
+    CHECK(text.compare(0, out.size(), out) == 0);
+
+    std::string corrupt = encoded;
+    corrupt[corrupt.size() / 2] ^= 0x55;
+    corrupt[corrupt.size() / 2 + 1] ^= 0x55;
+    bool refused = !decode_in_chunks("gzip", corrupt, 1024, out, truncated);
+    CHECK(refused || out != text);
+
+    CHECK(!decode_in_chunks("gzip", "not compressed at all", 4, out, truncated));
+}
+
+static std::mutex g_mutex;
+static std::condition_variable g_done;
+static bool g_finished = false;
+static int g_status = -1;
+static std::string g_body;
+
+static void record(HttpCall& call, const std::vector<HttpRequestId>&) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_status = call.statusCode;
+    g_body = call.response;
+    g_finished = true;
+    g_done.notify_all();
+}
+
+static void fetch(HttpClient& client, const std::string& url) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    g_finished = false;
+    lock.unlock();
+    client.submit(1, {"GET", url, "", ""});
+    lock.lock();
+    CHECK(g_done.wait_for(lock, std::chrono::seconds(5), [] { return g_finished; }));
+}
+
+static void test_gzip_response_through_client() {
+    std::string text = sample_text(100 * 1024);
+    std::string encoded = compress(text, 15 + 16);
+    LoopbackServer server([&](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.headers = "Content-Encoding: gzip";
+        response.body = request.target == "/cut" ? encoded.substr(0, encoded.size() - 20) : encoded;
+        return response;
+    });
+
+    HttpClientConfig config;
+    config.workers = 1;
+    config.abort = loopback_abort;
+    HttpClient client(loopback_transport, record, config);
+
+    fetch(client, server.url("/feed"));
+    CHECK(g_status == 200);
+    CHECK(g_body == text);
+
+    // A body that ends mid-stream fails the call instead of passing on half of it
+    fetch(client, server.url("/cut"));
+    CHECK(g_status == 0);
+}
+
+int main() {
+    RUN_TEST(test_encodings_in_any_chunking);
+    RUN_TEST(test_encoding_names);
+    RUN_TEST(test_multi_member_gzip);
+    RUN_TEST(test_truncated_and_corrupt_input);
+    RUN_TEST(test_gzip_response_through_client);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// JsonArrayStream, the element splitter behind android_http_get_stream: the same
+// elements whatever the chunking, brackets and quotes inside strings, nested
+// arrays, whitespace anywhere between tokens, a truncated final element, and
+// text that is not an array or an element over the size limit.
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "check.h"
+#include "JsonArrayStream.h"
+
+using Elements = std::vector<std::string>;
+
+static Elements feed_all(std::string_view json, bool* finished = nullptr) {
+    JsonArrayStream stream;
+    Elements out;
+    CHECK(stream.feed(json, out));
+    CHECK(stream.count() == out.size());
+    if (finished) *finished = stream.finished();
+    return out;
+}
+
+// Every way of cutting `json` in two, and one byte at a time, gives `expected`
+static void check_any_chunking(std::string_view json, const Elements& expected) {
+    bool finished = false;
+    CHECK(feed_all(json, &finished) == expected);
+    CHECK(finished);
+
+    for (size_t cut = 0; cut <= json.size(); cut++) {
+        JsonArrayStream stream;
+        Elements out;
+        CHECK(stream.feed(json.substr(0, cut), out));
+        CHECK(stream.feed(json.substr(cut), out));
+        CHECK(out == expected);
+        CHECK(stream.finished());
+    }
+
+    JsonArrayStream stream;
+    Elements out;
+    for (char c : json) CHECK(stream.feed(std::string_view(&c, 1), out));
+    CHECK(out == expected);
+    CHECK(stream.finished());
+}
+
+static void test_elements_split_across_chunks() {
+    check_any_chunking(R"([{"id":1,"title":"One"},{"id":2,"title":"Two"}])",
+                       {R"({"id":1,"title":"One"})", R"({"id":2,"title":"Two"})"});
+    check_any_chunking(R"([12,-3.5e2,true,false,null,"s"])",
+                       {"12", "-3.5e2", "true", "false", "null", R"("s")"});
+    check_any_chunking("[]", {});
+}
+
+static void test_quotes_and_brackets_inside_strings() {
+    // Escaped quotes and backslashes, and brackets and commas that are string content
+    check_any_chunking(R"([{"t":"say \"hi\", ok]"},"}{][","a\\",{"k":"\\\"}"}])",
+                       {R"({"t":"say \"hi\", ok]"})", R"("}{][")", R"("a\\")", R"({"k":"\\\"}"})"});
+    check_any_chunking(R"(["]\"","x"])", {R"("]\"")", R"("x")"});
+}
+
+static void test_nested_arrays() {
+    check_any_chunking(R"([[1,[2,3]],[],{"a":[{"b":[]}]},[[["deep"]]]])",
+                       {"[1,[2,3]]", "[]", R"({"a":[{"b":[]}]})", R"([[["deep"]]])"});
+}
+
+static void test_whitespace_between_tokens() {
+    check_any_chunking(" \n[ \t{\"a\" : 1} ,\r\n 2 ,\"b\"\n, [ 3 ] ] \n",
+                       {"{\"a\" : 1}", "2", "\"b\"", "[ 3 ]"});
+}
+
+static void test_truncated_final_element() {
+    JsonArrayStream stream;
+    Elements out;
+    CHECK(stream.feed(R"([{"id":1},{"id":2,"title":"Tw)", out));
+    CHECK((out == Elements{R"({"id":1})"}));
+    CHECK(!stream.finished() && !stream.failed());
+
+    // A number is only complete at its delimiter
+    JsonArrayStream numbers;
+    out.clear();
+    CHECK(numbers.feed("[1,23", out));
+    CHECK((out == Elements{"1"}));
+    CHECK(!numbers.finished());
+    CHECK(numbers.feed("4]", out));
+    CHECK((out == Elements{"1", "234"}));
+    CHECK(numbers.finished());
+}
+
+static void test_not_an_array_fails_and_stays_failed() {
+    for (std::string_view bad : {R"({"a":1})", "[1,,2]", "[,1]", "[1 2]", "[1]x", "[1,]"}) {
+        JsonArrayStream stream;
+        Elements out;
+        CHECK(!stream.feed(bad, out));
+        CHECK(stream.failed());
+        CHECK(!stream.feed("[1]", out));
+    }
+}
+
+static void test_element_over_the_limit_fails() {
+    JsonArrayStream stream(16);
+    Elements out;
+    CHECK(stream.feed(R"(["short",")", out));
+    CHECK(out.size() == 1);
+    CHECK(stream.feed("0123456789", out));
+    CHECK(!stream.feed("0123456789", out));
+    CHECK(stream.failed() && out.size() == 1);
+}
+
+int main() {
+    RUN_TEST(test_elements_split_across_chunks);
+    RUN_TEST(test_quotes_and_brackets_inside_strings);
+    RUN_TEST(test_nested_arrays);
+    RUN_TEST(test_whitespace_between_tokens);
+    RUN_TEST(test_truncated_final_element);
+    RUN_TEST(test_not_an_array_fails_and_stays_failed);
+    RUN_TEST(test_element_over_the_limit_fails);
+    return 0;
+}
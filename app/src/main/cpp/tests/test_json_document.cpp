@@ -0,0 +1,117 @@
+// JsonDocument against RFC 8259: what it must accept, what it must refuse (numbers,
+// escapes, control characters, trailing text, truncation), and lookups on the
+// parsed tape by field, index and path.
+
+#include <string>
+#include "check.h"
+#include "JsonDocument.h"
+
+static bool parses(const std::string& text) {
+    JsonDocument document;
+    return document.parse(text);
+}
+
+static void test_accepts_valid_documents() {
+    const char* valid[] = {
+        "0", "-0", "1", "-12", "3.25", "-0.5", "1e9", "1E+9", "2.5e-3", "10",
+        "\"\"", "\"a b\"", "\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"", "\"\\u00e9\\uD83D\\uDE00\"",
+        "\"\xe0\xa4\xad\"", "true", "false", "null",
+        "[]", "{}", " [ 1 , 2 ] ", "\t\r\n{\"a\" : [ {}, [], \"x\" ] }\n",
+        "[[[[[[[[[[]]]]]]]]]]", "{\"\":0}", "{\"a\":1,\"a\":2}",
+    };
+    for (const char* text : valid) {
+        if (!parses(text)) std::fprintf(stderr, "refused: %s\n", text);
+        CHECK(parses(text));
+    }
+}
+
+static void test_refuses_invalid_documents() {
+    const char* invalid[] = {
+        // numbers
+        "--1", "+1", "1.e", "1.", ".5", "0012", "01", "1e", "1e+", "-", "1.5.2", "0x10", "1ee2", "Infinity", "NaN",
+        // strings
+        "\"abc", "\"\\x\"", "\"\\u12\"", "\"\\u12G4\"", "\"tab\there\"", "\"line\nbreak\"", "'a'", "\"\\",
+        // literals and structure
+        "tru", "nul", "truex", "[1,]", "[,1]", "[1 2]", "{\"a\"}", "{\"a\":}", "{a:1}", "{\"a\":1,}",
+        "[", "]", "{", "[1]]", "1 2", "", "   ",
+    };
+    for (const char* text : invalid) {
+        if (parses(text)) std::fprintf(stderr, "accepted: %s\n", text);
+        CHECK(!parses(text));
+    }
+
+    // NUL is neither a number character nor allowed raw in a string
+    CHECK(!parses(std::string("1\0", 2)));
+    CHECK(!parses(std::string("[1,\0]", 5)));
+    CHECK(!parses(std::string("\"a\0b\"", 5)));
+
+    std::string deep(600, '[');
+    deep += std::string(600, ']');
+    CHECK(!parses(deep));
+}
+
+static void test_refused_document_is_empty() {
+    JsonDocument document;
+    CHECK(document.parse("{\"a\":1}"));
+    CHECK(!document.parse("{\"a\":1"));
+    CHECK(document.root() == JsonDocument::npos);
+    CHECK(document.find("a") == JsonDocument::npos);
+    CHECK(document.kind(document.root()) == JsonDocument::Kind::Null);
+    CHECK(document.size(0) == 0);
+}
+
+static void test_lookups() {
+    JsonDocument document;
+    CHECK(document.parse(R"({"items":[{"id":1,"title":"Om \"Jai\"","tags":["a","b"]},{"id":2,"title":"x"}],)"
+                         R"("count":2,"ok":true,"none":null,"esc\u0061ped":"\u00e9"})"));
+
+    uint32_t items = document.find("items");
+    CHECK(document.kind(items) == JsonDocument::Kind::Array);
+    CHECK(document.size(items) == 2);
+    CHECK(document.size(document.root()) == 5);
+    CHECK(document.value(document.find("items.0.title")) == "Om \"Jai\"");
+    CHECK(document.value(document.find("items.1.id")) == "2");
+    CHECK(document.value(document.find("items.0.tags.1")) == "b");
+    CHECK(document.kind(document.find("items.0.id")) == JsonDocument::Kind::Number);
+    CHECK(document.kind(document.find("ok")) == JsonDocument::Kind::Bool);
+    CHECK(document.kind(document.find("none")) == JsonDocument::Kind::Null);
+    CHECK(document.value(document.find("escaped")) == "\xc3\xa9");
+    CHECK(document.value(document.find("items.0")) == R"({"id":1,"title":"Om \"Jai\"","tags":["a","b"]})");
+
+    CHECK(document.find("items.2") == JsonDocument::npos);
+    CHECK(document.find("items.x") == JsonDocument::npos);
+    CHECK(document.find("items.-1") == JsonDocument::npos);
+    CHECK(document.find("count.0") == JsonDocument::npos);
+    CHECK(document.find("missing") == JsonDocument::npos);
+    CHECK(document.at(items, 5) == JsonDocument::npos);
+    CHECK(document.at(JsonDocument::npos, 0) == JsonDocument::npos);
+    CHECK(document.value(JsonDocument::npos).empty());
+
+    int fields = 0;
+    document.for_each_field(document.root(), [&](const std::string& key, uint32_t) {
+        CHECK(!key.empty());
+        fields++;
+    });
+    CHECK(fields == 5);
+}
+
+static void test_unicode_escapes() {
+    JsonDocument document;
+    CHECK(document.parse(R"(["\u0041", "\u00e9", "\u20ac", "\uD83D\uDE00", "\uD83D", "\uDE00x"])"));
+    CHECK(document.value(document.find("0")) == "A");
+    CHECK(document.value(document.find("1")) == "\xc3\xa9");
+    CHECK(document.value(document.find("2")) == "\xe2\x82\xac");
+    CHECK(document.value(document.find("3")) == "\xf0\x9f\x98\x80");
+    // Unpaired surrogates become U+FFFD
+    CHECK(document.value(document.find("4")) == "\xef\xbf\xbd");
+    CHECK(document.value(document.find("5")) == "\xef\xbf\xbdx");
+}
+
+int main() {
+    RUN_TEST(test_accepts_valid_documents);
+    RUN_TEST(test_refuses_invalid_documents);
+    RUN_TEST(test_refused_document_is_empty);
+    RUN_TEST(test_lookups);
+    RUN_TEST(test_unicode_escapes);
+    return 0;
+}
@@ -0,0 +1,208 @@
+// RecyclerStore: the range notifications each mutation turns into, and the
+// snapshots the UI thread binds from, which only move when a flushed commit is
+// adopted.
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "RecyclerStore.h"
+
+struct Notification {
+    UiOp op;
+    int32_t a, b, c;
+};
+
+static std::vector<Notification> flush(RecyclerStore& store) {
+    UiCommandBuffer buffer;
+    store.flush_notifications(buffer);
+    std::vector<Notification> out;
+    UiCommandReader reader(buffer.data(), buffer.size());
+    UiCommand command;
+    while (reader.next(command)) out.push_back({command.op, command.args[0], command.args[1], command.args[2]});
+    return out;
+}
+
+// Flushes and adopts every commit, as MainActivity does while applying the batch
+static std::vector<Notification> flush_and_adopt(RecyclerStore& store) {
+    std::vector<Notification> out = flush(store);
+    for (const Notification& n : out) {
+        if (n.op == UiOp::RecyclerViewCommit) store.adopt(n.a, n.b);
+    }
+    return out;
+}
+
+static bool is_range(const Notification& n, UiOp op, int32_t viewId, int32_t start, int32_t count) {
+    return n.op == op && n.a == viewId && n.b == start && n.c == count;
+}
+
+static void test_appends_coalesce_into_one_insert() {
+    RecyclerStore store;
+    for (int i = 0; i < 5; i++) store.append(7, "row " + std::to_string(i));
+
+    std::vector<Notification> ops = flush(store);
+    CHECK(ops.size() == 2);
+    CHECK(ops[0].op == UiOp::RecyclerViewCommit && ops[0].a == 7 && ops[0].b == 1);
+    CHECK(is_range(ops[1], UiOp::RecyclerViewInsert, 7, 0, 5));
+
+    // Nothing changed since: nothing to send
+    CHECK(flush(store).empty());
+}
+
+static void test_rows_published_with_their_notifications() {
+    RecyclerStore store;
+    store.append(7, "a");
+    store.append(7, "b");
+
+    // Not flushed, then flushed but not yet applied on the UI thread
+    CHECK(store.row(7, 0).empty());
+    std::vector<Notification> ops = flush(store);
+    CHECK(store.row(7, 0).empty());
+
+    store.adopt(7, ops[0].b);
+    CHECK(store.row(7, 0) == "a");
+    CHECK(store.row(7, 1) == "b");
+    CHECK(store.row(7, 2).empty());
+    CHECK(store.row(7, -1).empty());
+
+    // Later mutations stay invisible until their commit is adopted
+    store.clear(7);
+    store.append(7, "c");
+    CHECK(store.row(7, 0) == "a");
+    flush_and_adopt(store);
+    CHECK(store.row(7, 0) == "c");
+    CHECK(store.row(7, 1).empty());
+}
+
+static void test_commits_adopted_in_order() {
+    RecyclerStore store;
+    store.append(3, "one");
+    std::vector<Notification> first = flush(store);
+    store.append(3, "two");
+    std::vector<Notification> second = flush(store);
+
+    store.adopt(3, first[0].b);
+    CHECK(store.row(3, 0) == "one");
+    CHECK(store.row(3, 1).empty());
+    store.adopt(3, second[0].b);
+    CHECK(store.row(3, 1) == "two");
+
+    // A stale commit does not move the snapshot back
+    store.adopt(3, first[0].b);
+    CHECK(store.row(3, 1) == "two");
+}
+
+static void test_snapshot_survives_appends_across_blocks() {
+    RecyclerStore store;
+    const size_t n = RecyclerRows::kBlockRows + 10;
+    for (size_t i = 0; i < n; i++) store.append(1, std::to_string(i));
+    flush_and_adopt(store);
+
+    // Appending into the shared last block must not change what the snapshot reads
+    for (size_t i = n; i < 3 * RecyclerRows::kBlockRows; i++) store.append(1, "new " + std::to_string(i));
+    for (size_t i = 0; i < n; i++) CHECK(store.row(1, static_cast<int>(i)) == std::to_string(i));
+    CHECK(store.row(1, static_cast<int>(n)).empty());
+
+    std::vector<Notification> ops = flush_and_adopt(store);
+    CHECK(is_range(ops[1], UiOp::RecyclerViewInsert, 1, static_cast<int32_t>(n),
+                   static_cast<int32_t>(3 * RecyclerRows::kBlockRows - n)));
+    CHECK(store.row(1, static_cast<int>(n)) == "new " + std::to_string(n));
+    CHECK(store.row(1, static_cast<int>(n) - 1) == std::to_string(n - 1));
+}
+
+static void test_replace_diffs_by_prefix_and_suffix() {
+    RecyclerStore store;
+    store.replace(2, {"a", "b", "c", "d"});
+    flush_and_adopt(store);
+
+    // b, c -> x, y, z: two changed, one inserted after them
+    store.replace(2, {"a", "x", "y", "z", "d"});
+    std::vector<Notification> ops = flush_and_adopt(store);
+    CHECK(ops.size() == 3);
+    CHECK(is_range(ops[1], UiOp::RecyclerViewChange, 2, 1, 2));
+    CHECK(is_range(ops[2], UiOp::RecyclerViewInsert, 2, 3, 1));
+    CHECK(store.row(2, 3) == "z");
+
+    // Shrinks to the ends: the middle is removed
+    store.replace(2, {"a", "d"});
+    ops = flush_and_adopt(store);
+    CHECK(ops.size() == 2);
+    CHECK(is_range(ops[1], UiOp::RecyclerViewRemove, 2, 1, 3));
+    CHECK(store.row(2, 1) == "d");
+
+    // Same rows: no notification and no commit
+    store.replace(2, {"a", "d"});
+    CHECK(flush(store).empty());
+}
+
+static void test_erase_drops_rows() {
+    RecyclerStore store;
+    store.append(4, "a");
+    flush_and_adopt(store);
+    store.erase(4);
+    CHECK(store.row(4, 0).empty());
+    store.adopt(4, 1);  // late commit of an erased view
+    CHECK(store.row(4, 0).empty());
+    CHECK(flush(store).empty());
+}
+
+// The UI thread binds while the VM thread keeps appending and flushing; every
+// row it reads must match the count its snapshot claims
+static void test_concurrent_bind_sees_consistent_rows() {
+    RecyclerStore store;
+    std::vector<std::vector<Notification>> batches;
+    std::mutex mutex;
+    bool done = false;
+
+    std::thread vm([&] {
+        for (int i = 0; i < 20000; i++) {
+            store.append(9, std::to_string(i));
+            if (i % 37 == 0) {
+                std::vector<Notification> ops = flush(store);
+                std::lock_guard<std::mutex> lock(mutex);
+                batches.push_back(std::move(ops));
+            }
+        }
+        std::vector<Notification> ops = flush(store);
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back(std::move(ops));
+        done = true;
+    });
+
+    int count = 0;
+    size_t applied = 0;
+    while (true) {
+        std::vector<std::vector<Notification>> pending;
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.assign(batches.begin() + static_cast<long>(applied), batches.end());
+            applied = batches.size();
+            finished = done;
+        }
+        for (const auto& ops : pending) {
+            for (const Notification& n : ops) {
+                if (n.op == UiOp::RecyclerViewCommit) store.adopt(n.a, n.b);
+                if (n.op == UiOp::RecyclerViewInsert) count += n.c;
+            }
+            // Bind the newest rows and one past the end
+            if (count > 0) CHECK(store.row(9, count - 1) == std::to_string(count - 1));
+            CHECK(store.row(9, count).empty());
+        }
+        if (finished && pending.empty()) break;
+    }
+    vm.join();
+    CHECK(count == 20000);
+}
+
+int main() {
+    RUN_TEST(test_appends_coalesce_into_one_insert);
+    RUN_TEST(test_rows_published_with_their_notifications);
+    RUN_TEST(test_commits_adopted_in_order);
+    RUN_TEST(test_snapshot_survives_appends_across_blocks);
+    RUN_TEST(test_replace_diffs_by_prefix_and_suffix);
+    RUN_TEST(test_erase_drops_rows);
+    RUN_TEST(test_concurrent_bind_sees_consistent_rows);
+    return 0;
+}
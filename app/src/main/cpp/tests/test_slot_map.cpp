@@ -0,0 +1,132 @@
+// SlotMap, the store behind CallbackRegistry and json_parse handles: slot reuse
+// bumps the generation so stale handles stop resolving, the 11-bit generation
+// wraps without ever issuing 0, and the 20-bit index caps the live count.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "SlotMap.h"
+
+static uint32_t index_of(SlotHandle handle) { return static_cast<uint32_t>(handle) & ((1u << 20) - 1); }
+static uint32_t generation_of(SlotHandle handle) { return static_cast<uint32_t>(handle) >> 20; }
+
+static void test_insert_find_release() {
+    SlotMap<std::string> map;
+    SlotHandle a = map.insert("a");
+    SlotHandle b = map.insert("b");
+    CHECK(a > 0 && b > 0 && a != b);
+    CHECK(map.size() == 2);
+    CHECK(*map.find(a) == "a" && *map.find(b) == "b");
+
+    CHECK(map.release(a));
+    CHECK(!map.release(a));
+    CHECK(map.find(a) == nullptr);
+    CHECK(*map.find(b) == "b");
+    CHECK(map.size() == 1);
+
+    CHECK(map.find(kInvalidSlot) == nullptr);
+    CHECK(map.find(0) == nullptr);
+    CHECK(map.find(static_cast<SlotHandle>((1u << 20) | 999)) == nullptr);
+}
+
+static void test_reused_slot_rejects_stale_handle() {
+    SlotMap<int> map;
+    SlotHandle first = map.insert(1);
+    map.release(first);
+    SlotHandle second = map.insert(2);
+
+    // Same slot, next generation
+    CHECK(index_of(second) == index_of(first));
+    CHECK(generation_of(second) == generation_of(first) + 1);
+    CHECK(map.find(first) == nullptr);
+    CHECK(!map.release(first));
+    CHECK(*map.find(second) == 2);
+}
+
+static void test_generation_wraps_past_zero() {
+    SlotMap<int> map;
+    SlotHandle handle = map.insert(0);
+    uint32_t index = index_of(handle);
+    CHECK(generation_of(handle) == 1);
+
+    std::vector<SlotHandle> seen{handle};
+    for (int i = 1; i <= 2047; i++) {
+        map.release(handle);
+        handle = map.insert(i);
+        CHECK(index_of(handle) == index);
+        CHECK(handle > 0);
+        seen.push_back(handle);
+    }
+    // Generations 1..2047, then back to 1 rather than 0
+    CHECK(generation_of(seen[2046]) == 2047);
+    CHECK(generation_of(handle) == 1);
+    CHECK(*map.find(handle) == 2047);
+    // Only the handle from 2047 releases ago aliases the live one
+    CHECK(std::count(seen.begin(), seen.end(), handle) == 2);
+    for (size_t i = 1; i + 1 < seen.size(); i++) CHECK(map.find(seen[i]) == nullptr);
+}
+
+static void test_index_space_is_capped() {
+    SlotMap<int> map;
+    SlotHandle last = kInvalidSlot;
+    for (size_t i = 0; i < SlotMap<int>::kMaxSlots; i++) last = map.insert(static_cast<int>(i));
+    CHECK(index_of(last) == (1u << 20) - 1);
+    CHECK(last > 0);
+    CHECK(map.insert(-1) == kInvalidSlot);
+    CHECK(map.size() == SlotMap<int>::kMaxSlots);
+
+    // A released slot makes room again
+    CHECK(map.release(last));
+    SlotHandle again = map.insert(-1);
+    CHECK(again != kInvalidSlot && again != last);
+    CHECK(index_of(again) == index_of(last));
+}
+
+static void test_values_stay_dense() {
+    SlotMap<int> map;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < 100; i++) handles.push_back(map.insert(i));
+    for (int i = 0; i < 100; i += 3) map.release(handles[i]);
+
+    CHECK(map.values().size() == map.size());
+    int sum = 0;
+    for (int value : map.values()) {
+        CHECK(value % 3 != 0);
+        sum += value;
+    }
+    int expected = 0;
+    for (int i = 0; i < 100; i++) {
+        if (i % 3 != 0) {
+            expected += i;
+            CHECK(*map.find(handles[i]) == i);
+        }
+    }
+    CHECK(sum == expected);
+}
+
+static void test_release_if_and_clear() {
+    SlotMap<int> map;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < 10; i++) handles.push_back(map.insert(i));
+
+    CHECK(map.release_if([](int value) { return value % 2 == 0; }) == 5);
+    for (int i = 0; i < 10; i++) CHECK((map.find(handles[i]) != nullptr) == (i % 2 == 1));
+
+    map.clear();
+    CHECK(map.size() == 0);
+    for (SlotHandle handle : handles) CHECK(map.find(handle) == nullptr);
+    // Slots come back under new generations
+    SlotHandle fresh = map.insert(42);
+    CHECK(std::find(handles.begin(), handles.end(), fresh) == handles.end());
+}
+
+int main() {
+    RUN_TEST(test_insert_find_release);
+    RUN_TEST(test_reused_slot_rejects_stale_handle);
+    RUN_TEST(test_generation_wraps_past_zero);
+    RUN_TEST(test_index_space_is_capped);
+    RUN_TEST(test_values_stay_dense);
+    RUN_TEST(test_release_if_and_clear);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// StyleSheet: declaration parsing, CSS order for padding and margin, and style
+// interning, and clearing with the VM.
+
+#include <string_view>
+#include "check.h"
+#include "StyleSheet.h"
+
+static int32_t field(const Style& style, StyleField f) {
+    auto i = static_cast<size_t>(f);
+    CHECK(style.mask & (1u << i));
+    return style.values[i];
+}
+
+static void check_margin(std::string_view source, int32_t left, int32_t top, int32_t right, int32_t bottom) {
+    Style style;
+    CHECK(StyleSheet::parse(source, style));
+    CHECK(field(style, StyleField::MarginLeft) == left);
+    CHECK(field(style, StyleField::MarginTop) == top);
+    CHECK(field(style, StyleField::MarginRight) == right);
+    CHECK(field(style, StyleField::MarginBottom) == bottom);
+}
+
+static void test_sides_in_css_order() {
+    check_margin("margin: 8", 8, 8, 8, 8);
+    check_margin("margin: 12 16", 16, 12, 16, 12);      // vertical horizontal
+    check_margin("margin: 1 2 3", 2, 1, 2, 3);          // top horizontal bottom
+    check_margin("margin: 1 2 3 4", 4, 1, 2, 3);        // top right bottom left
+
+    Style style;
+    CHECK(StyleSheet::parse("padding: 20 16 20 12", style));
+    CHECK(field(style, StyleField::PaddingTop) == 20);
+    CHECK(field(style, StyleField::PaddingRight) == 16);
+    CHECK(field(style, StyleField::PaddingBottom) == 20);
+    CHECK(field(style, StyleField::PaddingLeft) == 12);
+    CHECK(!(style.mask & (1u << static_cast<size_t>(StyleField::MarginTop))));
+}
+
+static void test_values_and_errors() {
+    Style style;
+    CHECK(StyleSheet::parse("background-color: #FFFFFF; text-color: #80212121; text-size: 18", style));
+    CHECK(field(style, StyleField::BackgroundColor) == static_cast<int32_t>(0xFFFFFFFF));
+    CHECK(field(style, StyleField::TextColor) == static_cast<int32_t>(0x80212121));
+    CHECK(field(style, StyleField::TextSize) == 18);
+
+    CHECK(!StyleSheet::parse("margin: 1 2 3 4 5", style));
+    CHECK(!StyleSheet::parse("text-size: 1 2", style));
+    CHECK(!StyleSheet::parse("no-such-property: 1", style));
+}
+
+static void test_styles_interned() {
+    StyleSheet sheet;
+    bool created = false;
+    int id = sheet.define("margin: 12 16", created);
+    CHECK(id == 1 && created);
+
+    // Same fields from a different source: same id, nothing new to send
+    CHECK(sheet.define("margin: 12 16 12 16", created) == id);
+    CHECK(!created);
+    CHECK(sheet.define("margin: 12 16", created) == id);
+    CHECK(!created);
+
+    CHECK(sheet.define("margin: 16 12", created) == 2 && created);
+    CHECK(sheet.define("margin:", created) == -1);
+    CHECK(sheet.find(2) != nullptr);
+    CHECK(sheet.find(3) == nullptr);
+}
+
+// What android_reset_vm_state relies on: after a clear the same style is new
+// again, so its DefineStyle is sent before the next VM applies it
+static void test_clear_redefines_styles() {
+    StyleSheet sheet;
+    bool created = false;
+    CHECK(sheet.define("padding: 8", created) == 1 && created);
+    CHECK(sheet.define("margin: 4", created) == 2 && created);
+
+    sheet.clear();
+    CHECK(sheet.find(1) == nullptr && sheet.find(2) == nullptr);
+
+    CHECK(sheet.define("margin: 4", created) == 1 && created);
+    CHECK(field(*sheet.find(1), StyleField::MarginTop) == 4);
+    CHECK(sheet.define("margin: 4", created) == 1 && !created);
+    CHECK(sheet.define("padding: 8", created) == 2 && created);
+}
+
+int main() {
+    RUN_TEST(test_sides_in_css_order);
+    RUN_TEST(test_values_and_errors);
+    RUN_TEST(test_styles_interned);
+    RUN_TEST(test_clear_redefines_styles);
+    return 0;
+}
@@ -0,0 +1,157 @@
+// The per-thread trace rings behind DROPLET_TRACE: droplet_trace_dump() writes a
+// ring that never filled in full and in order, a ring that wrapped as its newest
+// kCapacity - 1 events (the oldest slot may be mid-overwrite), each thread's events
+// under that thread's index, and no torn event while its writer keeps going.
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "AndroidLog.h"
+
+// TraceRing::kCapacity in AndroidLog.cpp
+constexpr int kCapacity = 1024;
+
+static std::mutex g_lines_mutex;
+static std::vector<std::string> g_lines;
+
+extern "C" int __android_log_print(int, const char*, const char* fmt, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    std::lock_guard<std::mutex> lock(g_lines_mutex);
+    g_lines.emplace_back(line);
+    return 0;
+}
+
+struct DumpedEvent {
+    int thread;
+    unsigned long long timeNs;
+    int a, b, c;
+};
+
+// The events named `name` in one droplet_trace_dump(), in dump order
+static std::vector<DumpedEvent> dump(const char* name) {
+    {
+        std::lock_guard<std::mutex> lock(g_lines_mutex);
+        g_lines.clear();
+    }
+    droplet_trace_dump();
+
+    std::vector<DumpedEvent> events;
+    std::lock_guard<std::mutex> lock(g_lines_mutex);
+    for (const std::string& line : g_lines) {
+        DumpedEvent e{};
+        char eventName[64];
+        CHECK(std::sscanf(line.c_str(), "[t%d] %llu %63s %d %d %d", &e.thread, &e.timeNs, eventName,
+                          &e.a, &e.b, &e.c) == 6);
+        if (std::strcmp(eventName, name) == 0) events.push_back(e);
+    }
+    return events;
+}
+
+// Records `count` events named `name` on a new thread (so on a new ring)
+static void record_on_new_thread(const char* name, int count) {
+    std::thread([=] {
+        for (int i = 0; i < count; i++) droplet_trace_event(name, i, i * 2, -i);
+    }).join();
+}
+
+static void test_partial_ring_dumps_every_event_in_order() {
+    record_on_new_thread("partial", 100);
+    std::vector<DumpedEvent> events = dump("partial");
+    CHECK(events.size() == 100);
+    for (int i = 0; i < 100; i++) {
+        CHECK(events[i].a == i && events[i].b == i * 2 && events[i].c == -i);
+        if (i) CHECK(events[i].timeNs >= events[i - 1].timeNs);
+    }
+}
+
+static void test_full_ring_dumps_every_event() {
+    record_on_new_thread("full", kCapacity);
+    std::vector<DumpedEvent> events = dump("full");
+    // The next write would overwrite slot 0, so it is already treated as in flight
+    CHECK(events.size() == kCapacity - 1);
+    CHECK(events.front().a == 1 && events.back().a == kCapacity - 1);
+}
+
+static void test_wrapped_ring_dumps_the_newest_events_oldest_first() {
+    constexpr int kWritten = 3 * kCapacity + 17;
+    record_on_new_thread("wrapped", kWritten);
+    std::vector<DumpedEvent> events = dump("wrapped");
+    CHECK(events.size() == kCapacity - 1);
+    for (size_t i = 0; i < events.size(); i++) {
+        CHECK(events[i].a == kWritten - kCapacity + 1 + static_cast<int>(i));
+        CHECK(events[i].b == events[i].a * 2 && events[i].c == -events[i].a);
+        if (i) CHECK(events[i].timeNs >= events[i - 1].timeNs);
+    }
+}
+
+static void test_each_thread_dumps_under_its_own_index() {
+    constexpr int kThreads = 4;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 50; i++) droplet_trace_event("threads", t, i);
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    std::vector<DumpedEvent> events = dump("threads");
+    CHECK(events.size() == kThreads * 50);
+
+    // One contiguous, ordered run per ring, all from one writer
+    std::vector<bool> seen(kThreads, false);
+    for (size_t run = 0; run < events.size(); run += 50) {
+        int writer = events[run].a;
+        CHECK(writer >= 0 && writer < kThreads && !seen[writer]);
+        seen[writer] = true;
+        for (int i = 0; i < 50; i++) {
+            CHECK(events[run + i].thread == events[run].thread);
+            CHECK(events[run + i].a == writer && events[run + i].b == i);
+        }
+    }
+}
+
+static void test_dump_during_writes_has_no_torn_events() {
+    std::atomic<bool> done{false};
+    std::atomic<bool> started{false};
+    std::thread writer([&] {
+        for (int i = 0; !done.load(std::memory_order_relaxed); i++) {
+            droplet_trace_event("racing", i, i, i);
+            if (i == 2 * kCapacity) started = true;
+        }
+    });
+    while (!started) std::this_thread::yield();
+
+    // A dump the writer laps entirely while it copies comes out empty
+    int nonEmpty = 0;
+    for (int round = 0; round < 200; round++) {
+        std::vector<DumpedEvent> events = dump("racing");
+        CHECK(events.size() < kCapacity);
+        if (!events.empty()) nonEmpty++;
+        for (size_t i = 0; i < events.size(); i++) {
+            CHECK(events[i].a == events[i].b && events[i].b == events[i].c);
+            if (i) CHECK(events[i].a == events[i - 1].a + 1);
+        }
+    }
+    done = true;
+    writer.join();
+    CHECK(nonEmpty > 0);
+}
+
+int main() {
+    RUN_TEST(test_partial_ring_dumps_every_event_in_order);
+    RUN_TEST(test_full_ring_dumps_every_event);
+    RUN_TEST(test_wrapped_ring_dumps_the_newest_events_oldest_first);
+    RUN_TEST(test_each_thread_dumps_under_its_own_index);
+    RUN_TEST(test_dump_during_writes_has_no_torn_events);
+    return 0;
+}
@@ -0,0 +1,262 @@
+// UiCommandBuffer encoding against UiCommandReader, the host-side decoder, and
+// the opcode numbering and per-op argument counts against MainActivity.kt.
+//
+//   test_ui_command_buffer path/to/MainActivity.kt
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "StyleSheet.h"
+#include "UiCommandBuffer.h"
+
+static void test_round_trip() {
+    UiCommandBuffer buffer;
+    int32_t title = buffer.intern("Play");
+    buffer.emit(UiOp::CreateButton, {title, 1001, 7, -1});
+    buffer.emit(UiOp::SetViewPadding, {1001, 1, 2, 3, 4});
+    buffer.emit(UiOp::NavigateBack, {});
+    buffer.emit(UiOp::SetViewText, {1001, buffer.intern("Pause")});
+
+    UiCommandReader reader(buffer.data(), buffer.size());
+    UiCommand command;
+
+    CHECK(reader.next(command));
+    CHECK(command.op == UiOp::CreateButton);
+    CHECK(reader.string(command.args[0]) == "Play");
+    CHECK(command.args[1] == 1001 && command.args[2] == 7 && command.args[3] == -1);
+
+    CHECK(reader.next(command));
+    CHECK(command.op == UiOp::SetViewPadding);
+    for (int i = 1; i <= 4; i++) CHECK(command.args[i] == i);
+
+    CHECK(reader.next(command));
+    CHECK(command.op == UiOp::NavigateBack);
+
+    CHECK(reader.next(command));
+    CHECK(command.op == UiOp::SetViewText);
+    CHECK(reader.string(command.args[1]) == "Pause");
+
+    CHECK(!reader.next(command));
+}
+
+static void test_strings_interned_once() {
+    UiCommandBuffer buffer;
+    CHECK(buffer.intern("a") == 0);
+    CHECK(buffer.intern("") == 1);
+    CHECK(buffer.intern("a") == 0);
+    size_t size = buffer.size();
+    CHECK(buffer.intern("") == 1);
+    CHECK(buffer.size() == size);
+
+    // Non-ASCII text survives as UTF-8 bytes
+    const char* utf8 = "\xe0\xa4\xad\xe0\xa4\x9c\xe0\xa4\xa8";
+    buffer.emit(UiOp::ShowToast, {buffer.intern(utf8)});
+    UiCommandReader reader(buffer.data(), buffer.size());
+    UiCommand command;
+    CHECK(reader.next(command));
+    CHECK(reader.string(command.args[0]) == utf8);
+    CHECK(reader.string(5).empty());
+    CHECK(reader.string(-1).empty());
+}
+
+static void test_clear_resets_string_table() {
+    UiCommandBuffer buffer;
+    buffer.intern("x");
+    buffer.intern("y");
+    buffer.clear();
+    CHECK(buffer.empty());
+    // The next batch starts its own table
+    CHECK(buffer.intern("y") == 0);
+}
+
+static void test_little_endian_layout() {
+    UiCommandBuffer buffer;
+    buffer.emit(UiOp::RemoveView, {0x01020304});
+    buffer.emit(UiOp::ClearScreen, {-1});
+    const uint8_t expected[] = {
+        static_cast<uint8_t>(UiOp::RemoveView), 0x04, 0x03, 0x02, 0x01,
+        static_cast<uint8_t>(UiOp::ClearScreen), 0xff, 0xff, 0xff, 0xff,
+    };
+    CHECK(buffer.size() == sizeof(expected));
+    CHECK(std::memcmp(buffer.data(), expected, sizeof(expected)) == 0);
+}
+
+static void test_every_op_decodes_with_its_arity() {
+    UiCommandBuffer buffer;
+    int32_t args[kMaxUiOpArgs];
+    for (int i = 0; i < kMaxUiOpArgs; i++) args[i] = 100 + i;
+
+    for (int op = 1; op < static_cast<int>(UiOp::Count); op++) {
+        int arity = ui_op_arity(static_cast<UiOp>(op));
+        CHECK(arity >= 0 && arity <= kMaxUiOpArgs);
+        buffer.emit(static_cast<UiOp>(op), args, static_cast<size_t>(arity));
+    }
+
+    UiCommandReader reader(buffer.data(), buffer.size());
+    UiCommand command;
+    for (int op = 1; op < static_cast<int>(UiOp::Count); op++) {
+        CHECK(reader.next(command));
+        CHECK(command.op == static_cast<UiOp>(op));
+        for (int i = 0; i < ui_op_arity(command.op); i++) CHECK(command.args[i] == 100 + i);
+    }
+    CHECK(!reader.next(command));
+    CHECK(ui_op_arity(UiOp::DefineString) == -1);
+    CHECK(ui_op_arity(UiOp::Count) == -1);
+}
+
+static void test_malformed_batches_stop_the_reader() {
+    UiCommandBuffer buffer;
+    buffer.emit(UiOp::SetViewSize, {1, 2, 3});
+    UiCommand command;
+
+    // Cut short inside the arguments
+    for (size_t size = 1; size < buffer.size(); size++) {
+        UiCommandReader reader(buffer.data(), size);
+        CHECK(!reader.next(command));
+    }
+
+    // A string longer than the batch
+    const uint8_t overlong[] = {static_cast<uint8_t>(UiOp::DefineString), 0x10, 0, 0, 0, 'a'};
+    UiCommandReader overlongReader(overlong, sizeof(overlong));
+    CHECK(!overlongReader.next(command));
+
+    // An opcode past the table
+    const uint8_t unknown[] = {static_cast<uint8_t>(UiOp::Count), 0, 0, 0, 0};
+    UiCommandReader unknownReader(unknown, sizeof(unknown));
+    CHECK(!unknownReader.next(command));
+}
+
+// C++ names in opcode order; MainActivity.kt spells them in upper snake case
+static const char* const kOpNames[] = {
+    "DefineString", "ShowToast", "CreateButton", "CreateTextView", "CreateImageView",
+    "CreateLinearLayout", "CreateScrollView", "CreateCardView", "CreateRecyclerView",
+    "CreateEditText", "CreateScreen", "AddViewToParent", "SetViewText", "SetViewImage",
+    "SetViewVisibility", "SetViewBackgroundColor", "SetViewPadding", "SetViewSize",
+    "SetViewMargin", "SetViewGravity", "SetViewElevation", "SetViewCornerRadius",
+    "SetViewBorder", "SetTextSize", "SetTextColor", "SetTextStyle", "SetEditTextHint",
+    "SetEditTextInputType", "RecyclerViewInsert", "RecyclerViewRemove", "RecyclerViewChange",
+    "SetToolbarTitle", "NavigateToScreen", "NavigateBack", "SetBackButtonVisible",
+    "ClearScreen", "RemoveView", "SetButtonCallback", "DefineStyle", "ApplyStyle",
+    "RecyclerViewCommit",
+};
+static_assert(std::size(kOpNames) == static_cast<size_t>(UiOp::Count), "name table out of sync with UiOp");
+
+static std::string upper_snake(const char* name) {
+    std::string out;
+    for (const char* c = name; *c; c++) {
+        if (std::isupper(static_cast<unsigned char>(*c)) && c != name) out += '_';
+        out += static_cast<char>(std::toupper(static_cast<unsigned char>(*c)));
+    }
+    return out;
+}
+
+static const char* g_activity_path = nullptr;
+
+static std::string read_activity() {
+    std::ifstream in(g_activity_path);
+    CHECK(in.good());
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static size_t count_of(const std::string& text, const char* needle) {
+    size_t n = 0;
+    for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) n++;
+    return n;
+}
+
+static void test_kotlin_opcodes_match() {
+    std::string source = read_activity();
+
+    size_t begin = source.find("object UiOp {");
+    CHECK(begin != std::string::npos);
+    size_t end = source.find('}', begin);
+    std::istringstream body(source.substr(begin, end - begin));
+
+    std::vector<std::string> names;
+    std::string line;
+    while (std::getline(body, line)) {
+        char name[64];
+        int value;
+        if (std::sscanf(line.c_str(), " const val %63s = %d", name, &value) != 2) continue;
+        CHECK(value == static_cast<int>(names.size()));
+        names.emplace_back(name);
+    }
+
+    CHECK(names.size() == static_cast<size_t>(UiOp::Count));
+    for (size_t op = 0; op < names.size(); op++) {
+        if (names[op] != upper_snake(kOpNames[op])) {
+            std::fprintf(stderr, "opcode %zu: %s in Kotlin, %s here\n", op, names[op].c_str(), kOpNames[op]);
+            CHECK(false);
+        }
+    }
+}
+
+// Each branch of decodeUiCommands must read as many int32s as the op carries here
+static void test_kotlin_decoder_arity_matches() {
+    std::string source = read_activity();
+    size_t begin = source.find("private fun decodeUiCommands(");
+    CHECK(begin != std::string::npos);
+    size_t end = source.find("else -> {", begin);
+    CHECK(end != std::string::npos);
+    std::istringstream body(source.substr(begin, end - begin));
+
+    std::vector<bool> seen(static_cast<size_t>(UiOp::Count), false);
+    std::vector<std::string> branch; // ops sharing one `->`, as in the recycler notifications
+    std::string line;
+    while (std::getline(body, line)) {
+        size_t name = line.find("UiOp.");
+        if (name == std::string::npos) continue;
+        size_t nameEnd = name + 5;
+        while (nameEnd < line.size() && (std::isupper(static_cast<unsigned char>(line[nameEnd])) || line[nameEnd] == '_')) nameEnd++;
+        branch.push_back(line.substr(name + 5, nameEnd - name - 5));
+
+        size_t arrow = line.find("->", nameEnd);
+        if (arrow == std::string::npos) continue;
+        std::string call = line.substr(arrow);
+        size_t reads = count_of(call, "int()") + count_of(call, "str()");
+        // DefineStyle reads its values with IntArray(StyleField.COUNT) { int() }
+        if (call.find("StyleField.COUNT") != std::string::npos) reads += kStyleFieldCount - 1;
+
+        for (const std::string& op : branch) {
+            if (op == "DEFINE_STRING") continue;
+            size_t index = 0;
+            while (index < std::size(kOpNames) && upper_snake(kOpNames[index]) != op) index++;
+            CHECK(index < std::size(kOpNames));
+            int arity = ui_op_arity(static_cast<UiOp>(index));
+            if (reads != static_cast<size_t>(arity)) {
+                std::fprintf(stderr, "%s: Kotlin reads %zu arguments, UiCommandBuffer writes %d\n",
+                             op.c_str(), reads, arity);
+                CHECK(false);
+            }
+            seen[index] = true;
+        }
+        branch.clear();
+    }
+
+    for (size_t op = 1; op < seen.size(); op++) {
+        if (!seen[op]) std::fprintf(stderr, "%s is not decoded in MainActivity.kt\n", kOpNames[op]);
+        CHECK(seen[op]);
+    }
+}
+
+int main(int argc, char** argv) {
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_strings_interned_once);
+    RUN_TEST(test_clear_resets_string_table);
+    RUN_TEST(test_little_endian_layout);
+    RUN_TEST(test_every_op_decodes_with_its_arity);
+    RUN_TEST(test_malformed_batches_stop_the_reader);
+    if (argc >= 2) {
+        g_activity_path = argv[1];
+        RUN_TEST(test_kotlin_opcodes_match);
+        RUN_TEST(test_kotlin_decoder_arity_matches);
+    }
+    return 0;
+}
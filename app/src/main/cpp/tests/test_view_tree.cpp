@@ -0,0 +1,230 @@
+// ViewTree, the retained hierarchy behind android_begin_rebuild: the ops a rebuild
+// sends against a known previous tree. An identical rebuild sends nothing, a
+// changed property sends only its setter, appended and inserted views are created,
+// views not placed again are removed (with their button callbacks), and a view
+// re-attached where it already is sends no move.
+
+#include <string>
+#include <vector>
+#include "check.h"
+#include "ViewTree.h"
+
+// Drives the tree the way the android_create_* / android_set_* natives do and
+// records the ops they would send
+struct Build {
+    ViewTree tree;
+    int nextId = 1000;
+    std::vector<std::string> ops;
+
+    int create(UiOp kind, int parent, ViewTree::Shape shape = {}) {
+        int viewId = tree.reuse(parent, kind, shape);
+        if (viewId == -1) {
+            viewId = nextId++;
+            tree.insert(viewId, parent, kind, shape);
+            ops.push_back("create " + std::to_string(viewId) + " in " + std::to_string(parent));
+        }
+        return viewId;
+    }
+
+    int text_view(int parent, const std::string& text) {
+        int viewId = create(UiOp::CreateTextView, parent);
+        if (tree.update(UiOp::SetViewText, {viewId}, text)) ops.push_back("text " + std::to_string(viewId) + " " + text);
+        return viewId;
+    }
+
+    int button(int parent, int32_t callback) {
+        int viewId = create(UiOp::CreateButton, parent);
+        if (tree.update(UiOp::SetButtonCallback, {viewId, callback})) {
+            ops.push_back("callback " + std::to_string(viewId) + " " + std::to_string(callback));
+        }
+        return viewId;
+    }
+
+    void color(int viewId, int32_t color) {
+        if (tree.update(UiOp::SetViewBackgroundColor, {viewId, color})) {
+            ops.push_back("color " + std::to_string(viewId) + " " + std::to_string(color));
+        }
+    }
+
+    void move(int viewId, int parent) {
+        if (tree.move(viewId, parent)) ops.push_back("move " + std::to_string(viewId) + " to " + std::to_string(parent));
+    }
+
+    void begin() {
+        ops.clear();
+        tree.begin_rebuild(-1);
+    }
+
+    std::vector<ViewTree::Removed> end() {
+        std::vector<ViewTree::Removed> removed;
+        tree.end_rebuild(removed);
+        for (const ViewTree::Removed& view : removed) ops.push_back("remove " + std::to_string(view.viewId));
+        return removed;
+    }
+};
+
+using Ops = std::vector<std::string>;
+
+// The previous tree every test rebuilds against:
+//   layout 1000 (vertical) { text 1001 "Title", button 1002 (callback 7) }, text 1003 "Footer"
+struct Screen {
+    int layout, title, button, footer;
+};
+
+static Screen first_build(Build& b, bool rebuild = false) {
+    if (rebuild) b.begin();
+    Screen s{};
+    s.layout = b.create(UiOp::CreateLinearLayout, -1, {1, 0});
+    b.color(s.layout, 0xFFFFFF);
+    s.title = b.text_view(s.layout, "Title");
+    s.button = b.button(s.layout, 7);
+    s.footer = b.text_view(-1, "Footer");
+    return s;
+}
+
+static void test_first_build_creates_everything() {
+    Build b;
+    Screen s = first_build(b);
+    CHECK(s.layout == 1000 && s.title == 1001 && s.button == 1002 && s.footer == 1003);
+    CHECK((b.ops == Ops{"create 1000 in -1", "color 1000 16777215", "create 1001 in 1000", "text 1001 Title",
+                        "create 1002 in 1000", "callback 1002 7", "create 1003 in -1", "text 1003 Footer"}));
+    CHECK(b.tree.size() == 5);  // with the main screen
+}
+
+static void test_identical_rebuild_sends_nothing() {
+    Build b;
+    Screen before = first_build(b);
+    Screen after = first_build(b, true);
+    CHECK(b.end().empty());
+    CHECK(b.ops.empty());
+    CHECK(after.layout == before.layout && after.title == before.title && after.button == before.button &&
+          after.footer == before.footer);
+}
+
+static void test_changed_props_send_only_their_setters() {
+    Build b;
+    Screen s = first_build(b);
+    b.begin();
+    CHECK(b.create(UiOp::CreateLinearLayout, -1, {1, 0}) == s.layout);
+    b.color(s.layout, 0x000000);
+    CHECK(b.text_view(s.layout, "New title") == s.title);
+    CHECK(b.button(s.layout, 7) == s.button);
+    CHECK(b.text_view(-1, "Footer") == s.footer);
+    b.end();
+    CHECK((b.ops == Ops{"color 1000 0", "text 1001 New title"}));
+
+    // The new values are what the next rebuild compares against
+    first_build(b, true);
+    b.end();
+    CHECK((b.ops == Ops{"color 1000 16777215", "text 1001 Title"}));
+}
+
+static void test_appended_view_is_the_only_create() {
+    Build b;
+    Screen s = first_build(b);
+    b.begin();
+    first_build(b);
+    int extra = b.text_view(s.layout, "Extra");
+    CHECK(b.end().empty());
+    CHECK(extra == 1004);
+    CHECK((b.ops == Ops{"create 1004 in 1000", "text 1004 Extra"}));
+}
+
+static void test_inserted_view_recreates_the_siblings_after_it() {
+    Build b;
+    Screen s = first_build(b);
+    b.begin();
+    CHECK(b.create(UiOp::CreateLinearLayout, -1, {1, 0}) == s.layout);
+    b.color(s.layout, 0xFFFFFF);
+    CHECK(b.text_view(s.layout, "Title") == s.title);
+    int inserted = b.text_view(s.layout, "Subtitle");
+    int button = b.button(s.layout, 8);
+    CHECK(b.text_view(-1, "Footer") == s.footer);
+    std::vector<ViewTree::Removed> removed = b.end();
+
+    // Children are append-only on the Java side: the old button goes, a new one follows the insert
+    CHECK(inserted == 1004 && button == 1005);
+    CHECK((b.ops == Ops{"create 1004 in 1000", "text 1004 Subtitle", "create 1005 in 1000", "callback 1005 8",
+                        "remove 1002"}));
+    CHECK(removed.size() == 1 && removed[0].kind == UiOp::CreateButton && removed[0].callback == 7);
+}
+
+static void test_views_not_placed_again_are_removed_parents_first() {
+    Build b;
+    Screen s = first_build(b);
+    b.begin();
+    CHECK(b.text_view(-1, "Footer") == 1004);
+    std::vector<ViewTree::Removed> removed = b.end();
+
+    // The layout's slot now holds a text view: the layout goes with its children, then the old footer
+    CHECK(removed.size() == 4);
+    CHECK(removed[0].viewId == s.layout && removed[0].kind == UiOp::CreateLinearLayout);
+    CHECK(removed[1].viewId == s.title);
+    CHECK(removed[2].viewId == s.button && removed[2].callback == 7);
+    CHECK(removed[3].viewId == s.footer);
+    CHECK((b.ops == Ops{"create 1004 in -1", "text 1004 Footer", "remove 1000", "remove 1001", "remove 1002",
+                        "remove 1003"}));
+    CHECK(b.tree.size() == 2);
+}
+
+static void test_dropped_trailing_view_is_removed() {
+    Build b;
+    Screen s = first_build(b);
+    b.begin();
+    CHECK(b.create(UiOp::CreateLinearLayout, -1, {1, 0}) == s.layout);
+    b.color(s.layout, 0xFFFFFF);
+    CHECK(b.text_view(s.layout, "Title") == s.title);
+    CHECK(b.text_view(-1, "Footer") == s.footer);
+    std::vector<ViewTree::Removed> removed = b.end();
+    CHECK((b.ops == Ops{"remove 1002"}));
+    CHECK(removed.size() == 1 && removed[0].callback == 7);
+}
+
+static void test_move_is_sent_only_when_the_parent_changes() {
+    Build b;
+    Screen s = first_build(b);
+    int side = b.create(UiOp::CreateLinearLayout, -1, {0, 0});
+
+    b.begin();
+    first_build(b);
+    CHECK(b.create(UiOp::CreateLinearLayout, -1, {0, 0}) == side);
+    b.move(s.title, s.layout);   // already there
+    b.move(s.button, side);
+    CHECK(b.end().empty());
+    CHECK((b.ops == Ops{"move 1002 to 1004"}));
+
+    // The button is now the side layout's first child and is reused there
+    b.begin();
+    CHECK(b.create(UiOp::CreateLinearLayout, -1, {1, 0}) == s.layout);
+    b.color(s.layout, 0xFFFFFF);
+    CHECK(b.text_view(s.layout, "Title") == s.title);
+    CHECK(b.text_view(-1, "Footer") == s.footer);
+    CHECK(b.create(UiOp::CreateLinearLayout, -1, {0, 0}) == side);
+    CHECK(b.button(side, 7) == s.button);
+    CHECK(b.end().empty());
+    CHECK(b.ops.empty());
+}
+
+static void test_shape_mismatch_is_not_reused() {
+    Build b;
+    Screen s = first_build(b);
+    b.begin();
+    int horizontal = b.create(UiOp::CreateLinearLayout, -1, {0, 0});
+    CHECK(horizontal != s.layout);
+    b.end();
+    CHECK(b.ops.front() == "create 1004 in -1");
+    CHECK(b.ops[1] == "remove 1000");
+}
+
+int main() {
+    RUN_TEST(test_first_build_creates_everything);
+    RUN_TEST(test_identical_rebuild_sends_nothing);
+    RUN_TEST(test_changed_props_send_only_their_setters);
+    RUN_TEST(test_appended_view_is_the_only_create);
+    RUN_TEST(test_inserted_view_recreates_the_siblings_after_it);
+    RUN_TEST(test_views_not_placed_again_are_removed_parents_first);
+    RUN_TEST(test_dropped_trailing_view_is_removed);
+    RUN_TEST(test_move_is_sent_only_when_the_parent_changes);
+    RUN_TEST(test_shape_mismatch_is_not_reused);
+    return 0;
+}
@@ -0,0 +1,176 @@
+// VmEventLoop under contention: many producer threads post at once, the loop
+// thread must see every event exactly once and each producer's events in the
+// order they were posted. Events racing with stop() are run or freed, never leaked.
+//
+//   test_vm_event_loop [events, default 2000000]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "../vm_event_loop.h"
+
+constexpr int kProducers = 8;
+
+static int g_events = 2000000;
+
+// Written by the loop thread only
+static std::vector<int> g_next_seq;
+static uint64_t g_handled = 0;
+static bool g_in_order = true;
+
+static void record(VmEvent& event) {
+    // callbackId: producer, statusCode: its sequence number
+    int& expected = g_next_seq[event.callbackId];
+    if (event.statusCode != expected) g_in_order = false;
+    expected = event.statusCode + 1;
+    g_handled++;
+}
+
+static void reset() {
+    g_next_seq.assign(kProducers, 0);
+    g_handled = 0;
+    g_in_order = true;
+}
+
+static void test_producers_stress() {
+    reset();
+    VmEventLoop loop(record);
+    loop.start();
+
+    int perProducer = g_events / kProducers;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int seq = 0; seq < perProducer; seq++) {
+                VmEvent event;
+                event.kind = VmEvent::Kind::ButtonClick;
+                event.callbackId = p;
+                event.statusCode = seq;
+                loop.post(std::move(event));
+            }
+        });
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& producer : producers) producer.join();
+
+    // Stop drains everything posted before it
+    loop.stop();
+    CHECK(g_in_order);
+    CHECK(g_handled == static_cast<uint64_t>(perProducer) * kProducers);
+    for (int p = 0; p < kProducers; p++) CHECK(g_next_seq[p] == perProducer);
+}
+
+static void test_tasks_run_on_the_loop_thread() {
+    reset();
+    VmEventLoop loop(record);
+    loop.start();
+
+    std::atomic<int> onLoop{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; p++) {
+        producers.emplace_back([&] {
+            for (int i = 0; i < 1000; i++) {
+                VmEvent event;
+                event.task = [&] { if (loop.on_loop_thread()) onLoop++; };
+                loop.post(std::move(event));
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    loop.stop();
+
+    CHECK(onLoop.load() == kProducers * 1000);
+    CHECK(g_handled == 0);
+}
+
+static void test_idle_loop_wakes_for_each_post() {
+    reset();
+    VmEventLoop loop(record);
+    loop.start();
+
+    // One at a time with the loop asleep in between
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 200; i++) {
+        VmEvent event;
+        event.task = [&] { ran++; };
+        loop.post(std::move(event));
+        while (ran.load() != i + 1) std::this_thread::yield();
+    }
+    loop.stop();
+    CHECK(ran.load() == 200);
+}
+
+static void test_stop_is_idempotent() {
+    reset();
+    VmEventLoop loop(record);
+    loop.stop();  // never started
+    loop.start();
+    loop.stop();
+    loop.stop();
+    CHECK(g_handled == 0);
+}
+
+static void test_post_after_stop_frees_the_event() {
+    reset();
+    auto token = std::make_shared<int>(0);
+    {
+        VmEventLoop loop(record);
+        loop.start();
+        loop.stop();
+
+        VmEvent event;
+        event.task = [token] { (*token)++; };
+        loop.post(std::move(event));
+        CHECK(token.use_count() == 1);
+    }
+    CHECK(*token == 0);
+}
+
+// Like an HTTP worker completing while ~DropletVMWrapperImpl stops the loop
+static void test_posts_racing_stop_are_run_or_freed() {
+    for (int round = 0; round < 50; round++) {
+        reset();
+        auto token = std::make_shared<int>(0);
+        std::atomic<int> ran{0};
+        {
+            VmEventLoop loop(record);
+            loop.start();
+
+            std::atomic<bool> go{false};
+            std::vector<std::thread> producers;
+            for (int p = 0; p < 4; p++) {
+                producers.emplace_back([&] {
+                    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                    for (int i = 0; i < 2000; i++) {
+                        VmEvent event;
+                        event.task = [token, &ran] { ran++; };
+                        loop.post(std::move(event));
+                    }
+                });
+            }
+            go.store(true, std::memory_order_release);
+            loop.stop();
+            for (auto& producer : producers) producer.join();
+        }
+        // Every captured copy is gone once the loop is destroyed
+        CHECK(token.use_count() == 1);
+        CHECK(ran.load() <= 4 * 2000);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2) g_events = std::max(kProducers, std::atoi(argv[1]));
+    RUN_TEST(test_producers_stress);
+    RUN_TEST(test_tasks_run_on_the_loop_thread);
+    RUN_TEST(test_idle_loop_wakes_for_each_post);
+    RUN_TEST(test_stop_is_idempotent);
+    RUN_TEST(test_post_after_stop_frees_the_event);
+    RUN_TEST(test_posts_racing_stop_are_run_or_freed);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "vm_event_loop.h"
+
+VmEventLoop::~VmEventLoop() {
+    stop();
+    // A producer that saw the loop running may have pushed after stop()'s drain. Whoever
+    // destroys the loop has joined every producer, so this pass finds all of them.
+    drain();
+}
+
+void VmEventLoop::start() {
+    if (thread.joinable()) return;
+    stopping.store(false, std::memory_order_relaxed);
+    thread = std::thread([this] { run(); });
+}
+
+void VmEventLoop::post(VmEvent event) {
+    if (stopping.load(std::memory_order_acquire)) return;
+
+    auto* node = new Node;
+    node->event = std::move(event);
+    push(node);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+}
+
+void VmEventLoop::stop() {
+    if (!thread.joinable()) return;
+    if (on_loop_thread()) return; // can't join ourselves; the owner stops us
+
+    // Refuse new posts first, so after the join only racing ones can be left over
+    stopping.store(true, std::memory_order_release);
+    auto* node = new Node;
+    node->event.kind = VmEvent::Kind::Stop;
+    push(node);
+    signal.fetch_add(1, std::memory_order_release);
+    signal.notify_one();
+    thread.join();
+
+    // Anything pushed after Stop is dropped
+    drain();
+}
+
+void VmEventLoop::drain() {
+    while (Node* node = pop()) delete node;
+}
+
+void VmEventLoop::push(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+// Vyukov MPSC pop. Returns nullptr when empty, or when a producer is between its
+// exchange and its link store; that producer's signal bump wakes us again.
+VmEventLoop::Node* VmEventLoop::pop() {
+    Node* t = tail;
+    Node* next = t->next.load(std::memory_order_acquire);
+
+    if (t == &stub) {
+        if (!next) return nullptr;
+        tail = next;
+        t = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+        tail = next;
+        return t;
+    }
+
+    if (t != head.load(std::memory_order_acquire)) return nullptr;
+
+    push(&stub);
+    next = t->next.load(std::memory_order_acquire);
+    if (next) {
+        tail = next;
+        return t;
+    }
+    return nullptr;
+}
+
+void VmEventLoop::run() {
+    while (true) {
+        uint32_t seen = signal.load(std::memory_order_acquire);
+
+        while (Node* node = pop()) {
+            VmEvent& event = node->event;
+            bool stopping = event.kind == VmEvent::Kind::Stop;
+
+            if (event.kind == VmEvent::Kind::Task) {
+                if (event.task) event.task();
+            } else if (!stopping) {
+                handler(event);
+            }
+
+            delete node;
+            if (stopping) return;
+        }
+
+        signal.wait(seen, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef MIST_VM_EVENT_LOOP_H
+#define MIST_VM_EVENT_LOOP_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Something for the VM thread to do. JNI entry points only build one of these and post it.
+struct VmEvent {
+    enum class Kind : uint8_t {
+        Task,           // run `task` on the VM thread
+        ButtonClick,    // callbackId
+        HttpResponse,   // callbackId, success, statusCode, body
+        Stop
+    };
+
+    Kind kind = Kind::Task;
+    int callbackId = -1;
+    int statusCode = 0;
+    bool success = false;
+    bool revalidating = false;  // HttpResponse: cached body, another response follows
+    bool unchanged = false;     // HttpResponse: matches the cached body already delivered
+    std::string body;
+    std::function<void()> task;
+};
+
+// Single consumer thread that owns the VM and drains events posted from any thread.
+// The inbound queue is an intrusive multi-producer/single-consumer list: post() is
+// one atomic exchange plus a wake-up, and never takes a lock.
+class VmEventLoop {
+public:
+    using Handler = void (*)(VmEvent& event);
+
+    explicit VmEventLoop(Handler handler) : handler(handler) {}
+    ~VmEventLoop();
+
+    VmEventLoop(const VmEventLoop&) = delete;
+    VmEventLoop& operator=(const VmEventLoop&) = delete;
+
+    void start();
+
+    // Enqueue after everything already posted, safe from any thread. Once stop() has
+    // begun the event is dropped instead (a task is destroyed without running).
+    void post(VmEvent event);
+
+    // Run what is queued, then join the thread. Idempotent. Events that lose the race
+    // with stop() are freed here or, at the latest, by the destructor.
+    void stop();
+
+    bool on_loop_thread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        VmEvent event;
+    };
+
+    void push(Node* node);
+    Node* pop();
+    void drain();
+    void run();
+
+    Handler handler;
+    Node stub;
+    std::atomic<Node*> head{&stub};  // producers
+    Node* tail = &stub;              // consumer only
+    std::atomic<uint32_t> signal{0};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+};
+
+#endif //MIST_VM_EVENT_LOOP_H
@@ -0,0 +1,174 @@
+package com.mist.example
+
+import android.content.Context
+import android.content.res.AssetManager
+import android.graphics.Bitmap
+import android.graphics.BitmapFactory
+import android.os.Handler
+import android.os.Looper
+import android.util.Log
+import android.util.LruCache
+import android.widget.ImageView
+import java.io.File
+import java.io.IOException
+import java.io.InputStream
+import java.net.HttpURLConnection
+import java.net.URL
+import java.security.MessageDigest
+import java.util.concurrent.Executors
+
+// Images for android_create_imageview / android_set_view_image.
+//
+// A fixed pool fetches and decodes; requests for the same (source, size) that
+// are already in flight share that one load. Bitmaps are decoded with
+// inSampleSize so they are no larger than needed for the view, and kept in a
+// memory LRU keyed by (source, size). Downloaded bytes go to a disk cache under
+// cacheDir, so a rebuilt screen or a restart does not download them again.
+//
+// load() and every completion run on the main thread; workers only fetch and decode.
+// memoryCacheKb defaults to an eighth of the heap.
+class ImageLoader(
+    context: Context,
+    threads: Int = 3,
+    memoryCacheKb: Int = (Runtime.getRuntime().maxMemory() / 1024 / 8).toInt(),
+) {
+    private val assets: AssetManager = context.assets
+    private val diskDir = File(context.cacheDir, "images")
+    private val defaultSize = context.resources.displayMetrics.widthPixels
+    private val executor = Executors.newFixedThreadPool(threads)
+    private val main = Handler(Looper.getMainLooper())
+
+    // Measured in KB
+    private val memory = object : LruCache<String, Bitmap>(memoryCacheKb) {
+        override fun sizeOf(key: String, value: Bitmap) = value.byteCount / 1024
+    }
+
+    // Views waiting for each key being loaded
+    private val inFlight = HashMap<String, MutableList<ImageView>>()
+
+    // Fetch-and-decode jobs started, i.e. loads neither the memory cache nor an
+    // in-flight load could serve
+    internal var loadsStarted = 0
+        private set
+
+    companion object {
+        private const val TAG = "ImageLoader"
+        private const val DISK_CACHE_BYTES = 50L * 1024 * 1024
+    }
+
+    // widthPx/heightPx are the view's layout size; <= 0 (wrap content) means the screen width
+    fun load(view: ImageView, source: String, widthPx: Int, heightPx: Int) {
+        val width = if (widthPx > 0) widthPx else defaultSize
+        val height = if (heightPx > 0) heightPx else defaultSize
+        val key = "$source@${width}x$height"
+
+        // The view shows whatever it asked for last, even if an older load finishes later
+        view.tag = key
+
+        memory.get(key)?.let {
+            view.setImageBitmap(it)
+            return
+        }
+
+        inFlight[key]?.let {
+            it.add(view)
+            return
+        }
+        inFlight[key] = mutableListOf(view)
+
+        loadsStarted++
+        executor.execute {
+            val bitmap = try {
+                decode(source, width, height)
+            } catch (e: Exception) {
+                Log.w(TAG, "Failed to load $source: ${e.message}")
+                null
+            }
+
+            main.post {
+                if (bitmap != null) memory.put(key, bitmap)
+                inFlight.remove(key)?.forEach {
+                    if (it.tag == key && bitmap != null) it.setImageBitmap(bitmap)
+                }
+            }
+        }
+    }
+
+    fun shutdown() {
+        executor.shutdownNow()
+        memory.evictAll()
+    }
+
+    private fun decode(source: String, width: Int, height: Int): Bitmap? {
+        if (source.startsWith("http://") || source.startsWith("https://")) {
+            return decodeFile(download(source), width, height)
+        }
+        val file = File(source)
+        if (file.isFile) return decodeFile(file, width, height)
+        return decodeStream({ assets.open(source) }, width, height)
+    }
+
+    private fun decodeFile(file: File, width: Int, height: Int): Bitmap? =
+        decodeStream({ file.inputStream() }, width, height)
+
+    // Two passes: bounds only, then the real decode at the largest power-of-two
+    // reduction that still covers width x height
+    private fun decodeStream(open: () -> InputStream, width: Int, height: Int): Bitmap? {
+        val bounds = BitmapFactory.Options().apply { inJustDecodeBounds = true }
+        open().use { BitmapFactory.decodeStream(it, null, bounds) }
+        if (bounds.outWidth <= 0 || bounds.outHeight <= 0) return null
+
+        var sample = 1
+        while (bounds.outWidth / (sample * 2) >= width && bounds.outHeight / (sample * 2) >= height) {
+            sample *= 2
+        }
+
+        val options = BitmapFactory.Options().apply { inSampleSize = sample }
+        return open().use { BitmapFactory.decodeStream(it, null, options) }
+    }
+
+    // Cached copy of the URL's bytes, downloading it on a miss
+    private fun download(url: String): File {
+        diskDir.mkdirs()
+        val file = File(diskDir, sha256(url))
+        if (file.isFile) {
+            file.setLastModified(System.currentTimeMillis())
+            return file
+        }
+
+        val connection = URL(url).openConnection() as HttpURLConnection
+        connection.connectTimeout = 15000
+        connection.readTimeout = 15000
+        if (connection.responseCode !in 200..299) {
+            throw IOException("HTTP ${connection.responseCode}")
+        }
+
+        // Written under a temporary name so a failed download never looks cached
+        val partial = File.createTempFile("download", ".part", diskDir)
+        try {
+            connection.inputStream.use { input -> partial.outputStream().use { input.copyTo(it) } }
+            if (!partial.renameTo(file)) throw IOException("Cannot store $url")
+        } finally {
+            partial.delete()
+        }
+
+        trimDiskCache()
+        return file
+    }
+
+    // Oldest (least recently used) files go first once the cache is over budget
+    private fun trimDiskCache() {
+        val files = diskDir.listFiles()?.filter { !it.name.endsWith(".part") } ?: return
+        var total = files.sumOf { it.length() }
+        if (total <= DISK_CACHE_BYTES) return
+
+        for (file in files.sortedBy { it.lastModified() }) {
+            if (total <= DISK_CACHE_BYTES) break
+            total -= file.length()
+            file.delete()
+        }
+    }
+
+    private fun sha256(text: String): String =
+        MessageDigest.getInstance("SHA-256").digest(text.toByteArray()).joinToString("") { "%02x".format(it) }
+}
@@ -14,17 +14,26 @@ import androidx.recyclerview.widget.GridLayoutManager
 import android.graphics.BitmapFactory
 import android.util.TypedValue
 import android.util.Log
+import org.json.JSONException
+import org.json.JSONObject
 import java.io.File
-import java.io.InputStream
 import java.net.URL
 import java.net.HttpURLConnection
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.channels.Channels
+import java.util.concurrent.ConcurrentHashMap
 import java.util.concurrent.Executors
+import java.util.concurrent.FutureTask
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.TimeoutException
 import java.util.Stack
  import android.text.InputType
  import android.graphics.Typeface
  import android.view.Gravity
  import android.graphics.drawable.GradientDrawable
  import android.graphics.drawable.ColorDrawable
+ import android.graphics.drawable.Drawable
  import android.graphics.Color
  import android.widget.EditText
 
@@ -33,7 +42,11 @@ class MainActivity : AppCompatActivity() {
     private lateinit var contentFrame: FrameLayout
     private val viewMap = HashMap<Int, View>()
     private val screenMap = HashMap<Int, ScreenInfo>()
-    private val recyclerAdapters = HashMap<Int, SimpleRecyclerAdapter>()
+    private val recyclerAdapters = HashMap<Int, NativeRecyclerAdapter>()
+    private val styles = HashMap<Int, ResolvedStyle>()
+    private val images by lazy { ImageLoader(this) }
+    // Connection of each request httpExecute is running, for httpAbort
+    private val httpConnections = ConcurrentHashMap<Int, HttpURLConnection>()
     private val navigationStack = Stack<Int>()
     private var currentScreenId: Int = -1
 
@@ -45,6 +58,17 @@ class MainActivity : AppCompatActivity() {
 
     companion object {
         private const val TAG = "MainActivity"
+
+        // Runs httpAbort's disconnect(), which can block on the socket close: off the
+        // UI thread that calls it from onDestroy. One daemon thread for the process.
+        private val httpAborts = Executors.newSingleThreadExecutor { task ->
+            Thread(task, "http-abort").apply { isDaemon = true }
+        }
+
+        // Per HTTP worker thread read buffer handed to onHttpChunk
+        private val httpChunk = object : ThreadLocal<ByteBuffer>() {
+            override fun initialValue(): ByteBuffer = ByteBuffer.allocateDirect(64 * 1024)
+        }
         init {
             System.loadLibrary("droplet_native")
         }
@@ -82,12 +106,27 @@ class MainActivity : AppCompatActivity() {
         registerVM()
 
         val vm = DropletVM()
-        val assetName = "bundle.dbc"
+        vm.runBytecode(extractBundle("bundle.dbc").absolutePath)
+    }
+
+    // The loader reads from a path, so the bundle has to live outside the APK.
+    // Copy it only when the APK changed since the last extraction.
+    private fun extractBundle(assetName: String): File {
         val outFile = File(filesDir, assetName)
+        val installedAt = packageManager.getPackageInfo(packageName, 0).lastUpdateTime
+        if (outFile.exists() && outFile.lastModified() >= installedAt) {
+            return outFile
+        }
+
+        // Write beside the target and rename, so an interrupted copy is never reused
+        val tmpFile = File(filesDir, "$assetName.tmp")
         assets.open(assetName).use { input ->
-            outFile.outputStream().use { output -> input.copyTo(output) }
+            tmpFile.outputStream().use { output -> input.copyTo(output) }
+        }
+        if (!tmpFile.renameTo(outFile)) {
+            Log.e(TAG, "Failed to move $assetName into place")
         }
-        vm.runBytecode(outFile.absolutePath)
+        return outFile
     }
 
     override fun onOptionsItemSelected(item: MenuItem): Boolean {
@@ -213,9 +252,9 @@ class MainActivity : AppCompatActivity() {
         runOnUiThread { Toast.makeText(this, message, Toast.LENGTH_SHORT).show() }
     }
 
-    fun createButton(title: String, callbackId: Int, parentId: Int) {
+    fun createButton(title: String, viewId: Int, callbackId: Int, parentId: Int) {
         runOnUiThread {
-            Log.d(TAG, "Creating button: '$title', callback=$callbackId, parent=$parentId")
+            Log.d(TAG, "Creating button: '$title', id=$viewId, callback=$callbackId, parent=$parentId")
             val button = Button(this).apply {
                 text = title
                 setOnClickListener { onButtonClick(callbackId) }
@@ -243,6 +282,28 @@ class MainActivity : AppCompatActivity() {
             }
 
             parent.addView(button)
+            viewMap[viewId] = button
+        }
+    }
+
+    // A rebuilt screen reuses the button but registered a new Droplet callback for it
+    fun setButtonCallback(viewId: Int, callbackId: Int) {
+        runOnUiThread {
+            viewMap[viewId]?.setOnClickListener { onButtonClick(callbackId) }
+        }
+    }
+
+    // Sent for a view a rebuild did not place again, parents before their children
+    fun removeView(viewId: Int) {
+        runOnUiThread {
+            val view = viewMap.remove(viewId) ?: return@runOnUiThread
+            // Scroll and card views are mapped by their inner layout; the ScrollView or
+            // CardView around it is what sits in the parent
+            val scrollView = viewMap.remove(viewId + 1000000)
+            val cardView = viewMap.remove(viewId + 2000000)
+            val outer = scrollView ?: cardView ?: view
+            (outer.parent as? ViewGroup)?.removeView(outer)
+            recyclerAdapters.remove(viewId)
         }
     }
 
@@ -364,7 +425,7 @@ class MainActivity : AppCompatActivity() {
                 else -> LinearLayoutManager(this, LinearLayoutManager.VERTICAL, false)
             }
 
-            val adapter = SimpleRecyclerAdapter()
+            val adapter = NativeRecyclerAdapter { position -> recyclerRow(viewId, position) }
             recyclerView.adapter = adapter
             recyclerAdapters[viewId] = adapter
 
@@ -374,15 +435,22 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
-    fun recyclerViewAddItem(viewId: Int, text: String) {
+    // Switches recyclerRow to the native snapshot the notifications that follow describe
+    fun recyclerViewCommit(viewId: Int, version: Int) {
         runOnUiThread {
-            recyclerAdapters[viewId]?.addItem(text)
+            adoptRecyclerRows(viewId, version)
         }
     }
 
-    fun recyclerViewClear(viewId: Int) {
+    // Rows live in native memory; only the changed range is announced here
+    fun recyclerViewNotify(op: Int, viewId: Int, start: Int, count: Int) {
         runOnUiThread {
-            recyclerAdapters[viewId]?.clear()
+            val adapter = recyclerAdapters[viewId] ?: return@runOnUiThread
+            when (op) {
+                UiOp.RECYCLER_VIEW_INSERT -> adapter.rowsInserted(start, count)
+                UiOp.RECYCLER_VIEW_REMOVE -> adapter.rowsRemoved(start, count)
+                else -> adapter.notifyItemRangeChanged(start, count)
+            }
         }
     }
 
@@ -443,17 +511,17 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    // -1 = wrap content, -2 = match parent, otherwise dp
+    private fun layoutSize(size: Int) = when (size) {
+        -1 -> ViewGroup.LayoutParams.WRAP_CONTENT
+        -2 -> ViewGroup.LayoutParams.MATCH_PARENT
+        else -> dpToPx(size)
+    }
+
     fun setViewSize(viewId: Int, width: Int, height: Int) {
         runOnUiThread {
             val view = viewMap[viewId] ?: return@runOnUiThread
-            val w = if (width == -1) ViewGroup.LayoutParams.WRAP_CONTENT
-            else if (width == -2) ViewGroup.LayoutParams.MATCH_PARENT
-            else dpToPx(width)
-            val h = if (height == -1) ViewGroup.LayoutParams.WRAP_CONTENT
-            else if (height == -2) ViewGroup.LayoutParams.MATCH_PARENT
-            else dpToPx(height)
-
-            view.layoutParams = LinearLayout.LayoutParams(w, h)
+            view.layoutParams = LinearLayout.LayoutParams(layoutSize(width), layoutSize(height))
         }
     }
 
@@ -466,35 +534,9 @@ class MainActivity : AppCompatActivity() {
     }
 
     private fun loadImageIntoView(iv: ImageView, pathOrUrl: String) {
-        if (pathOrUrl.startsWith("http://") || pathOrUrl.startsWith("https://")) {
-            val executor = Executors.newSingleThreadExecutor()
-            executor.execute {
-                try {
-                    val url = URL(pathOrUrl)
-                    val conn = url.openConnection() as HttpURLConnection
-                    conn.doInput = true
-                    conn.connect()
-                    val input: InputStream = conn.inputStream
-                    val bmp = BitmapFactory.decodeStream(input)
-                    runOnUiThread { iv.setImageBitmap(bmp) }
-                } catch (e: Exception) {
-                    e.printStackTrace()
-                }
-            }
-        } else {
-            try {
-                val bmp = BitmapFactory.decodeFile(pathOrUrl)
-                if (bmp != null) {
-                    iv.setImageBitmap(bmp)
-                    return
-                }
-                val stream = assets.open(pathOrUrl)
-                val bmp2 = BitmapFactory.decodeStream(stream)
-                iv.setImageBitmap(bmp2)
-            } catch (e: Exception) {
-                e.printStackTrace()
-            }
-        }
+        // Decoded to the size the view was laid out with (see createImageView)
+        val params = iv.layoutParams
+        images.load(iv, pathOrUrl, params?.width ?: 0, params?.height ?: 0)
     }
 
     fun createEditText(hint: String, viewId: Int, parentId: Int) {
@@ -516,11 +558,21 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    // Called from the VM thread: read on the UI thread, after any batch already posted
     fun getEditTextValue(viewId: Int): String {
-        val view = viewMap[viewId]
-        return if (view is EditText) {
-            view.text.toString()
-        } else {
+        val read = FutureTask {
+            val view = viewMap[viewId]
+            if (view is EditText) {
+                view.text.toString()
+            } else {
+                ""
+            }
+        }
+        runOnUiThread(read)
+        // Bounded so onDestroy joining the VM thread can't deadlock against us
+        return try {
+            read.get(2, TimeUnit.SECONDS)
+        } catch (e: TimeoutException) {
             ""
         }
     }
@@ -577,15 +629,17 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    private fun typefaceStyle(style: Int) = when(style) {
+        1 -> Typeface.BOLD
+        2 -> Typeface.ITALIC
+        3 -> Typeface.BOLD_ITALIC
+        else -> Typeface.NORMAL
+    }
+
     fun setTextStyle(viewId: Int, style: Int) {
         runOnUiThread {
             val view = viewMap[viewId]
-            val typeface = when(style) {
-                1 -> Typeface.BOLD
-                2 -> Typeface.ITALIC
-                3 -> Typeface.BOLD_ITALIC
-                else -> Typeface.NORMAL
-            }
+            val typeface = typefaceStyle(style)
 
             when (view) {
                 is TextView -> view.setTypeface(null, typeface)
@@ -611,22 +665,23 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
+    private fun androidGravity(gravity: Int) = when(gravity) {
+        1 -> Gravity.CENTER
+        2 -> Gravity.LEFT or Gravity.CENTER_VERTICAL
+        3 -> Gravity.RIGHT or Gravity.CENTER_VERTICAL
+        4 -> Gravity.TOP or Gravity.CENTER_HORIZONTAL
+        5 -> Gravity.BOTTOM or Gravity.CENTER_HORIZONTAL
+        6 -> Gravity.LEFT or Gravity.TOP
+        7 -> Gravity.RIGHT or Gravity.TOP
+        8 -> Gravity.LEFT or Gravity.BOTTOM
+        9 -> Gravity.RIGHT or Gravity.BOTTOM
+        else -> Gravity.NO_GRAVITY
+    }
+
     fun setViewGravity(viewId: Int, gravity: Int) {
         runOnUiThread {
             val view = viewMap[viewId]
-
-            val androidGravity = when(gravity) {
-                1 -> Gravity.CENTER
-                2 -> Gravity.LEFT or Gravity.CENTER_VERTICAL
-                3 -> Gravity.RIGHT or Gravity.CENTER_VERTICAL
-                4 -> Gravity.TOP or Gravity.CENTER_HORIZONTAL
-                5 -> Gravity.BOTTOM or Gravity.CENTER_HORIZONTAL
-                6 -> Gravity.LEFT or Gravity.TOP
-                7 -> Gravity.RIGHT or Gravity.TOP
-                8 -> Gravity.LEFT or Gravity.BOTTOM
-                9 -> Gravity.RIGHT or Gravity.BOTTOM
-                else -> Gravity.NO_GRAVITY
-            }
+            val androidGravity = androidGravity(gravity)
 
             when (view) {
                 is TextView -> view.gravity = androidGravity
@@ -680,164 +735,192 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
-    fun httpGet(url: String, callbackId: Int, headersJson: String) {
-        Thread {
-            try {
-                val connection = URL(url).openConnection() as HttpURLConnection
-                connection.requestMethod = "GET"
-                connection.connectTimeout = 15000
-                connection.readTimeout = 15000
-
-                // Parse and add headers
-                if (headersJson.isNotEmpty()) {
-                    parseAndAddHeaders(connection, headersJson)
-                }
-
-                val statusCode = connection.responseCode
-                val response = if (statusCode in 200..299) {
-                    connection.inputStream.bufferedReader().use { it.readText() }
-                } else {
-                    connection.errorStream?.bufferedReader()?.use { it.readText() } ?: ""
-                }
-
-                connection.disconnect()
-                onHttpResponse(callbackId, statusCode in 200..299, response, statusCode)
+    // A style from android_create_style, resolved once when it is defined: lengths in
+    // px, gravity and typeface mapped, and a rounded or bordered background kept as a
+    // ConstantState that every view using the style shares.
+    private class ResolvedStyle(private val mask: Int) {
+        fun has(field: Int) = mask and (1 shl field) != 0
+
+        val padding = IntArray(4)
+        val margin = IntArray(4)
+        var width = ViewGroup.LayoutParams.WRAP_CONTENT
+        var height = ViewGroup.LayoutParams.WRAP_CONTENT
+        var backgroundColor = Color.TRANSPARENT
+        var cornerRadius = 0f
+        var elevation = 0f
+        var gravity = Gravity.NO_GRAVITY
+        var textSize = 0f
+        var textColor = Color.BLACK
+        var typeface = Typeface.NORMAL
+        var background: Drawable.ConstantState? = null
+    }
 
-            } catch (e: Exception) {
-                Log.e(TAG, "HTTP GET error: ${e.message}", e)
-                onHttpResponse(callbackId, false, "Error: ${e.message}", 0)
+    // values holds one entry per StyleField, meaningful where mask has its bit set
+    fun defineStyle(styleId: Int, mask: Int, values: IntArray) {
+        runOnUiThread {
+            val style = ResolvedStyle(mask)
+            for (i in 0 until 4) {
+                style.padding[i] = dpToPx(values[StyleField.PADDING_LEFT + i])
+                style.margin[i] = dpToPx(values[StyleField.MARGIN_LEFT + i])
             }
-        }.start()
+            style.width = layoutSize(values[StyleField.WIDTH])
+            style.height = layoutSize(values[StyleField.HEIGHT])
+            if (style.has(StyleField.BACKGROUND_COLOR)) style.backgroundColor = values[StyleField.BACKGROUND_COLOR]
+            style.cornerRadius = dpToPx(values[StyleField.CORNER_RADIUS]).toFloat()
+            style.elevation = dpToPx(values[StyleField.ELEVATION]).toFloat()
+            style.gravity = androidGravity(values[StyleField.GRAVITY])
+            style.textSize = values[StyleField.TEXT_SIZE].toFloat()
+            if (style.has(StyleField.TEXT_COLOR)) style.textColor = values[StyleField.TEXT_COLOR]
+            style.typeface = typefaceStyle(values[StyleField.TEXT_STYLE])
+
+            if (style.has(StyleField.CORNER_RADIUS) || style.has(StyleField.BORDER_WIDTH)) {
+                style.background = GradientDrawable().apply {
+                    setColor(style.backgroundColor)
+                    cornerRadius = style.cornerRadius
+                    if (style.has(StyleField.BORDER_WIDTH)) {
+                        setStroke(dpToPx(values[StyleField.BORDER_WIDTH]), values[StyleField.BORDER_COLOR])
+                    }
+                }.constantState
+            }
+            styles[styleId] = style
+        }
     }
 
-    fun httpPost(url: String, body: String, callbackId: Int, headersJson: String) {
-        Thread {
-            try {
-                val connection = URL(url).openConnection() as HttpURLConnection
-                connection.requestMethod = "POST"
-                connection.connectTimeout = 15000
-                connection.readTimeout = 15000
-                connection.doOutput = true
+    // Same effect as the matching android_set_* calls, in one op
+    fun applyStyle(viewId: Int, styleId: Int) {
+        runOnUiThread {
+            val style = styles[styleId] ?: return@runOnUiThread
+            val view = viewMap[viewId] ?: return@runOnUiThread
+            val card = viewMap[viewId + 2000000] as? CardView
 
-                // Set default content type if not provided
-                var hasContentType = false
-                if (headersJson.isNotEmpty()) {
-                    hasContentType = parseAndAddHeaders(connection, headersJson)
-                }
-                if (!hasContentType) {
-                    connection.setRequestProperty("Content-Type", "application/json")
+            if (style.has(StyleField.WIDTH) || style.has(StyleField.HEIGHT)) {
+                val current = view.layoutParams
+                view.layoutParams = LinearLayout.LayoutParams(
+                    if (style.has(StyleField.WIDTH)) style.width else current?.width ?: ViewGroup.LayoutParams.WRAP_CONTENT,
+                    if (style.has(StyleField.HEIGHT)) style.height else current?.height ?: ViewGroup.LayoutParams.WRAP_CONTENT
+                )
+            }
+            if (style.has(StyleField.MARGIN_LEFT)) {
+                (view.layoutParams as? ViewGroup.MarginLayoutParams)?.let {
+                    it.setMargins(style.margin[0], style.margin[1], style.margin[2], style.margin[3])
+                    view.layoutParams = it
                 }
+            }
+            if (style.has(StyleField.PADDING_LEFT)) {
+                view.setPadding(style.padding[0], style.padding[1], style.padding[2], style.padding[3])
+            }
 
-                // Write body
-                connection.outputStream.use { os ->
-                    os.write(body.toByteArray())
-                    os.flush()
-                }
+            val background = style.background
+            if (card != null && style.has(StyleField.CORNER_RADIUS)) card.radius = style.cornerRadius
+            if (background != null && card == null) {
+                view.background = background.newDrawable()
+            } else if (style.has(StyleField.BACKGROUND_COLOR)) {
+                view.setBackgroundColor(style.backgroundColor)
+                viewMap[viewId + 1000000]?.setBackgroundColor(style.backgroundColor)
+                card?.setBackgroundColor(style.backgroundColor)
+            }
+            if (style.has(StyleField.ELEVATION)) view.elevation = style.elevation
 
-                val statusCode = connection.responseCode
-                val response = if (statusCode in 200..299) {
-                    connection.inputStream.bufferedReader().use { it.readText() }
-                } else {
-                    connection.errorStream?.bufferedReader()?.use { it.readText() } ?: ""
+            if (view is TextView) {
+                if (style.has(StyleField.TEXT_SIZE)) view.setTextSize(TypedValue.COMPLEX_UNIT_SP, style.textSize)
+                if (style.has(StyleField.TEXT_COLOR)) view.setTextColor(style.textColor)
+                if (style.has(StyleField.TEXT_STYLE)) view.setTypeface(null, style.typeface)
+            }
+            if (style.has(StyleField.GRAVITY)) {
+                when (view) {
+                    is TextView -> view.gravity = style.gravity
+                    is LinearLayout -> view.gravity = style.gravity
                 }
-
-                connection.disconnect()
-                onHttpResponse(callbackId, statusCode in 200..299, response, statusCode)
-
-            } catch (e: Exception) {
-                Log.e(TAG, "HTTP POST error: ${e.message}", e)
-                onHttpResponse(callbackId, false, "Error: ${e.message}", 0)
             }
-        }.start()
+        }
     }
 
-    fun httpPut(url: String, body: String, callbackId: Int, headersJson: String) {
-        Thread {
-            try {
-                val connection = URL(url).openConnection() as HttpURLConnection
-                connection.requestMethod = "PUT"
-                connection.connectTimeout = 15000
-                connection.readTimeout = 15000
-                connection.doOutput = true
+    // Transport for the native HTTP client (HttpClient.h). Runs on one of its worker
+    // threads: streams the body to native through onHttpChunk and returns the status
+    // code, or 0 after reporting the error through onHttpFailed. The connection is
+    // not disconnect()ed so HttpURLConnection can keep it alive for the next request,
+    // unless httpAbort cuts it short.
+    fun httpExecute(requestId: Int, method: String, url: String, body: String, headersJson: String): Int {
+        return try {
+            val connection = URL(url).openConnection() as HttpURLConnection
+            httpConnections[requestId] = connection
+            // An abort that came before the connection was registered
+            if (isHttpCancelled(requestId)) return 0
+            connection.requestMethod = method
+            connection.connectTimeout = 15000
+            connection.readTimeout = 15000
+
+            var hasContentType = false
+            if (headersJson.isNotEmpty()) {
+                hasContentType = parseAndAddHeaders(connection, headersJson)
+            }
+            // Asking explicitly turns off HttpURLConnection's own gunzip: the body reaches
+            // onHttpChunk compressed and native decodes it (HttpDecoder.h)
+            if (connection.getRequestProperty("Accept-Encoding") == null) {
+                connection.setRequestProperty("Accept-Encoding", "gzip, deflate")
+            }
 
-                var hasContentType = false
-                if (headersJson.isNotEmpty()) {
-                    hasContentType = parseAndAddHeaders(connection, headersJson)
-                }
+            if (method == "POST" || method == "PUT") {
+                connection.doOutput = true
+                // Set default content type if not provided
                 if (!hasContentType) {
                     connection.setRequestProperty("Content-Type", "application/json")
                 }
-
                 connection.outputStream.use { os ->
                     os.write(body.toByteArray())
                     os.flush()
                 }
+            }
 
-                val statusCode = connection.responseCode
-                val response = if (statusCode in 200..299) {
-                    connection.inputStream.bufferedReader().use { it.readText() }
-                } else {
-                    connection.errorStream?.bufferedReader()?.use { it.readText() } ?: ""
+            val statusCode = connection.responseCode
+            // "Name: value" lines; the null key is the status line
+            val responseHeaders = connection.headerFields.entries
+                .filter { it.key != null }
+                .joinToString("") { (name, values) -> values.joinToString("") { "$name: $it\n" } }
+            onHttpHeaders(requestId, statusCode, responseHeaders)
+
+            val stream = if (statusCode in 200..299) connection.inputStream else connection.errorStream
+            stream?.let { Channels.newChannel(it) }?.use { channel ->
+                val chunk = httpChunk.get()!!
+                while (true) {
+                    chunk.clear()
+                    val n = channel.read(chunk)
+                    if (n < 0) break
+                    if (n > 0 && !onHttpChunk(requestId, chunk, n)) break
                 }
-
-                connection.disconnect()
-                onHttpResponse(callbackId, statusCode in 200..299, response, statusCode)
-
-            } catch (e: Exception) {
-                Log.e(TAG, "HTTP PUT error: ${e.message}", e)
-                onHttpResponse(callbackId, false, "Error: ${e.message}", 0)
             }
-        }.start()
+            statusCode
+        } catch (e: Exception) {
+            Log.e(TAG, "HTTP $method error: ${e.message}", e)
+            onHttpFailed(requestId, "Error: ${e.message}")
+            0
+        } finally {
+            httpConnections.remove(requestId)
+        }
     }
 
-    fun httpDelete(url: String, callbackId: Int, headersJson: String) {
-        Thread {
-            try {
-                val connection = URL(url).openConnection() as HttpURLConnection
-                connection.requestMethod = "DELETE"
-                connection.connectTimeout = 15000
-                connection.readTimeout = 15000
-
-                if (headersJson.isNotEmpty()) {
-                    parseAndAddHeaders(connection, headersJson)
-                }
-
-                val statusCode = connection.responseCode
-                val response = if (statusCode in 200..299) {
-                    connection.inputStream.bufferedReader().use { it.readText() }
-                } else {
-                    connection.errorStream?.bufferedReader()?.use { it.readText() } ?: ""
-                }
-
-                connection.disconnect()
-                onHttpResponse(callbackId, statusCode in 200..299, response, statusCode)
-
-            } catch (e: Exception) {
-                Log.e(TAG, "HTTP DELETE error: ${e.message}", e)
-                onHttpResponse(callbackId, false, "Error: ${e.message}", 0)
-            }
-        }.start()
+    // Called by native on cancel and on VM shutdown, from any thread (the UI thread
+    // during onDestroy): closing the socket makes the worker blocked in httpExecute
+    // throw instead of waiting out the connect and read timeouts. The close itself
+    // is network I/O, so it runs on httpAborts.
+    fun httpAbort(requestId: Int) {
+        val connection = httpConnections[requestId] ?: return
+        httpAborts.execute { connection.disconnect() }
     }
 
+    // Request headers from Droplet code, a JSON object of strings. Returns whether
+    // it set Content-Type.
     private fun parseAndAddHeaders(connection: HttpURLConnection, headersJson: String): Boolean {
         var hasContentType = false
         try {
-            // Simple JSON parsing for headers (format: {"key":"value","key2":"value2"})
-            val cleanJson = headersJson.trim().removeSurrounding("{", "}")
-            if (cleanJson.isEmpty()) return false
-
-            cleanJson.split(",").forEach { pair ->
-                val parts = pair.split(":")
-                if (parts.size == 2) {
-                    val key = parts[0].trim().removeSurrounding("\"")
-                    val value = parts[1].trim().removeSurrounding("\"")
-                    connection.setRequestProperty(key, value)
-                    if (key.equals("Content-Type", ignoreCase = true)) {
-                        hasContentType = true
-                    }
+            val headers = JSONObject(headersJson)
+            for (key in headers.keys()) {
+                connection.setRequestProperty(key, headers.getString(key))
+                if (key.equals("Content-Type", ignoreCase = true)) {
+                    hasContentType = true
                 }
             }
-        } catch (e: Exception) {
+        } catch (e: JSONException) {
             Log.e(TAG, "Error parsing headers: ${e.message}")
         }
         return hasContentType
@@ -859,18 +942,162 @@ class MainActivity : AppCompatActivity() {
     }
 
 
+    // Called from native once per VM turn with every view op recorded during that turn
+    // (encoding documented in UiCommandBuffer.h). The native buffer is only valid for
+    // the duration of this call, so it is copied before posting to the UI thread.
+    fun applyUiCommands(buffer: ByteBuffer) {
+        val batch = ByteBuffer.allocate(buffer.remaining()).order(ByteOrder.LITTLE_ENDIAN)
+        batch.put(buffer)
+        batch.flip()
+        runOnUiThread { decodeUiCommands(batch) }
+    }
+
+    // Runs on the UI thread, where each runOnUiThread below executes inline
+    private fun decodeUiCommands(buf: ByteBuffer) {
+        val strings = ArrayList<String>()
+        fun int() = buf.int
+        fun str() = strings[buf.int]
+
+        while (buf.hasRemaining()) {
+            when (val op = buf.get().toInt()) {
+                UiOp.DEFINE_STRING -> {
+                    val len = buf.int
+                    strings.add(String(buf.array(), buf.arrayOffset() + buf.position(), len, Charsets.UTF_8))
+                    buf.position(buf.position() + len)
+                }
+                UiOp.SHOW_TOAST -> showToast(str())
+                UiOp.CREATE_BUTTON -> createButton(str(), int(), int(), int())
+                UiOp.CREATE_TEXT_VIEW -> createTextView(str(), int(), int())
+                UiOp.CREATE_IMAGE_VIEW -> createImageView(str(), int(), int(), int(), int())
+                UiOp.CREATE_LINEAR_LAYOUT -> createLinearLayout(int(), int(), int())
+                UiOp.CREATE_SCROLL_VIEW -> createScrollView(int(), int())
+                UiOp.CREATE_CARD_VIEW -> createCardView(int(), int(), int(), int())
+                UiOp.CREATE_RECYCLER_VIEW -> createRecyclerView(int(), int(), int())
+                UiOp.CREATE_EDIT_TEXT -> createEditText(str(), int(), int())
+                UiOp.CREATE_SCREEN -> createScreen(int(), str())
+                UiOp.ADD_VIEW_TO_PARENT -> addViewToParent(int(), int())
+                UiOp.SET_VIEW_TEXT -> setViewText(int(), str())
+                UiOp.SET_VIEW_IMAGE -> setViewImage(int(), str())
+                UiOp.SET_VIEW_VISIBILITY -> setViewVisibility(int(), int())
+                UiOp.SET_VIEW_BACKGROUND_COLOR -> setViewBackgroundColor(int(), int())
+                UiOp.SET_VIEW_PADDING -> setViewPadding(int(), int(), int(), int(), int())
+                UiOp.SET_VIEW_SIZE -> setViewSize(int(), int(), int())
+                UiOp.SET_VIEW_MARGIN -> setViewMargin(int(), int(), int(), int(), int())
+                UiOp.SET_VIEW_GRAVITY -> setViewGravity(int(), int())
+                UiOp.SET_VIEW_ELEVATION -> setViewElevation(int(), int())
+                UiOp.SET_VIEW_CORNER_RADIUS -> setViewCornerRadius(int(), int())
+                UiOp.SET_VIEW_BORDER -> setViewBorder(int(), int(), int())
+                UiOp.SET_TEXT_SIZE -> setTextSize(int(), int())
+                UiOp.SET_TEXT_COLOR -> setTextColor(int(), int())
+                UiOp.SET_TEXT_STYLE -> setTextStyle(int(), int())
+                UiOp.SET_EDIT_TEXT_HINT -> setEditTextHint(int(), str())
+                UiOp.SET_EDIT_TEXT_INPUT_TYPE -> setEditTextInputType(int(), int())
+                UiOp.RECYCLER_VIEW_INSERT,
+                UiOp.RECYCLER_VIEW_REMOVE,
+                UiOp.RECYCLER_VIEW_CHANGE -> recyclerViewNotify(op, int(), int(), int())
+                UiOp.SET_TOOLBAR_TITLE -> setToolbarTitle(str())
+                UiOp.NAVIGATE_TO_SCREEN -> navigateToScreen(int())
+                UiOp.NAVIGATE_BACK -> navigateBack()
+                UiOp.SET_BACK_BUTTON_VISIBLE -> setBackButtonVisible(int() != 0)
+                UiOp.CLEAR_SCREEN -> clearScreen(int())
+                UiOp.REMOVE_VIEW -> removeView(int())
+                UiOp.SET_BUTTON_CALLBACK -> setButtonCallback(int(), int())
+                UiOp.DEFINE_STYLE -> defineStyle(int(), int(), IntArray(StyleField.COUNT) { int() })
+                UiOp.APPLY_STYLE -> applyStyle(int(), int())
+                UiOp.RECYCLER_VIEW_COMMIT -> recyclerViewCommit(int(), int())
+                else -> {
+                    Log.e(TAG, "Unknown UI op $op, dropping rest of batch")
+                    return
+                }
+            }
+        }
+    }
+
     override fun onDestroy() {
         super.onDestroy()
         DropletVM().cleanup()
+        images.shutdown()
     }
 
     private external fun registerVM()
     private external fun onButtonClick(callbackId: Int)
-    private external fun onHttpResponse(callbackId: Int, success: Boolean, response: String, statusCode: Int)
+    private external fun onHttpChunk(requestId: Int, buffer: ByteBuffer, length: Int): Boolean
+    private external fun onHttpFailed(requestId: Int, message: String)
+    private external fun onHttpHeaders(requestId: Int, statusCode: Int, headers: String)
+    private external fun isHttpCancelled(requestId: Int): Boolean
+    private external fun recyclerRow(viewId: Int, position: Int): String
+    private external fun adoptRecyclerRows(viewId: Int, version: Int)
+}
+
+// Opcodes of the native UI command stream, mirrors UiOp in UiCommandBuffer.h
+private object UiOp {
+    const val DEFINE_STRING = 0
+    const val SHOW_TOAST = 1
+    const val CREATE_BUTTON = 2
+    const val CREATE_TEXT_VIEW = 3
+    const val CREATE_IMAGE_VIEW = 4
+    const val CREATE_LINEAR_LAYOUT = 5
+    const val CREATE_SCROLL_VIEW = 6
+    const val CREATE_CARD_VIEW = 7
+    const val CREATE_RECYCLER_VIEW = 8
+    const val CREATE_EDIT_TEXT = 9
+    const val CREATE_SCREEN = 10
+    const val ADD_VIEW_TO_PARENT = 11
+    const val SET_VIEW_TEXT = 12
+    const val SET_VIEW_IMAGE = 13
+    const val SET_VIEW_VISIBILITY = 14
+    const val SET_VIEW_BACKGROUND_COLOR = 15
+    const val SET_VIEW_PADDING = 16
+    const val SET_VIEW_SIZE = 17
+    const val SET_VIEW_MARGIN = 18
+    const val SET_VIEW_GRAVITY = 19
+    const val SET_VIEW_ELEVATION = 20
+    const val SET_VIEW_CORNER_RADIUS = 21
+    const val SET_VIEW_BORDER = 22
+    const val SET_TEXT_SIZE = 23
+    const val SET_TEXT_COLOR = 24
+    const val SET_TEXT_STYLE = 25
+    const val SET_EDIT_TEXT_HINT = 26
+    const val SET_EDIT_TEXT_INPUT_TYPE = 27
+    const val RECYCLER_VIEW_INSERT = 28
+    const val RECYCLER_VIEW_REMOVE = 29
+    const val RECYCLER_VIEW_CHANGE = 30
+    const val SET_TOOLBAR_TITLE = 31
+    const val NAVIGATE_TO_SCREEN = 32
+    const val NAVIGATE_BACK = 33
+    const val SET_BACK_BUTTON_VISIBLE = 34
+    const val CLEAR_SCREEN = 35
+    const val REMOVE_VIEW = 36
+    const val SET_BUTTON_CALLBACK = 37
+    const val DEFINE_STYLE = 38
+    const val APPLY_STYLE = 39
+    const val RECYCLER_VIEW_COMMIT = 40
+}
+
+// Mirrors StyleField in StyleSheet.h: index into DefineStyle's values and bit in its mask
+private object StyleField {
+    const val PADDING_LEFT = 0
+    const val MARGIN_LEFT = 4
+    const val WIDTH = 8
+    const val HEIGHT = 9
+    const val BACKGROUND_COLOR = 10
+    const val CORNER_RADIUS = 11
+    const val ELEVATION = 12
+    const val BORDER_WIDTH = 13
+    const val BORDER_COLOR = 14
+    const val GRAVITY = 15
+    const val TEXT_SIZE = 16
+    const val TEXT_COLOR = 17
+    const val TEXT_STYLE = 18
+    const val COUNT = 19
 }
 
-class SimpleRecyclerAdapter : RecyclerView.Adapter<SimpleRecyclerAdapter.ViewHolder>() {
-    private val items = mutableListOf<String>()
+// Rows are owned by the native RecyclerStore; the adapter only tracks the count it
+// has been told about and fetches a row when it is bound.
+class NativeRecyclerAdapter(
+    private val row: (Int) -> String
+) : RecyclerView.Adapter<NativeRecyclerAdapter.ViewHolder>() {
+    private var count = 0
 
     class ViewHolder(val textView: TextView) : RecyclerView.ViewHolder(textView)
 
@@ -887,19 +1114,18 @@ class SimpleRecyclerAdapter : RecyclerView.Adapter<SimpleRecyclerAdapter.ViewHol
     }
 
     override fun onBindViewHolder(holder: ViewHolder, position: Int) {
-        holder.textView.text = items[position]
+        holder.textView.text = row(position)
     }
 
-    override fun getItemCount() = items.size
+    override fun getItemCount() = count
 
-    fun addItem(text: String) {
-        items.add(text)
-        notifyItemInserted(items.size - 1)
+    fun rowsInserted(start: Int, rows: Int) {
+        count += rows
+        notifyItemRangeInserted(start, rows)
     }
 
-    fun clear() {
-        val size = items.size
-        items.clear()
-        notifyItemRangeRemoved(0, size)
+    fun rowsRemoved(start: Int, rows: Int) {
+        count -= rows
+        notifyItemRangeRemoved(start, rows)
     }
 }
\ No newline at end of file